@@ -8,6 +8,12 @@ TFT_eSPI tft = TFT_eSPI();       // single definition
 // Your other modules
 #include "rotary_input.h"
 #include "menu.h"
+#include "settle.h"
+#include "serial_link.h"
+#include "flight_log.h"
+#include "boot.h"
+#include "web_server.h"
+#include "manual_drive.h"
 // If you use these, keep them included as before:
 // #include "wizard_single_slide.h"
 // #include "wizard_bounce_slide.h"
@@ -16,13 +22,32 @@ TFT_eSPI tft = TFT_eSPI();       // single definition
 // #include "settings_menu.h"
 // #include "status_screen.h"
 // #include "previous_slide.h"
-// #include "manual_mode.h"
+#include "manual_mode.h"
+#include "take_screen.h"
+#include "resume_screen.h"
+
+// Boot finished: offer to carry on a job cut off by power loss, then the menu
+static void onBootReady() {
+  if (resumePending()) openResumeScreen();
+  drawMainMenu();
+}
 
 void setup() {
   // Keep GPIO15 safely low at boot (still keep the physical 10kΩ to GND)
   pinMode(15, INPUT_PULLDOWN);
   delay(5);
 
+  // Flight recorder early, so a reset during init is still logged
+  flightRecorderBegin();
+  bootMark("setup");
+
+  // Step/dir pins to a known state before anything else runs
+  initMotor();
+  stepGenInit();
+
+  // Job scratch taken while the heap is still unfragmented
+  jobArena();
+
   // Backlight first
   backlightInit();
   backlightSet(BRIGHT_LEVEL);
@@ -30,24 +55,47 @@ void setup() {
   // TFT init
   tft.begin();
   tft.setRotation(1);
+  bootMark("tft");
 
-  // UI base
-  uiBegin();
+  // Settings + encoder probe on the other core; splash meanwhile
+  bootStart();
+
+  // Host control over USB
+  serialLinkBegin();
 
   // Inputs
   inputInit();   // from rotary_input.h (sets up CLK/DT/OK/BACK)
-
-  // Draw main menu on boot
-  drawMainMenu();
 }
 
 void loop() {
+  // Splash until boot init is done, then the main menu
+  if (!bootLoop(onBootReady)) return;
+
+  // Wi-Fi needs the stored credentials, so it starts once settings are in
+  static bool webStarted = false;
+  if (!webStarted) { startWebServer(); bootMark("wifi"); webStarted = true; }
+
   // Read encoder/buttons
   handleRotary();   // or updateRotary()/pollInput() if that’s what your project uses
 
   // Menu state machine
   handleMainMenu();
 
+  // Host commands over USB, web page and control API
+  serialLinkLoop();
+  webServerLoop();
+
+  // Release velocity mode once a manual drive has ramped down
+  driveLoop();
+  takeLoop();
+  crawlLoop();
+
+  // Encoder samples for the flight recorder while moving
+  flightRecorderTick();
+
+  // End settle dwells early once the rig is still
+  settleTick();
+
   // Optional UI idle/dimmer (currently no-op)
   idleDimmerTick();
 }
\ No newline at end of file
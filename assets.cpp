@@ -0,0 +1,24 @@
+// Generated by tools/pack_assets.py from assets/*.png; do not edit.
+#include "assets.h"
+
+static const uint8_t ASSET_SPLASH_LOGO_DATA[] = {
+  0x59, 0xFD, 0xFD, 0xFD, 0xD3, 0x66, 0xC6, 0x36, 0xE5, 0x31, 0xC8, 0x36, 0xE4, 0x31, 0xC8, 0x36,
+  0xE4, 0x31, 0xC8, 0x36, 0xDF, 0x31, 0xDC, 0x36, 0xCF, 0x31, 0xDE, 0x36, 0xCE, 0x31, 0xCB, 0xAD,
+  0x99, 0xC4, 0x31, 0xC4, 0xFE, 0xDF, 0x05, 0xC2, 0x31, 0xC1, 0x36, 0xCE, 0x31, 0xCA, 0x38, 0xC6,
+  0x31, 0xC3, 0x3F, 0xC2, 0x31, 0xC1, 0x36, 0xCE, 0x31, 0xC9, 0x38, 0xC0, 0x3F, 0xC4, 0x38, 0xC0,
+  0x31, 0xC9, 0x36, 0xCE, 0x31, 0xC8, 0x38, 0xC0, 0x3F, 0xC6, 0x38, 0xC0, 0x31, 0xC8, 0x36, 0xCE,
+  0x31, 0xC8, 0x38, 0x3F, 0xC1, 0xFE, 0x7F, 0xC7, 0x00, 0xC0, 0x3F, 0xC2, 0x38, 0x31, 0xC8, 0x36,
+  0xCE, 0x31, 0xC8, 0x38, 0x3F, 0xC1, 0x08, 0x00, 0xC1, 0x3F, 0xC1, 0x38, 0x31, 0xC8, 0x36, 0xCE,
+  0x31, 0xC7, 0x38, 0xC0, 0x3F, 0xC1, 0x00, 0xC2, 0x3F, 0xC1, 0x38, 0xC0, 0x31, 0xC7, 0x36, 0xCE,
+  0x31, 0xC8, 0x38, 0x3F, 0xC1, 0x00, 0xC2, 0x3F, 0xC1, 0x38, 0x31, 0xC8, 0x36, 0xCE, 0x31, 0xC8,
+  0x38, 0x3F, 0xC2, 0x00, 0xC0, 0x3F, 0xC2, 0x38, 0x31, 0xC8, 0x36, 0xCE, 0x31, 0xC8, 0x38, 0xC0,
+  0x3F, 0xC6, 0x38, 0xC0, 0x31, 0xC8, 0x36, 0xCE, 0x31, 0xC9, 0x38, 0xC0, 0x3F, 0xC4, 0x38, 0xC0,
+  0x31, 0xC9, 0x36, 0xCE, 0x31, 0xCA, 0x38, 0xC6, 0x31, 0xCA, 0x36, 0xCE, 0x31, 0xCB, 0x38, 0xC4,
+  0x31, 0xCB, 0x36, 0xCE, 0x31, 0xDE, 0x36, 0xCF, 0x31, 0xDC, 0x36, 0xDC, 0xFE, 0xEF, 0x7B, 0xC4,
+  0x36, 0xE8, 0x31, 0xC4, 0x36, 0xE8, 0x31, 0xC4, 0x36, 0xE0, 0x31, 0xD4, 0x36, 0xD7, 0x31, 0xD6,
+  0x36, 0xD6, 0x31, 0xD6, 0x36, 0xD6, 0x31, 0xD6, 0x36, 0xD6, 0x31, 0xD6, 0x36, 0xCB, 0x38, 0xCA,
+  0x31, 0xD4, 0x38, 0xCA, 0x36, 0x38, 0xFD, 0xE0, 0x36, 0x38, 0xEC, 0x36, 0xC1, 0x31, 0xC2, 0x36,
+  0xE2, 0x31, 0xC2, 0x36, 0xC2, 0x31, 0xC2, 0x36, 0xE2, 0x31, 0xC2, 0x36, 0xC2, 0x31, 0xC2, 0x36,
+  0xE2, 0x31, 0xC2, 0x36, 0xC0
+};
+const ImageAsset ASSET_SPLASH_LOGO = { ASSET_SPLASH_LOGO_DATA, sizeof(ASSET_SPLASH_LOGO_DATA), 48, 40, 0xF81F, true };
@@ -0,0 +1,10 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+// Generated by tools/pack_assets.py from assets/*.png; do not edit.
+
+#include "image_asset.h"
+
+extern const ImageAsset ASSET_SPLASH_LOGO;   // 48x40, 277 bytes (raw 3840)
+
+#endif
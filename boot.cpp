@@ -0,0 +1,9 @@
+// Boot timeline and phase.
+#include "boot.h"
+
+BootMark  g_bootMarks[BOOT_MARKS_MAX];
+uint8_t   g_bootMarkCount  = 0;
+bool      g_bootWorkerDone = false;
+BootPhase g_bootPhase      = BOOT_INIT;
+uint32_t  g_bootMenuUs     = 0;
+uint32_t  g_bootMotionUs   = 0;
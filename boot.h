@@ -0,0 +1,117 @@
+#ifndef BOOT_H
+#define BOOT_H
+
+// Boot sequencing and timeline.
+// setup() does only what the first frame and safe outputs need (backlight,
+// TFT, splash, step/dir pins), then hands settings load, scale maths and
+// the encoder probe to a worker task on the other core. The I2C probe and
+// the EEPROM read overlap with the display bring-up instead of queueing
+// behind it. loop() animates the splash until the worker is done, then
+// draws the menu.
+//
+// Each stage stamps the timeline (esp_timer us since app start), readable
+// at GET /api/boot and with `slidectl.py boot`.
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "eeprom_utils.h"
+#include "encoder_utils.h"
+#include "rig_scale.h"
+#include "logo.h"
+#include "http_router.h"
+
+#ifndef BOOT_MARKS_MAX
+  #define BOOT_MARKS_MAX 16
+#endif
+#ifndef SPLASH_MIN_MS
+  #define SPLASH_MIN_MS 0        // keep the splash up at least this long
+#endif
+#ifndef BOOT_WORKER_CORE
+  #define BOOT_WORKER_CORE 0     // loop() runs on core 1
+#endif
+
+struct BootMark {
+  const char* name;
+  uint32_t    us;
+};
+
+enum BootPhase : uint8_t { BOOT_INIT = 0, BOOT_SPLASH, BOOT_RUN };
+
+extern BootMark  g_bootMarks[BOOT_MARKS_MAX];
+extern uint8_t   g_bootMarkCount;
+extern bool      g_bootWorkerDone;   // set by the worker, release/acquire
+extern BootPhase g_bootPhase;
+extern uint32_t  g_bootMenuUs;       // time to menu
+extern uint32_t  g_bootMotionUs;     // time until a move can be planned
+
+// Both cores stamp; names must be string literals.
+inline void bootMark(const char* name) {
+  const uint8_t i = __atomic_fetch_add(&g_bootMarkCount, 1, __ATOMIC_RELAXED);
+  if (i >= BOOT_MARKS_MAX) return;
+  g_bootMarks[i].us   = (uint32_t)esp_timer_get_time();
+  g_bootMarks[i].name = name;
+}
+inline uint8_t bootMarkCount() { return (uint8_t)min<uint32_t>(g_bootMarkCount, BOOT_MARKS_MAX); }
+
+inline bool bootWorkerDone() { return __atomic_load_n(&g_bootWorkerDone, __ATOMIC_ACQUIRE); }
+
+// ---------- worker ----------
+inline void bootWorkerRun() {
+  eepromInit();
+  eepromLoadAllIntoRuntime();
+  bootMark("settings");
+  scaleRefresh();
+  bootMark("scale");
+  encoderInit();                  // I2C probe; slow when the sensor is absent
+  bootMark(encoderIsPresent() ? "encoder" : "no-encoder");
+  g_bootMotionUs = (uint32_t)esp_timer_get_time();
+  __atomic_store_n(&g_bootWorkerDone, true, __ATOMIC_RELEASE);
+}
+
+inline void bootWorkerTask(void*) {
+  bootWorkerRun();
+  vTaskDelete(nullptr);
+}
+
+// Call from setup() once the display is up.
+inline void bootStart() {
+  bootMark("worker");
+  if (xTaskCreatePinnedToCore(bootWorkerTask, "boot", 4096, nullptr, 1, nullptr, BOOT_WORKER_CORE) != pdPASS)
+    bootWorkerRun();              // no task: do it inline
+  splashBegin();
+  g_bootPhase = BOOT_SPLASH;
+  bootMark("splash");
+}
+
+// Call first in loop(). Animates the splash and returns false until the
+// worker has finished; then runs onReady (draw the menu) once.
+inline bool bootLoop(void (*onReady)()) {
+  if (g_bootPhase == BOOT_RUN) return true;
+  splashTick();
+  if (!bootWorkerDone()) return false;
+#if SPLASH_MIN_MS > 0
+  if (splashElapsed() < SPLASH_MIN_MS) return false;
+#endif
+  if (onReady) onReady();
+  g_bootMenuUs = (uint32_t)esp_timer_get_time();
+  bootMark("menu");
+  g_bootPhase = BOOT_RUN;
+  return true;
+}
+
+inline bool bootDone() { return g_bootPhase == BOOT_RUN; }
+
+// GET /api/boot → {"menuMs":..,"motionMs":..,"marks":[["settings",us],..]}
+inline void bootTimelineJson(HttpResponse& r) {
+  r.type = "application/json";
+  r.add("{\"menuMs\":").add(g_bootMenuUs / 1000.0f, 1)
+   .add(",\"motionMs\":").add(g_bootMotionUs / 1000.0f, 1)
+   .add(",\"marks\":[");
+  for (uint8_t i = 0; i < bootMarkCount(); ++i) {
+    if (i) r.add(",");
+    r.add("[\"").add(g_bootMarks[i].name).add("\",").add((long)g_bootMarks[i].us).add("]");
+  }
+  r.add("]}");
+}
+
+#endif
@@ -2,7 +2,7 @@
 #include <Arduino.h>
 #include <TFT_eSPI.h>
 
-// The global display object is defined in SlidePilot.ino
+// The global display object is defined in SliderPilot.ino
 extern TFT_eSPI tft;
 
 // -------------------- Pins (final mapping you’re using) --------------------
@@ -11,6 +11,13 @@ extern TFT_eSPI tft;
 #define TMC_UART_RX     13   // TMC RX to ESP TX (GPIO13)
 #define TMC_UART_TX     17   // TMC TX to ESP RX (GPIO17)
 
+// Optional pan / tilt heads: define a pair to enable that axis
+// (tilt needs pan). Slide-only rigs leave these commented out.
+// #define PAN_STEP_PIN    32
+// #define PAN_DIR_PIN     33
+// #define TILT_STEP_PIN   27
+// #define TILT_DIR_PIN    15
+
 #define I2C_SDA_PIN     21   // AS5600
 #define I2C_SCL_PIN     22
 
@@ -56,6 +63,7 @@ namespace UI {
   static const int ITEM_H      = 34;     // keep consistent
   static const int GAP         = 10;
   static const int RIGHT_COL_W = 44;     // rail + tabs
+  static const int RADIUS      = ITEM_H/2; // pill ends
 }
 
 // -------------------- Small helpers available everywhere -----------------
@@ -0,0 +1,138 @@
+#ifndef CONTROL_H
+#define CONTROL_H
+
+// Transport-neutral remote commands. The web control API and the USB serial
+// link both call these, so a jog or a job upload behaves the same whichever
+// way it arrives.
+
+#include <Arduino.h>
+#include "config.h"
+#include "motor_control.h"
+#include "motion_plan.h"
+#include "step_generator.h"
+#include "job.h"
+#include "job_check.h"
+#include "plan_cache.h"
+#include "manual_drive.h"
+#include "take.h"
+#include "crawl.h"
+#include "resume.h"
+#include "ui_helpers.h"
+
+enum CtlStatus : uint8_t {
+  CTL_OK = 0,
+  CTL_BUSY,       // a plan is running
+  CTL_BAD,        // malformed or invalid request
+  CTL_RANGE,      // outside travel / too fast
+};
+
+inline const char* ctlStatusText(CtlStatus s) {
+  switch (s) {
+    case CTL_OK:    return "ok";
+    case CTL_BUSY:  return "busy";
+    case CTL_BAD:   return "bad request";
+    case CTL_RANGE: return "out of range";
+    default:        return "error";
+  }
+}
+
+inline CtlStatus ctlJog(float mm) {
+  noteUserActivity();
+  if (mm == 0.0f) return CTL_OK;
+  if (motionBusy()) return CTL_BUSY;
+  return moveDeltaMM(mm, getSpeedPercent()) ? CTL_OK : CTL_RANGE;
+}
+
+inline CtlStatus ctlMoveTo(float mm, int pct) {
+  noteUserActivity();
+  if (motionBusy()) return CTL_BUSY;
+  if (!jobPosOk(mm)) return CTL_RANGE;
+  frec(FR_MOVE, 0, 0, lroundf(mm * 1000.0f));
+  float d = mm - stepPositionMM();
+  if (fabsf(d) * stepsPerMM() < 1.0f) return CTL_OK;
+  return moveDeltaMM(d, pct > 0 ? pct : getSpeedPercent()) ? CTL_OK : CTL_RANGE;
+}
+
+// Plans and crawls halt at once; manual drive and take playback ramp down.
+inline void ctlStop() { noteUserActivity(); takeStop(); planStop(); crawlStop(); driveStop(); }
+
+// Velocity drive: dir ±1 at pct speed, dir 0 stops. Repeat within
+// DRIVE_TIMEOUT_MS to keep moving.
+inline CtlStatus ctlDrive(int dir, int pct) {
+  noteUserActivity();
+  if (dir != 0 && plan.active) return CTL_BUSY;
+  return manualDrive(dir, (uint8_t)clampT(pct, 5, 100)) ? CTL_OK : CTL_BUSY;
+}
+
+// Crawl at mm/hour (signed, 0 stops) for mm (0 = to the end of travel);
+// a running crawl only changes rate.
+inline CtlStatus ctlCrawl(float mmPerHour, float mm) {
+  noteUserActivity();
+  if (mmPerHour == 0.0f) { crawlStop(); return CTL_OK; }
+  if (!(fabsf(mmPerHour) <= CRAWL_MAX_MM_PER_HOUR)) return CTL_RANGE;
+  if (!crawlActive() && motionBusy()) return CTL_BUSY;
+  return crawlStart(mmPerHour, mm) ? CTL_OK : CTL_BUSY;
+}
+
+// Hand-guided take (take.h): record, play at scale, stop.
+enum CtlTakeCmd : uint8_t { CTL_TAKE_STOP = 0, CTL_TAKE_RECORD, CTL_TAKE_PLAY };
+
+inline CtlStatus ctlTake(uint8_t cmd, float scale) {
+  noteUserActivity();
+  switch (cmd) {
+    case CTL_TAKE_STOP:
+      takeStop();
+      return CTL_OK;
+    case CTL_TAKE_RECORD:
+      if (takeState() == TAKE_RECORDING) return CTL_OK;
+      if (motionBusy() || takeState() != TAKE_IDLE) return CTL_BUSY;
+      return takeRecordStart() ? CTL_OK : CTL_BAD;      // no encoder or no buffer
+    case CTL_TAKE_PLAY:
+      if (motionBusy() || takeState() != TAKE_IDLE) return CTL_BUSY;
+      if (!(scale >= 0.1f && scale <= 4.0f)) return CTL_RANGE;
+      return takePlay(scale, getSpeedPercent()) ? CTL_OK : CTL_BAD;   // no take
+    default:
+      return CTL_BAD;
+  }
+}
+
+// Interrupted job (resume.h): carry on from the last checkpoint, or forget it.
+inline CtlStatus ctlResume(bool resume) {
+  noteUserActivity();
+  if (!resumePending()) return CTL_BAD;
+  if (!resume) { resumeDiscard(); return CTL_OK; }
+  if (motionBusy() || takeState() != TAKE_IDLE) return CTL_BUSY;
+  return resumeStart() ? CTL_OK : CTL_RANGE;          // plan gone or rig rescaled
+}
+
+inline void ctlSetSpeed(int pct) { noteUserActivity(); setSpeedPercent(pct); }
+
+// Parse, validate and (unless dry) start a job; err is set on failure.
+inline CtlStatus ctlJobSubmit(StrView body, bool dry, const char*& err) {
+  noteUserActivity();
+  err = nullptr;
+  if (motionBusy()) { err = "busy"; return CTL_BUSY; }
+  jobArenaReset();
+  JobSpec* j = arenaNew<JobSpec>(jobArena());   // large; keep it off the stack
+  if (!j) { err = "out of memory"; return CTL_BAD; }
+  if (!jobParse(body, *j, err) || !jobValidate(*j, err)) return CTL_BAD;
+  if (!jobRun(*j, !dry)) { err = g_jobError; return CTL_RANGE; }
+  return CTL_OK;
+}
+
+// Parse and analyse a job without running it (job_check.h); c holds the
+// report whatever the status.
+inline CtlStatus ctlJobCheck(StrView body, JobCheck& c) {
+  noteUserActivity();
+  c = JobCheck();
+  if (motionBusy()) { c.fail(JC_BUSY, "busy"); return CTL_BUSY; }
+  jobArenaReset();
+  JobSpec* j = arenaNew<JobSpec>(jobArena());
+  if (!j) { c.fail(JC_INVALID, "out of memory"); return CTL_BAD; }
+  const char* err = nullptr;
+  if (!jobParse(body, *j, err)) { c.fail(JC_INVALID, err); return CTL_BAD; }
+  if (jobCheck(*j, c)) return CTL_OK;
+  return (c.flags & JC_INVALID) ? CTL_BAD : CTL_RANGE;
+}
+
+#endif
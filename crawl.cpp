@@ -0,0 +1,4 @@
+// Crawl move in progress.
+#include "crawl.h"
+
+CrawlState g_crawl;
@@ -0,0 +1,75 @@
+#ifndef CRAWL_H
+#define CRAWL_H
+
+// Crawl: continuous slide motion far below the slowest percentage speed
+// (one step per MOTOR_MAX_US_PER_STEP), for multi-hour timelapses and
+// astro tracking. Rates are millimetres per hour; the step generator's
+// crawl mode (step_generator.h) turns them into exactly timed steps with a
+// 64-bit phase accumulator, so an 8 h move ends where it should to the
+// step, and the CPU only wakes for each step.
+
+#include <Arduino.h>
+#include "config.h"
+#include "motor_control.h"
+#include "step_generator.h"
+#include "flight_recorder.h"
+#include "http_router.h"
+
+#ifndef CRAWL_MAX_MM_PER_HOUR
+  #define CRAWL_MAX_MM_PER_HOUR 36000.0f   // 10 mm/s; faster moves belong to plans
+#endif
+
+struct CrawlState {
+  float    mmPerHour = 0.0f;   // signed
+  uint32_t startMs   = 0;
+  int32_t  startPos  = 0;
+};
+extern CrawlState g_crawl;
+
+inline bool  crawlActive()    { return g_crawlMode; }
+inline float crawlMmPerHour() { return g_crawlMode ? g_crawl.mmPerHour : 0.0f; }
+inline float crawlStepRate(float mmPerHour) { return mmPerHour * stepsPerMM() / 3600.0f; }
+
+// Crawl at mmPerHour (sign = direction) for mm millimetres, 0 = to the end
+// of travel. An active crawl just changes rate (mm is ignored).
+inline bool crawlStart(float mmPerHour, float mm) {
+  mmPerHour = clampT(mmPerHour, -CRAWL_MAX_MM_PER_HOUR, CRAWL_MAX_MM_PER_HOUR);
+  if (g_crawlMode) {
+    stepGenCrawlSet(crawlStepRate(mmPerHour));
+    g_crawl.mmPerHour = mmPerHour;
+    return true;
+  }
+  if (mmPerHour == 0.0f) return true;
+  const uint32_t steps = (uint32_t)lroundf(fabsf(mm) * stepsPerMM());
+  if (mm != 0.0f && steps == 0) return true;
+  if (!stepGenCrawlBegin(crawlStepRate(mmPerHour), steps)) return false;
+  g_crawl.mmPerHour = mmPerHour;
+  g_crawl.startMs   = millis();
+  g_crawl.startPos  = g_axisPos[AXIS_SLIDE];
+  frec(FR_CRAWL, 1, g_crawlBoost, lroundf(mmPerHour * 1000.0f));
+  return true;
+}
+
+inline void crawlStop() {
+  if (!g_crawlMode) return;
+  stepGenCrawlEnd();
+  frec(FR_CRAWL, 0, 0, g_axisPos[AXIS_SLIDE] - g_crawl.startPos);
+}
+
+// Call from loop(): ends a crawl that reached its distance or a limit.
+inline void crawlLoop() {
+  if (g_crawlMode && g_crawlDone) crawlStop();
+}
+
+// GET /api/crawl → {"active":true,"mmPerHour":..,"boost":4,"movedMm":..,"elapsedS":..}
+inline void crawlStatusJson(HttpResponse& r) {
+  const bool on = g_crawlMode;
+  r.type = "application/json";
+  r.add("{\"active\":").add(on ? "true" : "false")
+   .add(",\"mmPerHour\":").add(crawlMmPerHour(), 3)
+   .add(",\"boost\":").add((long)(on ? g_crawlBoost : stepGenCrawlBoostFor(g_axes[AXIS_SLIDE].microstep)))
+   .add(",\"movedMm\":").add(on ? (g_axisPos[AXIS_SLIDE] - g_crawl.startPos) / stepsPerMM() : 0.0f, 3)
+   .add(",\"elapsedS\":").add((long)(on ? (millis() - g_crawl.startMs) / 1000 : 0)).add("}");
+}
+
+#endif
@@ -0,0 +1,5 @@
+// Settings and last job, loaded from EEPROM at boot.
+#include "eeprom_utils.h"
+
+RuntimeState runtimeState;
+LastJob      lastJob;
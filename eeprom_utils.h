@@ -39,8 +39,40 @@
 #ifndef DEFAULT_PAUSE_MS
   #define DEFAULT_PAUSE_MS 500
 #endif
+#ifndef DEFAULT_SETTLE_WINDOW_MS
+  #define DEFAULT_SETTLE_WINDOW_MS 150  // quiet time that counts as settled (0 = fixed pause)
+#endif
+#ifndef DEFAULT_SETTLE_COUNTS
+  #define DEFAULT_SETTLE_COUNTS 2       // max encoder counts per sample while "quiet"
+#endif
+#ifndef DEFAULT_WIFI_MODE
+  #define DEFAULT_WIFI_MODE 0           // 0 = AP only, 1 = station, 2 = station, AP if it fails
+#endif
+#ifndef RESONANCE_BINS
+  #define RESONANCE_BINS 32     // step-rate bins in the resonance map (max 32)
+#endif
+#ifndef TUNE_PROFILES
+  #define TUNE_PROFILES 3       // payload profiles, each with its own tuned limits
+#endif
 
 // ---------- Persistent types ----------
+// Last good station link (wifi_link.h), so a reconnect can skip the scan
+// and DHCP. Only used while credHash matches the stored credentials.
+struct WifiCache {
+  uint32_t credHash = 0;
+  uint8_t  bssid[6] = {0};
+  uint8_t  channel  = 0;
+  uint8_t  reserved = 0;
+  uint32_t ip = 0, gateway = 0, netmask = 0, dns = 0;
+};
+
+// Slide limits found by the auto-tune (speed_tune.h) for one payload. Kept
+// in mm so they still hold after a microstep change; 0 = not tuned.
+struct SlideLimits {
+  float maxMmS    = 0.0f;     // fastest cruise
+  float accelMmS2 = 0.0f;
+};
+
 struct RuntimeState {
   uint16_t microstep       = DEFAULT_MICROSTEPPING;
   uint16_t current_mA      = DEFAULT_CURRENT_MA;
@@ -50,11 +82,36 @@ struct RuntimeState {
 
   uint8_t  motion_profile  = DEFAULT_MOTION_PROFILE; // 0=trap,1=smooth…
   uint8_t  defaultStops    = DEFAULT_STOPS;
-  uint32_t defaultPauseMs  = DEFAULT_PAUSE_MS;
+  uint32_t defaultPauseMs  = DEFAULT_PAUSE_MS;   // also the settle upper bound
+  uint16_t settleWindowMs  = DEFAULT_SETTLE_WINDOW_MS;
+  uint8_t  settleCounts    = DEFAULT_SETTLE_COUNTS;
 
   bool     endpointsSaved  = false;
   float    endpointA_mm    = 0.0f;
   float    endpointB_mm    = 100.0f;
+
+  // Encoder scale calibration (scale_calib.h); 0 = use the nominal scale
+  uint32_t calStepsPerCountQ16 = 0;   // microsteps per AS5600 count, Q16.16
+  uint16_t calBacklashSteps    = 0;
+
+  // Resonance map (resonance_map.h): slide step-rate range it was measured
+  // over, velocity ripple per bin (0.5 % units) and the bins to avoid.
+  float    resRateLo       = 0.0f;
+  float    resRateHi       = 0.0f;
+  uint32_t resBandMask     = 0;
+  uint8_t  resRipple[RESONANCE_BINS] = {0};
+
+  // Payload profiles (speed_tune.h); rig_scale.h applies the active one
+  uint8_t     payload = 0;
+  SlideLimits limits[TUNE_PROFILES];
+
+  // Wi-Fi (wifi_link.h)
+  uint8_t  wifiMode        = DEFAULT_WIFI_MODE;
+  char     ap_ssid[33]     = "";
+  char     ap_pass[65]     = "";
+  char     sta_ssid[33]    = "";
+  char     sta_pass[65]    = "";
+  WifiCache staCache;
 };
 
 enum JobType : uint8_t { JOB_NONE=0, JOB_SINGLE=1, JOB_BOUNCE=2, JOB_MULTI=3, JOB_TIMELAPSE=4 };
@@ -68,12 +125,17 @@ struct LastJob {
   int      speedPct       = 50;
 };
 
-// ---------- Single-definition globals ----------
-RuntimeState runtimeState;
-LastJob      lastJob;
+// ---------- Single-definition globals (eeprom_utils.cpp) ----------
+extern RuntimeState runtimeState;
+extern LastJob      lastJob;
 
 // ---------- EEPROM I/O ----------
 static const uint32_t EEPROM_MAGIC = 0x534C4950; // 'SLIP'
+// Bump when RuntimeState/LastJob change shape; old images then load defaults.
+static const uint32_t EEPROM_LAYOUT = 6;
+
+static_assert(EEPROM_SIZE >= EEPROM_ADDR_BASE + 8 + sizeof(RuntimeState) + sizeof(LastJob),
+              "EEPROM_SIZE too small for RuntimeState + LastJob");
 
 // Call once in setup()
 inline void eepromInit(){
@@ -84,6 +146,7 @@ inline void eepromInit(){
 inline void eepromSaveRuntime(){
   uint16_t addr = EEPROM_ADDR_BASE;
   EEPROM.put(addr, EEPROM_MAGIC);   addr += sizeof(uint32_t);
+  EEPROM.put(addr, EEPROM_LAYOUT);  addr += sizeof(uint32_t);
   EEPROM.put(addr, runtimeState);   addr += sizeof(RuntimeState);
   EEPROM.put(addr, lastJob);        addr += sizeof(LastJob);
   EEPROM.commit();
@@ -92,11 +155,12 @@ inline void eepromSaveRuntime(){
 // Load runtimeState + lastJob (with defaults if empty/corrupt)
 inline void eepromLoadAllIntoRuntime(){
   uint16_t addr = EEPROM_ADDR_BASE;
-  uint32_t magic = 0;
-  EEPROM.get(addr, magic); addr += sizeof(magic);
+  uint32_t magic = 0, layout = 0;
+  EEPROM.get(addr, magic);  addr += sizeof(magic);
+  EEPROM.get(addr, layout); addr += sizeof(layout);
 
-  if (EEPROM_SIZE >= (EEPROM_ADDR_BASE + sizeof(magic) + sizeof(RuntimeState) + sizeof(LastJob))
-      && magic == EEPROM_MAGIC)
+  if (EEPROM_SIZE >= (EEPROM_ADDR_BASE + sizeof(magic) + sizeof(layout) + sizeof(RuntimeState) + sizeof(LastJob))
+      && magic == EEPROM_MAGIC && layout == EEPROM_LAYOUT)
   {
     EEPROM.get(addr, runtimeState); addr += sizeof(RuntimeState);
     EEPROM.get(addr, lastJob);      addr += sizeof(LastJob);
@@ -112,6 +176,26 @@ inline void eepromLoadAllIntoRuntime(){
       runtimeState.pulley_teeth = DEFAULT_PULLEY_TEETH;
     if (runtimeState.belt_pitch_mm < 1.0f || runtimeState.belt_pitch_mm > 10.0f)
       runtimeState.belt_pitch_mm = DEFAULT_BELT_PITCH_MM;
+    if (!(runtimeState.resRateHi > runtimeState.resRateLo) || runtimeState.resRateLo < 0.0f)
+      runtimeState.resBandMask = 0;
+    if (runtimeState.calStepsPerCountQ16 && (runtimeState.calStepsPerCountQ16 < 655
+        || runtimeState.calStepsPerCountQ16 > (64UL << 16)))        // 0.01..64 steps/count
+      runtimeState.calStepsPerCountQ16 = 0;
+    if (runtimeState.wifiMode > 2) runtimeState.wifiMode = DEFAULT_WIFI_MODE;
+    if (runtimeState.payload >= TUNE_PROFILES) runtimeState.payload = 0;
+    for (uint8_t i = 0; i < TUNE_PROFILES; ++i) {
+      SlideLimits& l = runtimeState.limits[i];
+      if (!(l.maxMmS > 0.0f && l.maxMmS < 2000.0f && l.accelMmS2 > 0.0f && l.accelMmS2 < 100000.0f))
+        l = SlideLimits();
+    }
+    runtimeState.ap_ssid[sizeof(runtimeState.ap_ssid)-1]   = 0;
+    runtimeState.ap_pass[sizeof(runtimeState.ap_pass)-1]   = 0;
+    runtimeState.sta_ssid[sizeof(runtimeState.sta_ssid)-1] = 0;
+    runtimeState.sta_pass[sizeof(runtimeState.sta_pass)-1] = 0;
+    if (runtimeState.settleWindowMs > 5000)
+      runtimeState.settleWindowMs = DEFAULT_SETTLE_WINDOW_MS;
+    if (runtimeState.settleCounts == 0 || runtimeState.settleCounts > 64)
+      runtimeState.settleCounts = DEFAULT_SETTLE_COUNTS;
   }
   else
   {
@@ -0,0 +1,4 @@
+// AS5600 probe result.
+#include "encoder_utils.h"
+
+bool g_encoderPresent = false;
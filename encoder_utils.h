@@ -22,7 +22,7 @@ static constexpr uint8_t REG_RAW_ANGLE  = 0x0C; // 0x0C (MSB) / 0x0D (LSB) => 12
 static constexpr uint8_t REG_ANGLE      = 0x0E; // filtered angle (optional)
 
 // Internal state
-static bool g_encoderPresent = false;
+extern bool g_encoderPresent;
 
 // Low-level I2C read 16-bit (big-endian register pair)
 inline bool i2cRead16(uint8_t dev, uint8_t regMSB, uint16_t &out)
@@ -86,4 +86,13 @@ inline uint16_t readFilteredAngle()
 
 inline bool encoderIsPresent() { return g_encoderPresent; }
 
+// Signed shortest arc from one raw angle to the next, in counts
+inline int16_t encoderRawDelta(uint16_t from, uint16_t to)
+{
+  int16_t d = (int16_t)to - (int16_t)from;
+  if (d >  2048) d -= 4096;
+  if (d < -2048) d += 4096;
+  return d;
+}
+
 #endif // ENCODER_UTILS_H
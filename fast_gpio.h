@@ -0,0 +1,90 @@
+#ifndef FAST_GPIO_H
+#define FAST_GPIO_H
+
+// Compile-time GPIO for the STEP/DIR hot path.
+// FastPin<N> turns a pin number into a bank + mask at compile time, so a
+// write is one store to GPIO.out_w1ts / out_w1tc instead of a digitalWrite()
+// table lookup and call. Masks of several pins OR together, which lets all
+// axes' STEP lines rise in the same store.
+//
+// Off target (no ARDUINO_ARCH_ESP32) the pins live in g_hostGpio and rising
+// edges are counted per pin, so motion code can be exercised on a PC
+// (jobcheck --edges).
+
+#include <Arduino.h>
+#ifdef ARDUINO_ARCH_ESP32
+  #include <soc/gpio_struct.h>
+  #include <soc/soc_caps.h>
+#endif
+
+// Driver timing from the datasheet (TMC2209: STEP high/low >= 100 ns,
+// DIR setup to STEP >= 20 ns). A4988 wants 1000 / 200, DRV8825 1900 / 650.
+#ifndef STEP_PULSE_NS
+  #define STEP_PULSE_NS 100
+#endif
+#ifndef DIR_SETUP_NS
+  #define DIR_SETUP_NS 20
+#endif
+
+// Bank 0 is GPIO 0..31 (out_w1ts), bank 1 is GPIO 32.. (out1_w1ts).
+struct GpioMask {
+  uint32_t lo;
+  uint32_t hi;
+  constexpr GpioMask operator|(GpioMask o) const { return { lo | o.lo, hi | o.hi }; }
+};
+
+#ifdef ARDUINO_ARCH_ESP32
+inline void IRAM_ATTR gpioSetMask(GpioMask m) {
+  if (m.lo) GPIO.out_w1ts = m.lo;
+#if SOC_GPIO_PIN_COUNT > 32
+  if (m.hi) GPIO.out1_w1ts.val = m.hi;
+#endif
+}
+inline void IRAM_ATTR gpioClearMask(GpioMask m) {
+  if (m.lo) GPIO.out_w1tc = m.lo;
+#if SOC_GPIO_PIN_COUNT > 32
+  if (m.hi) GPIO.out1_w1tc.val = m.hi;
+#endif
+}
+// Busy-wait at least ns; a handful of cycles for the sub-microsecond waits.
+inline void IRAM_ATTR gpioDelayNs(uint32_t ns) {
+  const uint32_t cycles = (uint32_t)(((uint64_t)ns * F_CPU + 999999999ULL) / 1000000000ULL);
+  const uint32_t t0 = ESP.getCycleCount();
+  while (ESP.getCycleCount() - t0 < cycles) {}
+}
+#else
+inline uint64_t g_hostGpio         = 0;
+inline uint32_t g_hostGpioRises[64] = {0};   // 0 -> 1 transitions per pin
+inline uint64_t hostGpioBits(GpioMask m) { return ((uint64_t)m.hi << 32) | m.lo; }
+inline void gpioSetMask(GpioMask m) {
+  const uint64_t b = hostGpioBits(m);
+  for (uint64_t r = b & ~g_hostGpio; r; r &= r - 1) g_hostGpioRises[__builtin_ctzll(r)]++;
+  g_hostGpio |= b;
+}
+inline void gpioClearMask(GpioMask m) { g_hostGpio &= ~hostGpioBits(m); }
+inline bool hostGpioLevel(uint8_t pin) { return (g_hostGpio >> pin) & 1; }
+inline uint32_t hostGpioRises(GpioMask m) {
+  uint32_t n = 0;
+  for (uint64_t b = hostGpioBits(m); b; b &= b - 1) n += g_hostGpioRises[__builtin_ctzll(b)];
+  return n;
+}
+inline void gpioDelayNs(uint32_t) {}
+#endif
+
+template <uint8_t PIN>
+struct FastPin {
+#ifdef SOC_GPIO_PIN_COUNT
+  static_assert(PIN < SOC_GPIO_PIN_COUNT, "not a GPIO on this chip");
+#else
+  static_assert(PIN < 64, "pin out of range");
+#endif
+  static constexpr GpioMask mask() {
+    return PIN < 32 ? GpioMask{ 1UL << (PIN & 31), 0 } : GpioMask{ 0, 1UL << (PIN & 31) };
+  }
+  static void output() { pinMode(PIN, OUTPUT); }
+  static inline void IRAM_ATTR high() { gpioSetMask(mask()); }
+  static inline void IRAM_ATTR low()  { gpioClearMask(mask()); }
+  static inline void IRAM_ATTR write(bool v) { if (v) high(); else low(); }
+};
+
+#endif
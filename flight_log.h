@@ -0,0 +1,68 @@
+#ifndef FLIGHT_LOG_H
+#define FLIGHT_LOG_H
+
+// Flight recorder glue: periodic encoder samples while a plan runs, and the
+// paged dump behind GET /api/log and the serial LOG command.
+//   rec=0 is the live RTC ring, rec=k the k-th newest flash record.
+
+#include <Arduino.h>
+#include "flight_recorder.h"
+#include "encoder_utils.h"
+#include "step_generator.h"
+#include "http_router.h"
+
+#ifndef FREC_SAMPLE_MS
+  #define FREC_SAMPLE_MS 100
+#endif
+
+// Call from loop(): one encoder sample per FREC_SAMPLE_MS while moving.
+inline void flightRecorderTick() {
+  static uint32_t last = 0;
+  if (!plan.active || !encoderIsPresent()) return;
+  const uint32_t now = millis();
+  if ((uint32_t)(now - last) < FREC_SAMPLE_MS) return;
+  last = now;
+  frec(FR_ENC, 0, readRawAngle(), stepPosition());
+}
+
+// Event count of a record; slot is -1 for the live ring. False if missing.
+inline bool frecOpen(uint8_t rec, int& slot, uint16_t& count, FrecRecordHeader& h) {
+  if (rec == 0) {
+    slot = -1; count = frecLiveCount();
+    h = { FREC_REC_MAGIC, 0, g_frec.boots, (uint8_t)esp_reset_reason(), 0, count };
+    return true;
+  }
+  slot = frecRecordSlot(rec - 1);
+  if (slot < 0 || !frecReadHeader((uint8_t)slot, h)) return false;
+  count = h.count;
+  return true;
+}
+inline bool frecGet(int slot, uint16_t idx, FrecEvent& e) {
+  if (slot < 0) { e = frecLiveEvent(idx); return true; }
+  return frecRecordEvent(slot, idx, e);
+}
+
+// GET /api/log?rec=0&from=0 -> one page; follow "next" until it is absent
+inline void flightLogJson(uint8_t rec, uint16_t from, HttpResponse& r) {
+  int slot; uint16_t count; FrecRecordHeader h;
+  r.type = "application/json";
+  if (!frecOpen(rec, slot, count, h)) { r.status = 404; r.add("{\"error\":\"no such record\"}"); return; }
+
+  r.add("{\"rec\":").add((long)rec).add(",\"records\":").add((long)frecRecordCount());
+  r.add(",\"boots\":").add((long)h.boots).add(",\"reset\":").add((long)h.resetReason);
+  r.add(",\"count\":").add((long)count).add(",\"from\":").add((long)from);
+  r.add(",\"ev\":[");
+  uint16_t i = from;
+  FrecEvent e;
+  for (; i < count && r.len + 64 < sizeof(r.body); ++i) {
+    if (!frecGet(slot, i, e)) break;
+    if (i != from) r.add(",");
+    r.add("[").add((long)(e.us / 1000)).add(",").add((long)e.type).add(",").add((long)e.a8)
+     .add(",").add((long)e.a16).add(",").add((long)e.val).add("]");
+  }
+  r.add("]");
+  if (i < count) r.add(",\"next\":").add((long)i);
+  r.add("}");
+}
+
+#endif
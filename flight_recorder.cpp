@@ -0,0 +1,6 @@
+// Flight recorder ring (kept in RTC RAM across resets) and its partition.
+#include "flight_recorder.h"
+
+RTC_NOINIT_ATTR FrecRing g_frec;
+const esp_partition_t* g_frecPart = nullptr;
+uint32_t g_frecNextSeq = 1;
@@ -0,0 +1,181 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+// Always-on event log for post-mortems. Events go into a ring in RTC memory,
+// which survives panics, watchdog and brownout resets; at the next boot
+// after one of those (or after a reset mid-job) the ring is copied to the
+// "flog" flash partition, one 4 KB sector per record, oldest overwritten.
+// frec() is a timestamp, an atomic increment and four stores, so it is
+// cheap enough to call from the step ISR.
+//
+// Low level on purpose: input, motion and control code all include it.
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+
+#ifndef FREC_EVENTS
+  #define FREC_EVENTS 256          // power of two; 12 bytes each
+#endif
+#define FREC_SECTOR 4096
+
+static const uint32_t FREC_MAGIC     = 0x52465053; // 'SPFR'
+static const uint32_t FREC_REC_MAGIC = 0x4C465053; // 'SPFL'
+
+enum FrecType : uint8_t {
+  FR_BOOT = 1,      // a8 reset reason, val boot count
+  FR_JOB,           // a8 job type, a16 segments, val total steps
+  FR_PLAN_START,    // a16 segments, val total steps
+  FR_PLAN_END,      // val steps done
+  FR_PLAN_STOP,     // val steps done
+  FR_SEG,           // a16 segment, val slide position (steps)
+  FR_JOG,           // val distance (um)
+  FR_MOVE,          // val target (um)
+  FR_ENC,           // a16 raw angle, val slide position (steps)
+  FR_INPUT,         // a8 FrecInput
+  FR_SETTLE,        // a8 1 = ran to the bound, val ms
+  FR_REBOOT,        // a8 FrecReboot; deliberate restart follows
+  FR_WIFI,          // a8 WifiLinkState, a16 connect ms, val IPv4
+  FR_DRIVE,         // a8 1 = velocity mode on, 0 = off; val slide position (steps)
+  FR_TAKE,          // a8 1 record / 0 recorded (a16 KB/64, val samples) / 2 play (a16 scale %) / 3 played (a16 max lag)
+  FR_CRAWL,         // a8 1 start (a16 microstep boost, val um/h) / 0 end (val steps moved)
+  FR_RESUME,        // a8 1 resume (a16 segment, val encoder correction steps) / 0 discarded
+};
+enum FrecInput  : uint8_t { FRI_CW = 1, FRI_CCW, FRI_OK, FRI_BACK, FRI_BACK_LONG };
+enum FrecReboot : uint8_t { FRR_OTA = 1 };
+
+struct FrecEvent {
+  uint32_t us;       // esp_timer time, wraps every ~71 min
+  uint8_t  type;
+  uint8_t  a8;
+  uint16_t a16;
+  int32_t  val;
+};
+
+struct FrecRing {
+  uint32_t magic;
+  uint32_t head;           // total events written; index = head % FREC_EVENTS
+  uint32_t boots;
+  uint8_t  planActive;     // set while a plan runs, so a reset mid-job is a fault
+  uint8_t  reserved[3];
+  FrecEvent ev[FREC_EVENTS];
+};
+
+struct FrecRecordHeader {
+  uint32_t magic;
+  uint32_t seq;            // higher = newer
+  uint32_t boots;          // boot count the events led up to
+  uint8_t  resetReason;    // esp_reset_reason_t of the boot that flushed it
+  uint8_t  reserved;
+  uint16_t count;          // events that follow, oldest first
+};
+
+static_assert(sizeof(FrecRecordHeader) + FREC_EVENTS * sizeof(FrecEvent) <= FREC_SECTOR,
+              "flight record must fit one flash sector");
+
+extern FrecRing g_frec;
+extern const esp_partition_t* g_frecPart;
+extern uint32_t g_frecNextSeq;
+
+// ---------- record ----------
+inline void IRAM_ATTR frec(uint8_t type, uint8_t a8 = 0, uint16_t a16 = 0, int32_t val = 0) {
+  const uint32_t i = __atomic_fetch_add(&g_frec.head, 1, __ATOMIC_RELAXED) & (FREC_EVENTS - 1);
+  FrecEvent& e = g_frec.ev[i];
+  e.us = (uint32_t)esp_timer_get_time();
+  e.type = type; e.a8 = a8; e.a16 = a16; e.val = val;
+}
+inline void IRAM_ATTR frecPlanActive(bool on) { g_frec.planActive = on ? 1 : 0; }
+
+// ---------- live ring ----------
+inline uint16_t frecLiveCount() { return (uint16_t)min<uint32_t>(g_frec.head, FREC_EVENTS); }
+// idx 0 = oldest still in the ring
+inline FrecEvent frecLiveEvent(uint16_t idx) {
+  const uint32_t first = g_frec.head - frecLiveCount();
+  return g_frec.ev[(first + idx) & (FREC_EVENTS - 1)];
+}
+
+// ---------- flash records ----------
+inline uint8_t frecSlots() { return g_frecPart ? (uint8_t)min<uint32_t>(255, g_frecPart->size / FREC_SECTOR) : 0; }
+
+inline bool frecReadHeader(uint8_t slot, FrecRecordHeader& h) {
+  return esp_partition_read(g_frecPart, (size_t)slot * FREC_SECTOR, &h, sizeof(h)) == ESP_OK
+      && h.magic == FREC_REC_MAGIC && h.count <= FREC_EVENTS;
+}
+
+// Slot of the k-th newest record (k = 0 newest), or -1.
+inline int frecRecordSlot(uint8_t k) {
+  uint32_t want = 0xFFFFFFFF;
+  int found = -1;
+  for (uint8_t n = 0; n <= k; ++n) {
+    uint32_t best = 0; found = -1;
+    FrecRecordHeader h;
+    for (uint8_t s = 0; s < frecSlots(); ++s)
+      if (frecReadHeader(s, h) && h.seq < want && h.seq >= best) { best = h.seq; found = s; }
+    if (found < 0) return -1;
+    want = best;
+  }
+  return found;
+}
+inline uint8_t frecRecordCount() {
+  uint8_t n = 0;
+  FrecRecordHeader h;
+  for (uint8_t s = 0; s < frecSlots(); ++s) if (frecReadHeader(s, h)) ++n;
+  return n;
+}
+inline bool frecRecordEvent(int slot, uint16_t idx, FrecEvent& e) {
+  return esp_partition_read(g_frecPart, (size_t)slot * FREC_SECTOR + sizeof(FrecRecordHeader)
+                            + (size_t)idx * sizeof(FrecEvent), &e, sizeof(e)) == ESP_OK;
+}
+
+// Copy the live ring into the next flash slot (blocking, one sector erase).
+inline bool frecFlush(uint8_t resetReason) {
+  if (!g_frecPart || frecSlots() == 0) return false;
+  const uint8_t slot = (uint8_t)(g_frecNextSeq % frecSlots());
+  const size_t base = (size_t)slot * FREC_SECTOR;
+  FrecRecordHeader h = { FREC_REC_MAGIC, g_frecNextSeq, g_frec.boots, resetReason, 0, frecLiveCount() };
+
+  if (esp_partition_erase_range(g_frecPart, base, FREC_SECTOR) != ESP_OK) return false;
+  // events in two runs: oldest..end of array, then the wrapped part
+  const uint32_t first = (g_frec.head - h.count) & (FREC_EVENTS - 1);
+  const uint32_t run1  = min<uint32_t>(h.count, FREC_EVENTS - first);
+  size_t off = base + sizeof(h);
+  esp_partition_write(g_frecPart, off, &g_frec.ev[first], run1 * sizeof(FrecEvent));
+  off += run1 * sizeof(FrecEvent);
+  if (h.count > run1) esp_partition_write(g_frecPart, off, &g_frec.ev[0], (h.count - run1) * sizeof(FrecEvent));
+  esp_partition_write(g_frecPart, base, &h, sizeof(h));   // header last: a torn write reads as empty
+  g_frecNextSeq++;
+  return true;
+}
+
+inline bool frecIsFault(esp_reset_reason_t r) {
+  return r == ESP_RST_PANIC || r == ESP_RST_INT_WDT || r == ESP_RST_TASK_WDT
+      || r == ESP_RST_WDT   || r == ESP_RST_BROWNOUT;
+}
+
+// Call early in setup(), before anything that can fault.
+inline void flightRecorderBegin() {
+  g_frecPart = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "flog");
+  FrecRecordHeader h;
+  for (uint8_t s = 0; s < frecSlots(); ++s)
+    if (frecReadHeader(s, h) && h.seq >= g_frecNextSeq) g_frecNextSeq = h.seq + 1;
+
+  const esp_reset_reason_t rr = esp_reset_reason();
+  const bool survived = g_frec.magic == FREC_MAGIC;
+  if (!survived) {
+    memset(&g_frec, 0, sizeof(g_frec));
+    g_frec.magic = FREC_MAGIC;
+  }
+  if (survived && (frecIsFault(rr) || g_frec.planActive)) frecFlush((uint8_t)rr);
+  g_frec.boots++;
+  g_frec.planActive = 0;
+  frec(FR_BOOT, (uint8_t)rr, 0, (int32_t)g_frec.boots);
+}
+
+// Before a deliberate restart (OTA): keep the run-up in flash as well.
+inline void flightRecorderReboot(FrecReboot why) {
+  frec(FR_REBOOT, why);
+  frecFlush((uint8_t)ESP_RST_SW);
+}
+
+#endif
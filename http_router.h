@@ -0,0 +1,333 @@
+#ifndef HTTP_ROUTER_H
+#define HTTP_ROUTER_H
+
+// Fixed-buffer HTTP request router for the control API.
+// Everything here works on views into the caller's receive buffer: the
+// request line, query string and JSON body are never copied, and replies are
+// formatted into a preallocated HttpResponse. No Arduino String, no heap.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+
+#ifndef HTTP_RESP_MAX
+  #define HTTP_RESP_MAX 512
+#endif
+
+// ---------- String view ----------
+struct StrView {
+  const char* p = nullptr;
+  size_t      n = 0;
+
+  bool empty() const { return n == 0; }
+  bool eq(const char* s) const {
+    size_t l = strlen(s);
+    return l == n && memcmp(p, s, n) == 0;
+  }
+  bool startsWith(const char* s) const {
+    size_t l = strlen(s);
+    return l <= n && memcmp(p, s, l) == 0;
+  }
+};
+
+// Numbers arrive unterminated inside the request buffer; copy the few digits
+// onto the stack so strtol/strtof can run on them.
+inline bool svToLong(StrView v, long& out) {
+  char tmp[24];
+  if (v.n == 0 || v.n >= sizeof(tmp)) return false;
+  memcpy(tmp, v.p, v.n); tmp[v.n] = 0;
+  char* end = nullptr;
+  long r = strtol(tmp, &end, 10);
+  if (end == tmp) return false;
+  out = r;
+  return true;
+}
+inline bool svToFloat(StrView v, float& out) {
+  char tmp[24];
+  if (v.n == 0 || v.n >= sizeof(tmp)) return false;
+  memcpy(tmp, v.p, v.n); tmp[v.n] = 0;
+  char* end = nullptr;
+  float r = strtof(tmp, &end);
+  if (end == tmp) return false;
+  out = r;
+  return true;
+}
+
+// ---------- Query string: k1=v1&k2=v2 ----------
+// Values are returned raw (no %-decoding); the control API only carries
+// numbers and short identifiers.
+inline bool queryFind(StrView q, const char* key, StrView& out) {
+  const size_t kl = strlen(key);
+  const char* s = q.p;
+  const char* e = q.p + q.n;
+  while (s < e) {
+    const char* amp = (const char*)memchr(s, '&', e - s);
+    if (!amp) amp = e;
+    const char* eqp = (const char*)memchr(s, '=', amp - s);
+    const char* kEnd = eqp ? eqp : amp;
+    if ((size_t)(kEnd - s) == kl && memcmp(s, key, kl) == 0) {
+      out.p = eqp ? eqp + 1 : amp;
+      out.n = eqp ? (size_t)(amp - eqp - 1) : 0;
+      return true;
+    }
+    s = amp + 1;
+  }
+  return false;
+}
+
+// ---------- Flat JSON object: {"k":1,"s":"x","b":true} ----------
+// Looks up a top-level key. Nested objects/arrays are skipped, and for them
+// the returned view spans the whole bracketed value so callers can descend.
+inline const char* jsonSkipWs(const char* s, const char* e) {
+  while (s < e && (*s==' ' || *s=='\t' || *s=='\r' || *s=='\n')) ++s;
+  return s;
+}
+inline const char* jsonSkipString(const char* s, const char* e) {
+  // s points at the opening quote
+  for (++s; s < e; ++s) {
+    if (*s == '\\') { ++s; continue; }
+    if (*s == '"') return s + 1;
+  }
+  return e;
+}
+// Returns one past the end of the value starting at s.
+inline const char* jsonSkipValue(const char* s, const char* e) {
+  if (s >= e) return e;
+  if (*s == '"') return jsonSkipString(s, e);
+  if (*s == '{' || *s == '[') {
+    int depth = 0;
+    while (s < e) {
+      char c = *s;
+      if (c == '"') { s = jsonSkipString(s, e); continue; }
+      if (c == '{' || c == '[') depth++;
+      if (c == '}' || c == ']') { if (--depth == 0) return s + 1; }
+      ++s;
+    }
+    return e;
+  }
+  while (s < e && *s!=',' && *s!='}' && *s!=']' && *s!=' ' && *s!='\r' && *s!='\n' && *s!='\t') ++s;
+  return s;
+}
+inline bool jsonFind(StrView obj, const char* key, StrView& out) {
+  const char* s = jsonSkipWs(obj.p, obj.p + obj.n);
+  const char* e = obj.p + obj.n;
+  if (s >= e || *s != '{') return false;
+  ++s;
+  const size_t kl = strlen(key);
+  while (s < e) {
+    s = jsonSkipWs(s, e);
+    if (s >= e || *s == '}') return false;
+    if (*s != '"') return false;
+    const char* k0 = s + 1;
+    const char* k1 = jsonSkipString(s, e);
+    size_t klen = (k1 > k0) ? (size_t)(k1 - k0 - 1) : 0;
+    s = jsonSkipWs(k1, e);
+    if (s >= e || *s != ':') return false;
+    s = jsonSkipWs(s + 1, e);
+    const char* v1 = jsonSkipValue(s, e);
+    if (klen == kl && memcmp(k0, key, kl) == 0) {
+      out.p = s; out.n = (size_t)(v1 - s);
+      // strip quotes from string values
+      if (out.n >= 2 && out.p[0] == '"') { out.p++; out.n -= 2; }
+      return true;
+    }
+    s = jsonSkipWs(v1, e);
+    if (s < e && *s == ',') ++s;
+  }
+  return false;
+}
+
+// Iterate a JSON array: start with `it = nullptr`; each call yields the next
+// element (strings unquoted) and returns false after the last one.
+inline bool jsonArrayNext(StrView arr, const char*& it, StrView& out) {
+  const char* e = arr.p + arr.n;
+  const char* s = it ? it : jsonSkipWs(arr.p, e);
+  if (!it) { if (s >= e || *s != '[') return false; ++s; }
+  s = jsonSkipWs(s, e);
+  if (s < e && *s == ',') s = jsonSkipWs(s + 1, e);
+  if (s >= e || *s == ']') return false;
+  const char* v1 = jsonSkipValue(s, e);
+  out.p = s; out.n = (size_t)(v1 - s);
+  if (out.n >= 2 && out.p[0] == '"') { out.p++; out.n -= 2; }
+  it = v1;
+  return true;
+}
+
+// ---------- Request ----------
+enum HttpMethod : uint8_t { HM_GET=0, HM_POST=1, HM_OPTIONS=2, HM_OTHER=3 };
+
+struct HttpRequest {
+  HttpMethod method = HM_OTHER;
+  StrView    path;
+  StrView    query;
+  StrView    body;
+  size_t     contentLength = 0;
+  size_t     headerLen     = 0;   // bytes up to and including the blank line
+
+  // Arguments come from the query string first, then from a JSON body.
+  bool arg(const char* key, StrView& out) const {
+    if (queryFind(query, key, out)) return true;
+    return !body.empty() && jsonFind(body, key, out);
+  }
+  bool has(const char* key) const { StrView v; return arg(key, v); }
+  long argInt(const char* key, long def) const {
+    StrView v; long r;
+    return (arg(key, v) && svToLong(v, r)) ? r : def;
+  }
+  float argFloat(const char* key, float def) const {
+    StrView v; float r;
+    return (arg(key, v) && svToFloat(v, r)) ? r : def;
+  }
+};
+
+enum HttpParse : uint8_t { HP_INCOMPLETE=0, HP_OK=1, HP_BAD=2 };
+
+// Parse "METHOD /path?query HTTP/1.x\r\nHeaders\r\n\r\nbody" in place.
+inline HttpParse httpParseRequest(const char* buf, size_t len, HttpRequest& req) {
+  const char* e = buf + len;
+  const char* hdrEnd = nullptr;
+  for (const char* s = buf; s + 3 < e; ++s) {
+    if (s[0]=='\r' && s[1]=='\n' && s[2]=='\r' && s[3]=='\n') { hdrEnd = s + 4; break; }
+  }
+  if (!hdrEnd) return HP_INCOMPLETE;
+
+  // request line
+  const char* sp1 = (const char*)memchr(buf, ' ', hdrEnd - buf);
+  if (!sp1) return HP_BAD;
+  const char* sp2 = (const char*)memchr(sp1 + 1, ' ', hdrEnd - sp1 - 1);
+  if (!sp2) return HP_BAD;
+
+  StrView m{buf, (size_t)(sp1 - buf)};
+  req.method = m.eq("GET") ? HM_GET : m.eq("POST") ? HM_POST : m.eq("OPTIONS") ? HM_OPTIONS : HM_OTHER;
+
+  const char* t = sp1 + 1;
+  const char* q = (const char*)memchr(t, '?', sp2 - t);
+  req.path  = StrView{t, (size_t)((q ? q : sp2) - t)};
+  req.query = q ? StrView{q + 1, (size_t)(sp2 - q - 1)} : StrView{};
+
+  // Content-Length is the only header the router cares about
+  req.contentLength = 0;
+  const char* line = (const char*)memchr(sp2, '\n', hdrEnd - sp2);
+  while (line && line + 1 < hdrEnd) {
+    const char* ls = line + 1;
+    const char* le = (const char*)memchr(ls, '\n', hdrEnd - ls);
+    if (!le) break;
+    static const char CL[] = "content-length:";
+    const size_t cl = sizeof(CL) - 1;
+    if ((size_t)(le - ls) > cl) {
+      bool match = true;
+      for (size_t i = 0; i < cl; ++i) {
+        char c = ls[i]; if (c >= 'A' && c <= 'Z') c += 32;
+        if (c != CL[i]) { match = false; break; }
+      }
+      if (match) req.contentLength = (size_t)strtoul(ls + cl, nullptr, 10);
+    }
+    line = le;
+  }
+
+  req.headerLen = (size_t)(hdrEnd - buf);
+  if (len - req.headerLen < req.contentLength) return HP_INCOMPLETE;
+  req.body = StrView{hdrEnd, req.contentLength};
+  return HP_OK;
+}
+
+// ---------- Response (preallocated) ----------
+struct HttpResponse {
+  int         status = 200;
+  const char* type   = "text/plain";
+  char        body[HTTP_RESP_MAX];
+  size_t      len    = 0;
+
+  void reset() { status = 200; type = "text/plain"; len = 0; body[0] = 0; }
+  HttpResponse& add(const char* s) {
+    if (len >= sizeof(body) - 1) return *this;            // full: the rest is dropped
+    size_t l = strlen(s);
+    if (l > sizeof(body) - 1 - len) l = sizeof(body) - 1 - len;
+    memcpy(body + len, s, l); len += l; body[len] = 0;
+    return *this;
+  }
+  HttpResponse& add(long v) {
+    char tmp[21]; int i = sizeof(tmp); tmp[--i] = 0;      // 64-bit long on a PC
+    bool neg = v < 0; unsigned long u = neg ? 0UL - (unsigned long)v : (unsigned long)v;
+    do { tmp[--i] = (char)('0' + u % 10); u /= 10; } while (u);
+    if (neg) tmp[--i] = '-';
+    return add(tmp + i);
+  }
+  // Fixed-point with `decimals` places; avoids printf("%f") pulling in the heap.
+  HttpResponse& add(float v, int decimals) {
+    long scale = 1; for (int i = 0; i < decimals; ++i) scale *= 10;
+    long fx = (long)(v * scale + (v < 0 ? -0.5f : 0.5f));
+    if (fx < 0) { add("-"); fx = -fx; }
+    add(fx / scale);
+    if (decimals > 0) {
+      char frac[12]; long f = fx % scale;
+      for (int i = decimals - 1; i >= 0; --i) { frac[i] = (char)('0' + f % 10); f /= 10; }
+      frac[decimals] = 0;
+      add(".").add(frac);
+    }
+    return *this;
+  }
+  void text(int code, const char* s) { reset(); status = code; add(s); }
+};
+
+// ---------- Routing ----------
+typedef void (*HttpHandler)(const HttpRequest& req, HttpResponse& resp);
+
+struct HttpRoute {
+  HttpMethod  method;
+  const char* path;
+  HttpHandler handler;
+};
+
+inline void httpDispatch(const HttpRoute* routes, size_t count, const HttpRequest& req, HttpResponse& resp) {
+  resp.reset();
+  bool pathSeen = false;
+  for (size_t i = 0; i < count; ++i) {
+    if (!req.path.eq(routes[i].path)) continue;
+    pathSeen = true;
+    if (routes[i].method == req.method) { routes[i].handler(req, resp); return; }
+  }
+  if (req.method == HM_OPTIONS && pathSeen) { resp.status = 204; return; } // CORS preflight
+  if (pathSeen) resp.text(405, "405");
+  else          resp.text(404, "404");
+}
+
+inline const char* httpReason(int status) {
+  switch (status) {
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 409: return "Conflict";
+    case 413: return "Payload Too Large";
+    default:  return "Error";
+  }
+}
+
+// Status line + headers into a caller buffer; returns bytes written.
+inline size_t httpFormatHead(const HttpResponse& resp, char* out, size_t cap) {
+  size_t n = 0;
+  auto put = [&](const char* s) {
+    if (n + 1 >= cap) return;
+    size_t l = strlen(s);
+    if (l > cap - 1 - n) l = cap - 1 - n;
+    memcpy(out + n, s, l); n += l; out[n] = 0;
+  };
+  char num[21]; int i = sizeof(num); num[--i] = 0;
+  unsigned long u = (unsigned long)resp.len;
+  do { num[--i] = (char)('0' + u % 10); u /= 10; } while (u);
+  char code[4] = { (char)('0' + resp.status/100 % 10), (char)('0' + resp.status/10 % 10),
+                   (char)('0' + resp.status % 10), 0 };
+
+  put("HTTP/1.1 "); put(code); put(" "); put(httpReason(resp.status)); put("\r\n");
+  put("Content-Type: "); put(resp.type); put("\r\n");
+  put("Content-Length: "); put(num + i); put("\r\n");
+  put("Access-Control-Allow-Origin: *\r\n");
+  put("Access-Control-Allow-Headers: Content-Type\r\n");
+  put("Connection: close\r\n\r\n");
+  return n;
+}
+
+#endif
@@ -0,0 +1,6 @@
+// Band buffer shared by every image draw.
+#include "image_asset.h"
+#include "mem_pool.h"
+
+uint16_t  g_imgBand[IMG_BAND_PIXELS];
+MemStatic g_imgMem("image", sizeof(g_imgBand));
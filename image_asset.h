@@ -0,0 +1,125 @@
+#ifndef IMAGE_ASSET_H
+#define IMAGE_ASSET_H
+
+// Compressed images in flash, decoded a band of rows at a time straight to
+// the panel or a sprite: no frame buffer, and the SPI bus only carries the
+// image's own pixels. tools/pack_assets.py turns assets/*.png into
+// assets.cpp / assets.h.
+//
+// The stream is QOI's op set cut down to RGB565. Pixels run left to right,
+// top to bottom, continuing across rows; the decoder starts from black with
+// an empty 64-entry index of recently seen colours.
+//
+//   00iiiiii           INDEX  colour at index[i]
+//   01rrggbb           DIFF   r, g, b each change by -2..1
+//   10gggggg rrrrbbbb  LUMA   g changes by -32..31, r and b by that/2 + -8..7
+//   11nnnnnn           RUN    previous colour n+1 times (1..62)
+//   11111110 lo hi     RGB    literal colour
+//
+// Channel changes wrap (5/6/5 bits). Every decoded colour goes into
+// index[(r*3 + g*5 + b*7) & 63]. Transparent pixels are stored as the
+// asset's key colour and drawn in the caller's background.
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+
+#ifndef IMG_BAND_PIXELS
+  #define IMG_BAND_PIXELS 2048   // pixels decoded per push (4 KB)
+#endif
+
+struct ImageAsset {
+  const uint8_t* data;
+  uint32_t       len;
+  uint16_t       w, h;
+  uint16_t       key;       // transparent colour, when hasKey
+  bool           hasKey;
+};
+
+extern uint16_t g_imgBand[IMG_BAND_PIXELS];
+
+// ---------- decoder ----------
+struct ImgDecoder {
+  const uint8_t* p   = nullptr;
+  const uint8_t* end = nullptr;
+  uint16_t px  = 0;
+  uint8_t  run = 0;
+  uint16_t index[64] = {0};
+};
+
+inline uint8_t imgHash(uint16_t c) {
+  return (uint8_t)(((c >> 11) * 3 + ((c >> 5) & 63) * 5 + (c & 31) * 7) & 63);
+}
+
+inline void imgBegin(ImgDecoder& d, const ImageAsset& a) {
+  d = ImgDecoder();
+  d.p = a.data;
+  d.end = a.data + a.len;
+}
+
+// Next colour; a truncated stream repeats the last one.
+inline uint16_t imgNext(ImgDecoder& d) {
+  if (d.run) { d.run--; return d.px; }
+  if (d.p >= d.end) return d.px;
+  const uint8_t b = *d.p++;
+  if (b == 0xFE) {
+    if (d.end - d.p < 2) { d.p = d.end; return d.px; }
+    d.px = (uint16_t)(d.p[0] | (d.p[1] << 8));
+    d.p += 2;
+  } else {
+    int r = d.px >> 11, g = (d.px >> 5) & 63, bl = d.px & 31;
+    switch (b >> 6) {
+      case 0: d.px = d.index[b & 63]; return d.px;
+      case 1:
+        r += ((b >> 4) & 3) - 2; g += ((b >> 2) & 3) - 2; bl += (b & 3) - 2;
+        break;
+      case 2: {
+        if (d.p >= d.end) return d.px;
+        const uint8_t b2 = *d.p++;
+        const int dg = (b & 63) - 32, half = dg >> 1;
+        r += half + (b2 >> 4) - 8; g += dg; bl += half + (b2 & 15) - 8;
+        break;
+      }
+      default: d.run = b & 63; return d.px;
+    }
+    d.px = (uint16_t)(((r & 31) << 11) | ((g & 63) << 5) | (bl & 31));
+  }
+  d.index[imgHash(d.px)] = d.px;
+  return d.px;
+}
+
+// Decode n pixels into out, key colour replaced by bg.
+inline void imgDecode(ImgDecoder& d, const ImageAsset& a, uint16_t* out, uint32_t n, uint16_t bg) {
+  for (uint32_t i = 0; i < n; ++i) {
+    const uint16_t c = imgNext(d);
+    out[i] = (a.hasKey && c == a.key) ? bg : c;
+  }
+}
+
+// ---------- drawing ----------
+// Draw at (x, y) on the panel or a sprite (TFT_eSprite is a TFT_eSPI), as
+// many whole rows per push as fit in the band buffer. Not reentrant: one
+// band buffer, drawing happens on the loop task.
+inline void imgDraw(TFT_eSPI& dst, const ImageAsset& a, int32_t x, int32_t y, uint16_t bg) {
+  if (!a.w || !a.h) return;
+  ImgDecoder d;
+  imgBegin(d, a);
+  const uint16_t rows = (uint16_t)max<uint32_t>(1, IMG_BAND_PIXELS / a.w);
+  const bool swap = dst.getSwapBytes();
+  dst.setSwapBytes(true);                     // band holds native-endian colours
+  for (uint16_t r = 0; r < a.h; r += rows) {
+    const uint16_t n = (uint16_t)min<uint32_t>(rows, a.h - r);
+    if (a.w <= IMG_BAND_PIXELS) {
+      imgDecode(d, a, g_imgBand, (uint32_t)a.w * n, bg);
+      dst.pushImage(x, y + r, a.w, n, g_imgBand);
+    } else {                                  // wider than the band: in pieces
+      for (uint32_t c = 0; c < a.w; c += IMG_BAND_PIXELS) {
+        const uint32_t m = min<uint32_t>(IMG_BAND_PIXELS, a.w - c);
+        imgDecode(d, a, g_imgBand, m, bg);
+        dst.pushImage(x + c, y + r, m, 1, g_imgBand);
+      }
+    }
+  }
+  dst.setSwapBytes(swap);
+}
+
+#endif
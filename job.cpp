@@ -0,0 +1,8 @@
+// Loaded job and the job arena.
+#include "job.h"
+
+JobSpec     g_job;
+bool        g_jobLoaded = false;
+const char* g_jobError  = nullptr;
+uint16_t    g_jobErrorLeg = 0;
+MemArena    g_jobArena;
@@ -0,0 +1,398 @@
+#ifndef JOB_H
+#define JOB_H
+
+// Whole-job description as uploaded by the web app (or built by a wizard),
+// its validation against the rig, and compilation into the motion plan.
+//
+// JSON (POST /api/job):
+//   {"type":"bounce","a":0,"b":550,"ms":60000,"pct":50,"pause":500,
+//    "repeat":3,"shots":0,"kf":[[pos_mm,ms,pause_ms,pan_deg,tilt_deg],...],
+//    "pa":0,"pb":0,"ta":0,"tb":0}
+// "a"/"b" default to the saved endpoints, "ms":0 means "use pct".
+// Pan/tilt angles ("pa"/"pb", "ta"/"tb", keyframe columns 4-5) are only
+// used when those axes are built in; all axes share each leg's timeline.
+//
+// Binary (same endpoint, little-endian): JobWireHeader followed by
+// `kfCount` JobWireKeyframe records.
+
+#include <Arduino.h>
+#include "config.h"
+#include "eeprom_utils.h"
+#include "motion_plan.h"
+#include "step_generator.h"
+#include "settle.h"
+#include "http_router.h"
+#include "mem_pool.h"
+
+#ifndef JOB_MAX_KEYFRAMES
+  #define JOB_MAX_KEYFRAMES 16
+#endif
+#ifndef JOB_REHOME_PCT
+  #define JOB_REHOME_PCT    80    // speed for positioning moves before/between runs
+#endif
+#define JOB_MAX_PAUSE_MS    PLAN_DWELL_MAX_MS   // a pause or settle is one plan segment
+#ifndef JOB_ARENA_PSRAM
+  #define JOB_ARENA_PSRAM   (64 * 1024)
+#endif
+#ifndef JOB_ARENA_RAM
+  #define JOB_ARENA_RAM     (6 * 1024)   // no PSRAM: a spec and a plan cache slot
+#endif
+
+struct JobKeyframe {
+  float    pos_mm  = 0.0f;
+  float    pan     = 0.0f;    // degrees
+  float    tilt    = 0.0f;
+  uint32_t ms      = 0;       // leg duration into this keyframe, 0 = use speedPct
+  uint32_t pauseMs = 0;       // dwell after arriving
+};
+
+struct JobSpec {
+  JobType     type     = JOB_NONE;
+  float       a_mm     = 0.0f;
+  float       b_mm     = 0.0f;
+  float       aPan     = 0.0f,  bPan  = 0.0f;   // degrees at A / B
+  float       aTilt    = 0.0f,  bTilt = 0.0f;
+  uint32_t    totalMS  = 0;       // 0 = use speedPct
+  uint8_t     speedPct = 50;
+  uint32_t    pauseMs  = 0;       // dwell at each stop
+  uint16_t    repeat   = 1;
+  uint16_t    shots    = 0;       // timelapse stops (incl. both ends)
+  uint8_t     kfCount  = 0;
+  JobKeyframe kf[JOB_MAX_KEYFRAMES];
+};
+
+static const uint32_t JOB_WIRE_MAGIC = 0x324A5053; // 'SPJ2'
+
+struct __attribute__((packed)) JobWireHeader {
+  uint32_t magic;
+  uint8_t  type;
+  uint8_t  speedPct;
+  uint16_t repeat;
+  float    a_mm;
+  float    b_mm;
+  uint32_t totalMS;
+  uint32_t pauseMs;
+  uint16_t shots;
+  uint8_t  kfCount;
+  uint8_t  reserved;
+  float    aPan, bPan, aTilt, bTilt;
+};
+struct __attribute__((packed)) JobWireKeyframe {
+  float    pos_mm;
+  uint32_t ms;
+  uint32_t pauseMs;
+  float    pan;
+  float    tilt;
+};
+
+// plan_cache.cpp
+bool planCacheStore(const JobSpec& spec);
+// resume.cpp
+void resumeArm();
+
+extern JobSpec     g_job;
+extern bool        g_jobLoaded;
+extern const char* g_jobError;
+extern uint16_t    g_jobErrorLeg;   // timed leg (1-based) that failed to compile
+
+// Scratch for building one job (parsed spec, plan cache code). Taken once,
+// call jobArena() early at boot; reset when the next job is submitted.
+extern MemArena    g_jobArena;
+inline MemArena& jobArena() { arenaBegin(g_jobArena, "job", JOB_ARENA_PSRAM, JOB_ARENA_RAM); return g_jobArena; }
+inline void      jobArenaReset() { arenaReset(jobArena()); }
+
+// ---------- parsing ----------
+inline JobType jobTypeFromView(StrView v) {
+  if (v.eq("single")    || v.eq("1")) return JOB_SINGLE;
+  if (v.eq("bounce")    || v.eq("2")) return JOB_BOUNCE;
+  if (v.eq("multi")     || v.eq("3")) return JOB_MULTI;
+  if (v.eq("timelapse") || v.eq("4")) return JOB_TIMELAPSE;
+  return JOB_NONE;
+}
+inline const char* jobTypeName(JobType t) {
+  switch (t) {
+    case JOB_SINGLE:    return "single";
+    case JOB_BOUNCE:    return "bounce";
+    case JOB_MULTI:     return "multi";
+    case JOB_TIMELAPSE: return "timelapse";
+    default:            return "none";
+  }
+}
+
+inline void jobDefaults(JobSpec& j) {
+  j = JobSpec();
+  if (runtimeState.endpointsSaved) { j.a_mm = runtimeState.endpointA_mm; j.b_mm = runtimeState.endpointB_mm; }
+  else                             { j.a_mm = g_axes[AXIS_SLIDE].minPos; j.b_mm = g_axes[AXIS_SLIDE].maxPos; }
+  j.pauseMs  = runtimeState.defaultPauseMs;
+  j.speedPct = (uint8_t)getSpeedPercent();
+}
+
+inline bool jobParseJson(StrView body, JobSpec& j, const char*& err) {
+  jobDefaults(j);
+  StrView v; long l; float f;
+  if (jsonFind(body, "type", v))  j.type = jobTypeFromView(v);
+  if (jsonFind(body, "a", v)     && svToFloat(v, f)) j.a_mm = f;
+  if (jsonFind(body, "b", v)     && svToFloat(v, f)) j.b_mm = f;
+  if (jsonFind(body, "ms", v)    && svToLong(v, l))  j.totalMS  = (uint32_t)max(0L, l);
+  if (jsonFind(body, "pct", v)   && svToLong(v, l))  j.speedPct = (uint8_t)clampT(l, 5L, 100L);
+  if (jsonFind(body, "pause", v) && svToLong(v, l))  j.pauseMs  = (uint32_t)max(0L, l);
+  if (jsonFind(body, "repeat", v)&& svToLong(v, l))  j.repeat   = (uint16_t)clampT(l, 0L, 65535L);
+  if (jsonFind(body, "shots", v) && svToLong(v, l))  j.shots    = (uint16_t)clampT(l, 0L, 65535L);
+  if (jsonFind(body, "pa", v)    && svToFloat(v, f)) j.aPan  = f;
+  if (jsonFind(body, "pb", v)    && svToFloat(v, f)) j.bPan  = f;
+  if (jsonFind(body, "ta", v)    && svToFloat(v, f)) j.aTilt = f;
+  if (jsonFind(body, "tb", v)    && svToFloat(v, f)) j.bTilt = f;
+
+  StrView arr;
+  if (jsonFind(body, "kf", arr)) {
+    const char* it = nullptr; StrView row;
+    while (jsonArrayNext(arr, it, row)) {
+      if (j.kfCount >= JOB_MAX_KEYFRAMES) { err = "too many keyframes"; return false; }
+      JobKeyframe& k = j.kf[j.kfCount++];
+      const char* it2 = nullptr; StrView cell; int col = 0;
+      while (jsonArrayNext(row, it2, cell)) {
+        if (col == 0 && svToFloat(cell, f)) k.pos_mm  = f;
+        if (col == 1 && svToLong(cell, l))  k.ms      = (uint32_t)max(0L, l);
+        if (col == 2 && svToLong(cell, l))  k.pauseMs = (uint32_t)max(0L, l);
+        if (col == 3 && svToFloat(cell, f)) k.pan     = f;
+        if (col == 4 && svToFloat(cell, f)) k.tilt    = f;
+        col++;
+      }
+      if (col == 0) { err = "bad keyframe"; return false; }
+      if (col < 3) k.pauseMs = j.pauseMs;
+    }
+  }
+  return true;
+}
+
+inline bool jobParseBinary(const uint8_t* p, size_t n, JobSpec& j, const char*& err) {
+  if (n < sizeof(JobWireHeader)) { err = "short header"; return false; }
+  JobWireHeader h; memcpy(&h, p, sizeof(h));
+  if (h.magic != JOB_WIRE_MAGIC) { err = "bad magic"; return false; }
+  if (h.kfCount > JOB_MAX_KEYFRAMES) { err = "too many keyframes"; return false; }
+  if (n < sizeof(h) + h.kfCount * sizeof(JobWireKeyframe)) { err = "short keyframes"; return false; }
+  j = JobSpec();
+  j.type = (JobType)h.type; j.speedPct = (uint8_t)clampT<int>(h.speedPct, 5, 100);
+  j.repeat = h.repeat; j.a_mm = h.a_mm; j.b_mm = h.b_mm;
+  j.totalMS = h.totalMS; j.pauseMs = h.pauseMs; j.shots = h.shots; j.kfCount = h.kfCount;
+  j.aPan = h.aPan; j.bPan = h.bPan; j.aTilt = h.aTilt; j.bTilt = h.bTilt;
+  const uint8_t* k = p + sizeof(h);
+  for (uint8_t i = 0; i < h.kfCount; ++i, k += sizeof(JobWireKeyframe)) {
+    JobWireKeyframe w; memcpy(&w, k, sizeof(w));
+    j.kf[i].pos_mm = w.pos_mm; j.kf[i].ms = w.ms; j.kf[i].pauseMs = w.pauseMs;
+    j.kf[i].pan = w.pan; j.kf[i].tilt = w.tilt;
+  }
+  return true;
+}
+
+inline bool jobParse(StrView body, JobSpec& j, const char*& err) {
+  if (body.n >= 4) {
+    uint32_t m; memcpy(&m, body.p, 4);
+    if (m == JOB_WIRE_MAGIC) return jobParseBinary((const uint8_t*)body.p, body.n, j, err);
+  }
+  return jobParseJson(body, j, err);
+}
+
+// ---------- validation ----------
+inline bool jobAxisOk(uint8_t a, float v) {
+  return a >= MOTION_AXES || (v >= g_axes[a].minPos && v <= g_axes[a].maxPos);
+}
+inline bool jobPosOk(float mm) { return jobAxisOk(AXIS_SLIDE, mm); }
+inline bool jobHeadOk(float pan, float tilt) { return jobAxisOk(AXIS_PAN, pan) && jobAxisOk(AXIS_TILT, tilt); }
+
+inline bool jobValidate(const JobSpec& j, const char*& err) {
+  if (j.type == JOB_NONE)                  { err = "unknown type"; return false; }
+  if (j.repeat == 0 || j.repeat > 1000)    { err = "repeat out of range"; return false; }
+  if (j.totalMS > 24UL*3600UL*1000UL)      { err = "duration out of range"; return false; }
+  if (j.pauseMs > JOB_MAX_PAUSE_MS)        { err = "pause out of range"; return false; }
+  if (!jobPosOk(j.a_mm) || !jobPosOk(j.b_mm)) { err = "endpoint outside travel"; return false; }
+  if (!jobHeadOk(j.aPan, j.aTilt) || !jobHeadOk(j.bPan, j.bTilt)) { err = "head angle outside limits"; return false; }
+  if (j.type == JOB_MULTI) {
+    if (j.kfCount < 2) { err = "need 2+ keyframes"; return false; }
+    for (uint8_t i = 0; i < j.kfCount; ++i) {
+      if (!jobPosOk(j.kf[i].pos_mm) || !jobHeadOk(j.kf[i].pan, j.kf[i].tilt)) { err = "keyframe outside travel"; return false; }
+      if (j.kf[i].pauseMs > JOB_MAX_PAUSE_MS) { err = "pause out of range"; return false; }
+    }
+  }
+  if (j.type == JOB_TIMELAPSE) {
+    if (j.shots < 2)   { err = "need 2+ shots"; return false; }
+    if (j.repeat != 1) { err = "timelapse cannot repeat"; return false; }
+    // a pause that fills the interval leaves no time to move: the legs
+    // would fall back to speedPct and the job would run past totalMS
+    if (j.totalMS && j.totalMS / (j.shots - 1) <= j.pauseMs) { err = "pause longer than shot interval"; return false; }
+  }
+  return true;
+}
+
+// ---------- compilation ----------
+// A pose is slide mm + pan/tilt degrees; axes not built in are ignored.
+struct JobPose { float v[3]; };
+inline JobPose jobPoseA(const JobSpec& j) { return JobPose{{ j.a_mm, j.aPan, j.aTilt }}; }
+inline JobPose jobPoseB(const JobSpec& j) { return JobPose{{ j.b_mm, j.bPan, j.bTilt }}; }
+inline JobPose jobPoseKf(const JobKeyframe& k) { return JobPose{{ k.pos_mm, k.pan, k.tilt }}; }
+
+struct JobCompiler {
+  int32_t   at[MOTION_AXES];   // steps, where each axis will be
+  PlanError err = PLAN_OK;
+  uint16_t  timedLegs = 0;
+
+  JobCompiler() { for (uint8_t a = 0; a < MOTION_AXES; ++a) at[a] = axisPosition(a); }
+
+  int32_t toSteps(uint8_t a, float units) const { return (int32_t)lroundf(units * axisStepsPerUnit(a)); }
+
+  void moveBy(const int32_t d[MOTION_AXES], uint32_t ms, uint8_t pct) {
+    if (err != PLAN_OK) return;
+    if (ms) ++timedLegs;
+    err = ms ? planAddMoveAxesTimed(d, ms)
+             : planAddMoveAxes(d, 1e6f / usPerStepForPercent(pct));
+    if (err != PLAN_OK && ms) g_jobErrorLeg = timedLegs;
+    for (uint8_t a = 0; a < MOTION_AXES; ++a) at[a] += d[a];
+  }
+  void moveTo(const JobPose& p, uint32_t ms, uint8_t pct) {
+    int32_t d[MOTION_AXES];
+    for (uint8_t a = 0; a < MOTION_AXES; ++a) d[a] = toSteps(a, p.v[a]) - at[a];
+    moveBy(d, ms, pct);
+  }
+  void rehome(const JobPose& p) { moveTo(p, 0, JOB_REHOME_PCT); }
+  void dwell(uint32_t ms) { if (err == PLAN_OK) err = planAddDwell(ms); }
+  void settle(uint32_t maxMs) { if (err == PLAN_OK) err = planAddSettle(maxMs); }
+};
+
+// Build `plan` from a validated job starting at the current carriage position.
+inline PlanError jobCompile(const JobSpec& j) {
+  planReset();
+  g_jobErrorLeg = 0;
+  JobCompiler c;
+  const JobPose A = jobPoseA(j), B = jobPoseB(j);
+  uint16_t loops = j.repeat;
+
+  switch (j.type) {
+    case JOB_SINGLE:
+      c.rehome(A);
+      planMarkEntry(c.at);
+      planBeginLoop();
+      c.moveTo(B, j.totalMS, j.speedPct);
+      if (j.repeat > 1) { c.dwell(j.pauseMs); c.rehome(A); c.dwell(j.pauseMs); }
+      break;
+
+    case JOB_BOUNCE:
+      c.rehome(A);
+      planMarkEntry(c.at);
+      planBeginLoop();
+      c.moveTo(B, j.totalMS, j.speedPct); c.dwell(j.pauseMs);
+      c.moveTo(A, j.totalMS, j.speedPct); c.dwell(j.pauseMs);
+      break;
+
+    case JOB_MULTI:
+      c.rehome(jobPoseKf(j.kf[0]));
+      planMarkEntry(c.at);
+      c.dwell(j.kf[0].pauseMs);
+      planBeginLoop();
+      for (uint8_t i = 1; i < j.kfCount; ++i) {
+        c.moveTo(jobPoseKf(j.kf[i]), j.kf[i].ms, j.speedPct);
+        c.dwell(j.kf[i].pauseMs);
+      }
+      if (j.repeat > 1) { c.rehome(jobPoseKf(j.kf[0])); c.dwell(j.kf[0].pauseMs); }
+      break;
+
+    case JOB_TIMELAPSE: {
+      // shoot-move-shoot: the body is one leg + one dwell, looped per shot.
+      // Steps that don't divide evenly go to a last leg after the loop, so
+      // the final shot is taken exactly at B.
+      const uint16_t legs = j.shots - 1;
+      int32_t leg[MOTION_AXES], last[MOTION_AXES];
+      bool uneven = false;
+      for (uint8_t a = 0; a < MOTION_AXES; ++a) {
+        const int32_t span = c.toSteps(a, B.v[a]) - c.toSteps(a, A.v[a]);
+        leg[a]  = span / legs;
+        last[a] = leg[a] + span % legs;
+        uneven |= last[a] != leg[a];
+      }
+      uint32_t legMs = 0;
+      if (j.totalMS) {
+        uint32_t per = j.totalMS / legs;
+        legMs = (per > j.pauseMs) ? per - j.pauseMs : 0;
+      }
+      c.rehome(A);
+      planMarkEntry(c.at);
+      c.dwell(j.pauseMs);
+      planBeginLoop();
+      // untimed runs go as soon as the rig is still; timed ones keep the
+      // fixed pause so the shot interval stays even
+      auto shoot = [&](const int32_t d[MOTION_AXES]) {
+        c.moveBy(d, legMs, j.speedPct);
+        if (j.totalMS) c.dwell(j.pauseMs);
+        else           c.settle(j.pauseMs);
+      };
+      shoot(leg);
+      loops = legs;
+      if (uneven) { planEndLoop(); shoot(last); loops = legs - 1; }
+      break;
+    }
+    default:
+      return PLAN_ERR_RANGE;
+  }
+
+  if (c.err != PLAN_OK) { planReset(); return c.err; }
+  planFinalize(loops);
+  return PLAN_OK;
+}
+
+// Validate + compile + start. Sets g_jobError on failure.
+inline bool jobRun(const JobSpec& j, bool start = true) {
+  g_jobError = nullptr;
+  if (motionBusy()) { g_jobError = "busy"; return false; }
+  const char* err = nullptr;
+  if (!jobValidate(j, err)) { g_jobError = err; return false; }
+  PlanError pe = jobCompile(j);
+  if (pe != PLAN_OK) { g_jobError = planErrorText(pe); return false; }
+  g_job = j;
+  g_jobLoaded = true;
+  // cache before the timer starts: a flash erase would stall the step ISR
+  if (start) { planCacheStore(j); resumeArm(); settleReset(); frec(FR_JOB, j.type, plan.count, (int32_t)plan.totalSteps); }
+  if (start && !planStart()) { g_jobError = "empty plan"; return false; }
+  return true;
+}
+
+// ---------- status ----------
+enum JobRunState : uint8_t { JOB_IDLE = 0, JOB_RUNNING, JOB_DONE, JOB_STOPPED };
+
+inline JobRunState jobRunState() {
+  if (plan.active)  return JOB_RUNNING;
+  if (!g_jobLoaded) return JOB_IDLE;
+  return (plan.stepsDone >= plan.totalSteps) ? JOB_DONE : JOB_STOPPED;
+}
+inline const char* jobRunStateName(JobRunState s) {
+  static const char* const names[] = { "idle", "running", "done", "stopped" };
+  return names[s];
+}
+
+inline void jobStatusJson(HttpResponse& r) {
+  const bool running = plan.active;
+  const char* state = jobRunStateName(jobRunState());
+  uint32_t elapsed = (g_jobLoaded && plan.startedMs) ? (millis() - plan.startedMs) : 0;
+  uint32_t eta = (running && plan.totalMs > elapsed) ? plan.totalMs - elapsed : 0;
+
+  r.type = "application/json";
+  r.add("{\"state\":\"").add(state).add("\"");
+  r.add(",\"type\":\"").add(jobTypeName(g_jobLoaded ? g_job.type : JOB_NONE)).add("\"");
+  r.add(",\"seg\":").add((long)plan.cur).add(",\"segs\":").add((long)plan.count);
+  r.add(",\"loop\":").add((long)plan.loopsDone + 1).add(",\"loops\":").add((long)plan.loops);
+  r.add(",\"steps\":").add((long)plan.stepsDone).add(",\"total\":").add((long)plan.totalSteps);
+  r.add(",\"elapsedMs\":").add((long)elapsed).add(",\"etaMs\":").add((long)eta);
+  r.add(",\"pos\":").add(stepPositionMM(), 2);
+#if MOTION_AXES > 1
+  r.add(",\"pan\":").add(axisPositionUnits(AXIS_PAN), 2);
+#endif
+#if MOTION_AXES > 2
+  r.add(",\"tilt\":").add(axisPositionUnits(AXIS_TILT), 2);
+#endif
+  if (g_settle.count) {
+    r.add(",\"settle\":{\"n\":").add((long)g_settle.count);
+    r.add(",\"lastMs\":").add((long)settleLastMs()).add(",\"avgMs\":").add((long)settleAvgMs());
+    r.add(",\"maxMs\":").add((long)g_settle.maxMs).add(",\"timeouts\":").add((long)g_settle.timeouts).add("}");
+  }
+  r.add("}");
+}
+
+#endif
@@ -0,0 +1,182 @@
+#ifndef JOB_CHECK_H
+#define JOB_CHECK_H
+
+// Feasibility and ETA for a job before it runs. The job is validated and
+// compiled exactly as jobRun() would (same planner, same rig scale from
+// runtimeState), then the compiled plan is walked for what it asks of each
+// axis: peak step rate, the rate steps between adjacent segments (the
+// acceleration demand) and the exact duration the step ISR will take.
+// Settle dwells count at their upper bound, so the ETA is a ceiling for
+// untimed timelapses. Used by POST /api/job?dry=1, the serial JOB dry reply,
+// the single-slide wizard and tools/jobcheck (the same code on a PC).
+
+#include <Arduino.h>
+#include "job.h"
+#include "http_router.h"
+
+// Violations, as a bitmask
+enum JobCheckFlag : uint16_t {
+  JC_INVALID  = 0x0001,   // rejected by jobParse/jobValidate
+  JC_TOO_FAST = 0x0002,   // a timed leg is shorter than the rig can move it
+  JC_TOO_LONG = 0x0004,   // more segments than the plan holds
+  JC_RANGE    = 0x0008,   // could not be compiled from here
+  JC_RATE     = 0x0010,   // a segment steps faster than its axis can follow
+  JC_ACCEL    = 0x0020,   // a rate change steeper than the axis accel
+  JC_INTERVAL = 0x0040,   // unused, jobValidate rejects such a pause; bit and name kept
+  JC_BUSY     = 0x0080,   // motion running, nothing checked
+};
+static const uint8_t JC_FLAG_COUNT = 8;
+
+inline const char* jobCheckFlagName(uint8_t bit) {
+  static const char* const names[JC_FLAG_COUNT] = {
+    "invalid", "too-fast", "too-long", "range", "rate", "accel", "interval", "busy" };
+  return bit < JC_FLAG_COUNT ? names[bit] : "?";
+}
+
+// Headroom over the axis limits for rounding in the planner
+#ifndef JC_RATE_SLACK
+  #define JC_RATE_SLACK  1.01f
+#endif
+#ifndef JC_ACCEL_SLACK
+  #define JC_ACCEL_SLACK 1.10f   // short ramps round to whole steps and read a few % high
+#endif
+
+struct JobCheck {
+  uint16_t    flags      = 0;
+  const char* error      = nullptr;   // first problem found
+  uint16_t    segments   = 0;
+  uint32_t    totalSteps = 0;
+  uint32_t    totalMs    = 0;         // exact, settle dwells at their bound
+  float       peakRate[MOTION_AXES]  = {0};   // steps/s
+  float       peakAccel[MOTION_AXES] = {0};   // steps/s^2
+  float       ratePct    = 0.0f;      // worst axis, % of its limit
+  float       accelPct   = 0.0f;
+  uint16_t    leg        = 0;         // timed leg that is too fast (1-based)
+  uint32_t    legMs      = 0;         // asked for
+  uint32_t    legMinMs   = 0;         // the least the rig needs
+
+  bool ok() const { return flags == 0; }
+  void fail(uint16_t f, const char* why) { flags |= f; if (!error) error = why; }
+};
+
+// ---------- analysis ----------
+inline float jcAxisRate(const PlanSegment& s, uint8_t a) {
+  const uint32_t t = planSegTicks(s);
+  return t ? 1e6f / s.usPerStep * (float)abs(s.steps[a]) / t : 0.0f;
+}
+
+// Rate step from segment i to j per axis, over the time between their
+// midpoints. Dwells and reversals start from rest, which the planner
+// allows (planMinRate), so they are not counted.
+inline void jcAccelBetween(const PlanSegment& si, const PlanSegment& sj, JobCheck& c) {
+  const uint32_t ti = planSegTicks(si), tj = planSegTicks(sj);
+  if (!ti || !tj) return;
+  const float dt = 0.5f * ((float)ti * si.usPerStep + (float)tj * sj.usPerStep) / 1e6f;
+  for (uint8_t a = 0; a < MOTION_AXES; ++a) {
+    if (!si.steps[a] || !sj.steps[a] || (si.steps[a] < 0) != (sj.steps[a] < 0)) continue;
+    const float acc = fabsf(jcAxisRate(sj, a) - jcAxisRate(si, a)) / dt;
+    if (acc > c.peakAccel[a]) c.peakAccel[a] = acc;
+  }
+}
+
+// Analyse the compiled `plan` as it stands.
+inline void jobCheckPlan(JobCheck& c) {
+  c.segments   = plan.count;
+  c.totalSteps = plan.totalSteps;
+  c.totalMs    = plan.totalMs;
+  for (uint16_t i = 0; i < plan.count; ++i) {
+    const PlanSegment& s = plan.seg[i];
+    for (uint8_t a = 0; a < MOTION_AXES; ++a) c.peakRate[a] = max(c.peakRate[a], jcAxisRate(s, a));
+    if (i + 1 < plan.count) jcAccelBetween(s, plan.seg[i + 1], c);
+    if (i + 1 == plan.loopEnd && plan.loops > 1 && plan.loopStart < plan.loopEnd)
+      jcAccelBetween(s, plan.seg[plan.loopStart], c);
+  }
+  for (uint8_t a = 0; a < MOTION_AXES; ++a) {
+    const float rate = 100.0f * c.peakRate[a] * g_axes[a].minUsPerStep / 1e6f;
+    const float acc  = 100.0f * c.peakAccel[a] / g_axes[a].accel;
+    c.ratePct  = max(c.ratePct, rate);
+    c.accelPct = max(c.accelPct, acc);
+  }
+  if (c.ratePct  > 100.0f * JC_RATE_SLACK)  c.fail(JC_RATE,  "step rate above axis limit");
+  if (c.accelPct > 100.0f * JC_ACCEL_SLACK) c.fail(JC_ACCEL, "acceleration above axis limit");
+}
+
+// Validate, compile into `plan` (as a dry run does) and analyse, then put
+// back the plan that was loaded, which g_job still describes. The saved
+// copy is scratch in the job arena, given back before returning, so checks
+// can repeat without eating the room jobRun() needs. True when nothing is
+// violated.
+inline bool jobCheck(const JobSpec& j, JobCheck& c) {
+  c = JobCheck();
+  if (motionBusy()) { c.fail(JC_BUSY, "busy"); return false; }
+  const char* err = nullptr;
+  if (!jobValidate(j, err)) { c.fail(JC_INVALID, err); return false; }
+
+  MemArena& arena = jobArena();
+  const uint32_t mark = arenaMark(arena);
+  MotionPlan* loaded = arenaNew<MotionPlan>(arena);
+  if (!loaded) { c.fail(JC_INVALID, "out of memory"); return false; }
+  *loaded = plan;
+  g_planShort = PlanShortfall();
+  const PlanError pe = jobCompile(j);
+  if (pe == PLAN_OK) jobCheckPlan(c);
+  plan = *loaded;
+  arenaRewind(arena, mark);
+
+  switch (pe) {
+    case PLAN_OK: break;
+    case PLAN_ERR_TOO_FAST:
+      c.fail(JC_TOO_FAST, planErrorText(pe));
+      c.leg = g_jobErrorLeg; c.legMs = g_planShort.askedMs; c.legMinMs = g_planShort.minMs;
+      break;
+    case PLAN_ERR_FULL: c.fail(JC_TOO_LONG, planErrorText(pe)); break;
+    default:            c.fail(JC_RANGE, planErrorText(pe)); break;
+  }
+  return c.ok();
+}
+
+// ---------- reporting ----------
+// "1:05:03" / "4:07" / "12.3s"
+inline void jobCheckFmtMs(uint32_t ms, char* out, size_t n) {
+  const uint32_t s = ms / 1000;
+  if (s >= 3600)    snprintf(out, n, "%lu:%02lu:%02lu", (unsigned long)(s / 3600), (unsigned long)(s / 60 % 60), (unsigned long)(s % 60));
+  else if (s >= 60) snprintf(out, n, "%lu:%02lu", (unsigned long)(s / 60), (unsigned long)(s % 60));
+  else              snprintf(out, n, "%.1fs", ms / 1000.0f);
+}
+
+// Two short lines for the display: "ETA 4:07 pk 84%" / "OK to run" or the problem.
+inline void jobCheckLines(const JobCheck& c, char* l1, char* l2, size_t n) {
+  char t[16], m[16];
+  jobCheckFmtMs(c.totalMs, t, sizeof(t));
+  if (c.flags & (JC_INVALID | JC_TOO_FAST | JC_TOO_LONG | JC_RANGE | JC_BUSY)) snprintf(l1, n, "Cannot run");
+  else snprintf(l1, n, "ETA %s pk %d%%", t, (int)(c.ratePct + 0.5f));
+  if (c.flags & JC_TOO_FAST) { jobCheckFmtMs(c.legMinMs, m, sizeof(m)); snprintf(l2, n, "Too fast, min %s", m); }
+  else if (c.ok())           snprintf(l2, n, "OK to run");
+  else                       snprintf(l2, n, "%s", c.error ? c.error : "error");
+}
+
+// {"ok":false,"segments":..,"steps":..,"etaMs":..,"violations":["too-fast"],"error":"..",
+//  "peak":{"rate":[..],"ratePct":..,"accel":[..],"accelPct":..},"leg":{"n":1,"ms":..,"minMs":..}}
+inline void jobCheckJson(const JobCheck& c, HttpResponse& r) {
+  r.type = "application/json";
+  r.add("{\"ok\":").add(c.ok() ? "true" : "false")
+   .add(",\"segments\":").add((long)c.segments)
+   .add(",\"steps\":").add((long)c.totalSteps)
+   .add(",\"etaMs\":").add((long)c.totalMs).add(",\"violations\":[");
+  bool first = true;
+  for (uint8_t b = 0; b < JC_FLAG_COUNT; ++b) {
+    if (!(c.flags & (1u << b))) continue;
+    r.add(first ? "\"" : ",\"").add(jobCheckFlagName(b)).add("\"");
+    first = false;
+  }
+  r.add("],\"error\":\"").add(c.error ? c.error : "").add("\",\"peak\":{\"rate\":[");
+  for (uint8_t a = 0; a < MOTION_AXES; ++a) r.add(a ? "," : "").add(c.peakRate[a], 1);
+  r.add("],\"ratePct\":").add(c.ratePct, 1).add(",\"accel\":[");
+  for (uint8_t a = 0; a < MOTION_AXES; ++a) r.add(a ? "," : "").add(c.peakAccel[a], 0);
+  r.add("],\"accelPct\":").add(c.accelPct, 1).add("}");
+  if (c.leg) r.add(",\"leg\":{\"n\":").add((long)c.leg).add(",\"ms\":").add((long)c.legMs)
+              .add(",\"minMs\":").add((long)c.legMinMs).add("}");
+  r.add("}");
+}
+
+#endif
@@ -0,0 +1,6 @@
+// Splash animation state.
+#include "logo.h"
+
+uint32_t g_splashStart = 0;
+uint32_t g_splashLast  = 0;
+int      g_splashCarX  = -1;
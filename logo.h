@@ -2,28 +2,80 @@
 #define LOGO_H
 
 #include "ui_helpers.h"
+#include "assets.h"
 
-inline void playStartupAnimation() {
+// Startup splash. Non-blocking: splashBegin() draws the static parts once,
+// splashTick() from loop() moves the carriage along the rail, touching only
+// the few pixels that changed. boot.h decides when it ends.
+
+#ifndef SPLASH_FRAME_MS
+  #define SPLASH_FRAME_MS 30
+#endif
+
+extern uint32_t g_splashStart;
+extern uint32_t g_splashLast;
+extern int      g_splashCarX;   // carriage x last drawn, -1 = none
+
+static const int SPLASH_CAR_W = 40;
+static const int SPLASH_CAR_H = 10;
+
+inline int splashRailY() { return tft.height()/2 + 40; }
+
+inline void splashBegin() {
   uiBegin();
-  drawHeader("SlidePilot");
-  int y = tft.height()/2;
-  uint32_t start = millis();
-  while (millis() - start < 1200) {
-    tft.fillRect(0, 26, tft.width(), tft.height()-46, Theme::BG);
-    // Title
-    tft.setTextColor(Theme::TEXT, Theme::BG);
-    tft.setTextFont(4);
-    int16_t cx = 10; int16_t cy = y-12;
-    tft.setCursor(cx, cy); tft.print("SlidePilot");
-    tft.setTextFont(2);
-    tft.setCursor(cx, cy+24); tft.setTextColor(Theme::TEXT_DIM, Theme::BG); tft.print("Camera Slider");
-
-    // Moving slider icon under text
-    drawMovingSliderIcon(cy+42 + 10, Theme::SEP, Theme::PRIMARY, 40, (millis()/30));
-
-    drawFooter("Back", ""); // hint area
-    delay(30);
+  const int cy = tft.height()/2 - 12;
+  const int tx = 10 + ASSET_SPLASH_LOGO.w + 8;   // title to the right of the logo
+  imgDraw(tft, ASSET_SPLASH_LOGO, 10, cy, Theme::BG);
+  tft.setTextColor(Theme::TEXT, Theme::BG);
+  tft.setTextFont(4);
+  tft.setCursor(tx, cy); tft.print("SlidePilot");
+  tft.setTextFont(2);
+  tft.setTextColor(Theme::TEXT_DIM, Theme::BG);
+  tft.setCursor(tx, cy + 24); tft.print("Camera Slider");
+  tft.fillRect(10, splashRailY() + SPLASH_CAR_H/2 - 1, tft.width() - 20, 3, Theme::SEP);
+  tft.setTextColor(Theme::TEXT, Theme::BG);
+
+  g_splashStart = millis();
+  g_splashLast  = g_splashStart - SPLASH_FRAME_MS;
+  g_splashCarX  = -1;
+}
+
+inline uint32_t splashElapsed() { return millis() - g_splashStart; }
+
+// Ping-pong the carriage between the rail ends; redraws only the strips
+// it left and entered.
+inline void splashTick() {
+  const uint32_t now = millis();
+  if (now - g_splashLast < SPLASH_FRAME_MS) return;
+  g_splashLast = now;
+
+  const int x0 = 10, span = tft.width() - 20 - SPLASH_CAR_W;
+  const int t = (int)((now - g_splashStart) / SPLASH_FRAME_MS * 4) % (2*span);
+  const int x = x0 + (t < span ? t : 2*span - t);
+  const int y = splashRailY();
+  if (x == g_splashCarX) return;
+
+  const int old = g_splashCarX;
+  const int gw  = abs(x - old);
+  if (old >= 0 && gw < SPLASH_CAR_W) {
+    const int gx = (x > old) ? old : x + SPLASH_CAR_W;          // strip uncovered
+    tft.fillRect(gx, y, gw, SPLASH_CAR_H, Theme::BG);
+    tft.fillRect(gx, y + SPLASH_CAR_H/2 - 1, gw, 3, Theme::SEP);
+    tft.fillRect((x > old) ? old + SPLASH_CAR_W : x, y, gw, SPLASH_CAR_H, Theme::PRIMARY);
+  } else {
+    if (old >= 0) {                                              // skipped frames: full redraw
+      tft.fillRect(old, y, SPLASH_CAR_W, SPLASH_CAR_H, Theme::BG);
+      tft.fillRect(old, y + SPLASH_CAR_H/2 - 1, SPLASH_CAR_W, 3, Theme::SEP);
+    }
+    tft.fillRect(x, y, SPLASH_CAR_W, SPLASH_CAR_H, Theme::PRIMARY);
   }
+  g_splashCarX = x;
+}
+
+// Blocking version for callers that just want the animation.
+inline void playStartupAnimation(uint32_t ms = 1200) {
+  splashBegin();
+  while (splashElapsed() < ms) { splashTick(); delay(1); }
   tft.setTextFont(2);
 }
 
@@ -0,0 +1,4 @@
+// Manual drive control loop state.
+#include "manual_drive.h"
+
+DriveState g_drive;
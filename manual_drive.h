@@ -0,0 +1,153 @@
+#ifndef MANUAL_DRIVE_H
+#define MANUAL_DRIVE_H
+
+// Velocity-mode manual drive, shared by the knob screen, the web drive pad
+// and the serial link. Callers set a target slide velocity; a 1 kHz
+// esp_timer tick moves the actual velocity towards it with jerk-limited
+// acceleration and hands the step period to the step ISR (velocity mode in
+// step_generator.h). A target lapses after DRIVE_TIMEOUT_MS unless it is
+// refreshed, so a dropped link ramps the slide down rather than leaving it
+// running. Near the travel ends the tick brakes in time to stop inside.
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "config.h"
+#include "motor_control.h"
+#include "step_generator.h"
+#include "resonance_map.h"
+#include "flight_recorder.h"
+
+#ifndef DRIVE_TICK_US
+  #define DRIVE_TICK_US 1000
+#endif
+#ifndef DRIVE_TIMEOUT_MS
+  #define DRIVE_TIMEOUT_MS 300         // target lapses to 0 without a refresh
+#endif
+#ifndef DRIVE_JERK_TIME_S
+  #define DRIVE_JERK_TIME_S 0.05f      // time to build up full acceleration
+#endif
+#ifndef DRIVE_START_RATE
+  #define DRIVE_START_RATE 250.0f      // steps/s a stepper starts/stops at without a ramp
+#endif
+
+struct DriveState {
+  volatile float    target = 0.0f;     // steps/s, + = forward
+  volatile uint32_t deadlineMs = 0;    // target lapses after this
+  float   v = 0.0f;                    // steps/s
+  float   a = 0.0f;                    // steps/s^2
+  bool    active = false;
+  bool    stopping = false;            // tick has released velocity mode; loop tears down
+  esp_timer_handle_t timer = nullptr;
+};
+extern DriveState g_drive;
+
+inline float driveMaxRate() { return 1e6f / max<uint32_t>(1, g_axes[AXIS_SLIDE].minUsPerStep); }
+inline bool  driveActive()  { return g_drive.active; }
+inline float driveRate()    { return g_drive.v; }
+
+// One control step; runs in the esp_timer task.
+inline void driveTick(void*) {
+  if (!g_drive.active || g_drive.stopping) return;
+  const float dt = DRIVE_TICK_US * 1e-6f;
+  const float A  = max(1.0f, g_axes[AXIS_SLIDE].accel);
+  const float J  = A / DRIVE_JERK_TIME_S;
+  float v = g_drive.v, a = g_drive.a;
+
+  float target = g_drive.target;
+  const bool lapsed = (int32_t)(millis() - g_drive.deadlineMs) > 0;
+  if (lapsed) target = 0.0f;
+
+  // Brake for the travel ends: stopping distance plus the jerk ramp.
+  const float stopDist = v * v / (2.0f * A) + fabsf(v) * DRIVE_JERK_TIME_S;
+  const int32_t pos = g_axisPos[AXIS_SLIDE];
+  if (target > 0.0f && pos + stopDist >= g_velMaxPos) target = 0.0f;
+  if (target < 0.0f && pos - stopDist <= g_velMinPos) target = 0.0f;
+
+  const float dv = target - v;
+  if (fabsf(v) <= DRIVE_START_RATE && fabsf(target) <= DRIVE_START_RATE) {
+    v = target; a = 0.0f;                       // within start/stop rate: jump
+  } else if (fabsf(v) < DRIVE_START_RATE && v * target >= 0.0f) {
+    v = target > 0.0f ? DRIVE_START_RATE : -DRIVE_START_RATE;   // start from rest at once
+    a = 0.0f;
+  } else if (dv != 0.0f) {
+    // Aim for the acceleration that can still be ramped off by the time v
+    // reaches the target, and approach it at no more than J.
+    const float aDes = copysignf(min(A, sqrtf(2.0f * J * fabsf(dv))), dv);
+    const float da = J * dt;
+    a = (aDes > a) ? min(aDes, a + da) : max(aDes, a - da);
+    v += a * dt;
+    if ((dv > 0.0f && v >= target) || (dv < 0.0f && v <= target)) { v = target; a = 0.0f; }
+  } else {
+    a = 0.0f;
+  }
+  g_drive.v = v; g_drive.a = a;
+
+  const float r = fabsf(v);
+  if (r < 1.0f) stepGenVelocitySet(0, 0);
+  else          stepGenVelocitySet((uint32_t)(1e6f / r), v > 0.0f ? 1 : -1);
+
+  if (v == 0.0f && lapsed) {                    // idle and nobody driving: hand the timer back
+    stepGenVelocityEnd();
+    g_drive.stopping = true;
+  }
+}
+
+inline void driveRelease() {
+  if (g_drive.timer) esp_timer_stop(g_drive.timer);
+  stepGenVelocityEnd();
+  g_drive.active = false;
+  g_drive.stopping = false;
+  g_drive.v = g_drive.a = 0.0f;
+  frec(FR_DRIVE, 0, 0, g_axisPos[AXIS_SLIDE]);
+}
+
+// Target velocity in steps/s (signed). Keeps the drive alive for
+// DRIVE_TIMEOUT_MS; false while a plan owns the motors.
+inline bool driveSetRate(float rate) {
+  const float maxRate = driveMaxRate();
+  rate = clampT(rate, -maxRate, maxRate);
+  if (rate != 0.0f) rate = copysignf(resonanceAvoidRate(fabsf(rate), maxRate), rate);
+  if (g_drive.active && g_drive.stopping) driveRelease();
+
+  if (!g_drive.active) {
+    if (rate == 0.0f) return true;
+    if (!stepGenVelocityBegin()) return false;
+    if (!g_drive.timer) {
+      esp_timer_create_args_t args = {};
+      args.callback = &driveTick;
+      args.name = "drive";
+      if (esp_timer_create(&args, &g_drive.timer) != ESP_OK) { stepGenVelocityEnd(); return false; }
+    }
+    g_drive.v = g_drive.a = 0.0f;
+    g_drive.active = true;
+    frec(FR_DRIVE, 1, 0, g_axisPos[AXIS_SLIDE]);
+    g_drive.target = rate;
+    g_drive.deadlineMs = millis() + DRIVE_TIMEOUT_MS;
+    driveTick(nullptr);                        // first period now, not a tick later
+    esp_timer_start_periodic(g_drive.timer, DRIVE_TICK_US);
+    return true;
+  }
+  g_drive.target = rate;
+  g_drive.deadlineMs = millis() + DRIVE_TIMEOUT_MS;
+  return true;
+}
+
+// Ramp down and release (not an emergency stop).
+inline void driveStop() {
+  g_drive.target = 0.0f;
+  g_drive.deadlineMs = millis();
+}
+
+// Call from loop(): finishes a release the tick started.
+inline void driveLoop() {
+  if (g_drive.active && g_drive.stopping) driveRelease();
+}
+
+// Web drive pad: dir ±1 at a percentage speed, dir 0 stops.
+inline bool manualDrive(int dir, uint8_t pct) {
+  if (dir == 0) { driveStop(); return true; }
+  const float rate = 1e6f / usPerStepForPercent(pct);
+  return driveSetRate(dir > 0 ? rate : -rate);
+}
+
+#endif
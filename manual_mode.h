@@ -4,18 +4,53 @@
 #include "wizard_ui.h"
 #include "ui_helpers.h"
 #include "rotary_input.h"
+#include "control.h"
 
+#ifndef MANUAL_PCT_PER_DETENT
+  #define MANUAL_PCT_PER_DETENT 5
+#endif
+
+// Knob jog in velocity mode (manual_drive.h): each detent changes the
+// target speed, turning through zero reverses. OK stops, Back ramps down
+// and leaves. The loop refreshes the drive, so if it stalls the slide
+// ramps down on its own.
 inline void openManualMode() {
-  while (true) {
-    wizardFrameStart("OK");
-    wizardCenterTwo("Manual Mode", "Use knobs/buttons (stub)");
+  const int maxLevel = 100 / MANUAL_PCT_PER_DETENT;
+  int level = 0, shownLevel = -1000;
+  int32_t shownPos = INT32_MIN;
+  bool busy = false, shownBusy = false;
+  uint32_t lastDraw = 0;
 
+  wizardFrameStart("Stop");
+  while (true) {
     updateRotary();
-    if (isSelectPressed()) return;
-    if (isBackPressed()) return;
+    const int d = getEncoderDelta();
+    if (d) level = clampT(level + d, -maxLevel, maxLevel);
+    if (isSelectPressed()) level = 0;
+    if (isBackPressed() || isBackPressedLong()) break;
+
+    const int pct = abs(level) * MANUAL_PCT_PER_DETENT;
+    busy = ctlDrive(level > 0 ? 1 : (level < 0 ? -1 : 0), pct) == CTL_BUSY;
+    driveLoop();
+
+    const int32_t pos = stepPosition();
+    if (level != shownLevel || busy != shownBusy || (pos != shownPos && millis() - lastDraw >= 100)) {
+      char l1[24], l2[24];
+      if (busy)           snprintf(l1, sizeof(l1), "  Job running   ");
+      else if (level > 0) snprintf(l1, sizeof(l1), "    >> %3d%%    ", pct);
+      else if (level < 0) snprintf(l1, sizeof(l1), "    << %3d%%    ", pct);
+      else                snprintf(l1, sizeof(l1), "    Stopped     ");
+      snprintf(l2, sizeof(l2), "  %8.1f mm  ", stepPositionMM());
+      wizardCenterTwo(l1, l2);
+      shownLevel = level; shownBusy = busy; shownPos = pos; lastDraw = millis();
+    }
     idleDimmerTick();
     delay(10);
   }
+
+  driveStop();
+  wizardCenterTwo("    Stopping    ", "                ");
+  while (driveActive()) { driveLoop(); delay(5); }
 }
 
 #endif
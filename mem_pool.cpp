@@ -0,0 +1,4 @@
+// Head of the memory report list.
+#include "mem_pool.h"
+
+MemStats* g_memList = nullptr;
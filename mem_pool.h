@@ -0,0 +1,180 @@
+#ifndef MEM_POOL_H
+#define MEM_POOL_H
+
+// Deliberate memory: nothing that lives for a job or longer comes from the
+// general heap at random times, so a day-long shoot cannot fragment it and
+// OTA (which mallocs its flash buffer) always finds room.
+//
+//   MemArena   bump allocator, one block taken once (PSRAM when fitted),
+//              reset wholesale when its owner starts over (the job arena
+//              in job.h is reset per job); mark/rewind for scratch
+//   BlockPool  N fixed blocks of one type for short-lived objects, no
+//              heap at all; safe from the esp_timer task and loop()
+//   memReserve one-off buffers that live until reboot (take buffer)
+//   MemStatic  records a static buffer so it shows up in the report
+//
+// Every region registers a MemStats record with its capacity, current use,
+// high-water mark and failed requests; GET /api/mem reports them together
+// with the heap's free, minimum-ever and largest free block.
+
+#include <Arduino.h>
+#include <new>
+#include <esp_heap_caps.h>
+#include "http_router.h"
+
+#ifndef MEM_OTA_RESERVE
+  #define MEM_OTA_RESERVE (16 * 1024)   // largest free block OTA needs
+#endif
+
+enum MemKind : uint8_t { MEM_STATIC = 0, MEM_RESERVE, MEM_ARENA, MEM_POOL };
+
+struct MemStats {
+  const char* name  = "";
+  MemKind     kind  = MEM_STATIC;
+  bool        psram = false;
+  uint32_t    cap   = 0;      // bytes
+  uint32_t    used  = 0;
+  uint32_t    high  = 0;      // most ever used
+  uint32_t    fails = 0;      // requests that did not fit
+  MemStats*   next  = nullptr;
+
+  void take(uint32_t n) { used += n; if (used > high) high = used; }
+};
+extern MemStats* g_memList;
+
+inline void memRegister(MemStats& s, const char* name, MemKind kind, uint32_t cap) {
+  if (!s.name[0]) { s.next = g_memList; g_memList = &s; }
+  s.name = name; s.kind = kind; s.cap = cap;
+}
+
+// A static buffer, listed for the report; define it next to the buffer in
+// the module's .cpp: MemStatic g_planMem("plan", sizeof(plan));
+struct MemStatic {
+  MemStats st;
+  MemStatic(const char* name, uint32_t bytes) { memRegister(st, name, MEM_STATIC, bytes); st.take(bytes); }
+};
+
+// One block from the heap, PSRAM first when psramBytes > 0; sets s.cap.
+inline void* memBlock(MemStats& s, const char* name, MemKind kind, size_t psramBytes, size_t ramBytes) {
+  void* p = nullptr;
+  if (psramBytes && psramFound()) { p = ps_malloc(psramBytes); if (p) { s.psram = true; ramBytes = psramBytes; } }
+  if (!p) p = malloc(ramBytes);
+  memRegister(s, name, kind, p ? (uint32_t)ramBytes : 0);
+  if (!p) s.fails++;
+  return p;
+}
+
+// A buffer kept until reboot; take it early, before the heap is churned.
+inline void* memReserve(MemStats& s, const char* name, size_t psramBytes, size_t ramBytes) {
+  void* p = memBlock(s, name, MEM_RESERVE, psramBytes, ramBytes);
+  if (p) s.take(s.cap);
+  return p;
+}
+
+// ---------- arena ----------
+struct MemArena {
+  MemStats st;
+  uint8_t* base  = nullptr;
+  uint32_t epoch = 0;       // bumped by every reset; lets users cache a block
+};
+
+inline bool arenaBegin(MemArena& a, const char* name, size_t psramBytes, size_t ramBytes) {
+  if (!a.base) a.base = (uint8_t*)memBlock(a.st, name, MEM_ARENA, psramBytes, ramBytes);
+  return a.base != nullptr;
+}
+
+inline void* arenaAlloc(MemArena& a, size_t n, size_t align = 4) {
+  const uint32_t at = (a.st.used + (uint32_t)align - 1) & ~((uint32_t)align - 1);
+  if (!a.base || at + n > a.st.cap) { a.st.fails++; return nullptr; }
+  a.st.take(at + (uint32_t)n - a.st.used);
+  return a.base + at;
+}
+
+inline void arenaReset(MemArena& a) { a.st.used = 0; a.epoch++; }
+
+// Scratch use: give back everything taken since arenaMark(). Nothing taken
+// in between may outlive the rewind (or be cached against the epoch).
+inline uint32_t arenaMark(const MemArena& a) { return a.st.used; }
+inline void     arenaRewind(MemArena& a, uint32_t mark) { if (mark < a.st.used) a.st.used = mark; }
+
+template <typename T>
+inline T* arenaNew(MemArena& a) {
+  void* p = arenaAlloc(a, sizeof(T), alignof(T));
+  return p ? new (p) T() : nullptr;
+}
+
+// ---------- fixed-block pool ----------
+template <typename T, uint8_t N>
+struct BlockPool {
+  typedef T Type;
+  union Slot { Slot* next; alignas(T) uint8_t raw[sizeof(T)]; };
+  MemStats     st;
+  Slot         slots[N];
+  Slot*        head = nullptr;
+  bool         ready = false;
+  portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+
+  explicit BlockPool(const char* name) { memRegister(st, name, MEM_POOL, sizeof(slots)); }
+
+  T* alloc() {
+    Slot* s;
+    portENTER_CRITICAL(&mux);
+    if (!ready) {
+      for (uint8_t i = 0; i < N; ++i) slots[i].next = i + 1 < N ? &slots[i + 1] : nullptr;
+      head = &slots[0]; ready = true;
+    }
+    s = head;
+    if (s) { head = s->next; st.take(sizeof(Slot)); }
+    else   st.fails++;
+    portEXIT_CRITICAL(&mux);
+    return s ? new (s->raw) T() : nullptr;
+  }
+  void release(T* p) {
+    if (!p) return;
+    p->~T();
+    Slot* s = (Slot*)(void*)p;
+    portENTER_CRITICAL(&mux);
+    s->next = head; head = s; st.used -= sizeof(Slot);
+    portEXIT_CRITICAL(&mux);
+  }
+};
+
+// Scoped block: released when it goes out of scope.
+template <typename P>
+struct PoolLease {
+  P& pool;
+  typename P::Type* p;
+  explicit PoolLease(P& pl) : pool(pl), p(pl.alloc()) {}
+  ~PoolLease() { pool.release(p); }
+  PoolLease(const PoolLease&) = delete;
+  PoolLease& operator=(const PoolLease&) = delete;
+  explicit operator bool() const { return p != nullptr; }
+  typename P::Type& operator*()  const { return *p; }
+  typename P::Type* operator->() const { return p; }
+};
+
+// ---------- report ----------
+inline uint32_t memLargestFree() { return (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT); }
+inline bool     memOtaRoom()     { return memLargestFree() >= MEM_OTA_RESERVE; }
+
+// GET /api/mem → {"heap":{"free":..,"min":..,"largest":..,"psram":..,"ota":true},
+//                 "regions":[{"name":"job","kind":"arena","cap":..,"used":..,"high":..,"fails":0,"psram":true},..]}
+inline void memStatusJson(HttpResponse& r) {
+  static const char* const kinds[] = { "static", "reserve", "arena", "pool" };
+  r.type = "application/json";
+  r.add("{\"heap\":{\"free\":").add((long)ESP.getFreeHeap())
+   .add(",\"min\":").add((long)ESP.getMinFreeHeap())
+   .add(",\"largest\":").add((long)memLargestFree())
+   .add(",\"psram\":").add((long)(psramFound() ? ESP.getFreePsram() : 0))
+   .add(",\"ota\":").add(memOtaRoom() ? "true" : "false").add("},\"regions\":[");
+  for (const MemStats* s = g_memList; s; s = s->next) {
+    r.add(s == g_memList ? "{\"name\":\"" : ",{\"name\":\"").add(s->name)
+     .add("\",\"kind\":\"").add(kinds[s->kind])
+     .add("\",\"cap\":").add((long)s->cap).add(",\"used\":").add((long)s->used)
+     .add(",\"high\":").add((long)s->high).add(",\"fails\":").add((long)s->fails)
+     .add(",\"psram\":").add(s->psram ? "true" : "false").add("}");
+  }
+  r.add("]}");
+}
+
+#endif
@@ -0,0 +1,8 @@
+// Main menu and Settings selection, and the Settings screen's loop.
+#include "menu.h"
+#include "settings_menu.h"
+
+MenuView g_mainMenu;
+MenuView g_settingsMenu;
+
+void openSettingsMenu() { runMenu(g_settingsMenu, SETTINGS_MENU); }
@@ -0,0 +1,216 @@
+#ifndef MENU_TREE_H
+#define MENU_TREE_H
+
+// Menus as data. A MenuNode is a titled list of entries; an entry runs an
+// action, opens a child node or edits a value with the knob. Trees are
+// built constexpr from menuAction()/menuChild()/menuValue(), so a new
+// screen is a table, not another copy of the list loop.
+//
+// One renderer shows any node as the 3-row pill list with the slim
+// scrollbar. A MenuView remembers what each row shows (entry, selection,
+// edit state, value), so after a detent only rows whose content changed
+// are redrawn and the scrollbar thumb is moved; the screen is cleared only
+// when a node is opened or something it launched returns.
+
+#include <Arduino.h>
+#include "ui_helpers.h"
+#include "rotary_input.h"
+
+enum MenuKind : uint8_t { MK_ACTION, MK_CHILD, MK_VALUE };
+
+// A setting edited in place: the knob moves a pending value between lo and
+// hi, OK hands it to set(), Back drops it. set() may refuse (range, busy),
+// then the row falls back to get(). names, if given, label lo..hi.
+struct MenuValue {
+  int32_t          (*get)();
+  bool             (*set)(int32_t v);
+  int32_t            lo, hi, step;
+  const char*        unit;
+  const char* const* names;
+};
+
+struct MenuNode;
+struct MenuEntry {
+  const char*      label;
+  MenuKind         kind;
+  void           (*action)();
+  const MenuNode*  child;
+  const MenuValue* value;
+};
+
+struct MenuNode {
+  const char*      title;              // dim caption top left, nullptr = none
+  const MenuEntry* entries;
+  uint8_t          count;
+};
+
+constexpr MenuEntry menuAction(const char* label, void (*fn)()) {
+  return MenuEntry{ label, MK_ACTION, fn, nullptr, nullptr };
+}
+constexpr MenuEntry menuChild(const char* label, const MenuNode& node) {
+  return MenuEntry{ label, MK_CHILD, nullptr, &node, nullptr };
+}
+constexpr MenuEntry menuValue(const char* label, const MenuValue& value) {
+  return MenuEntry{ label, MK_VALUE, nullptr, nullptr, &value };
+}
+template<size_t N>
+constexpr MenuNode menuNode(const char* title, const MenuEntry (&entries)[N]) {
+  return MenuNode{ title, entries, (uint8_t)N };
+}
+
+// ---------- view ----------
+enum MenuLook : uint8_t { ML_PLAIN, ML_SELECTED, ML_EDITING };
+
+struct MenuRow {
+  int16_t idx  = -1;                   // entry shown, -1 = empty row
+  uint8_t look = ML_PLAIN;
+  int32_t val  = 0;                    // value rows only
+  bool operator==(const MenuRow& o) const { return idx == o.idx && look == o.look && val == o.val; }
+};
+
+struct MenuView {
+  const MenuNode* node    = nullptr;
+  int             sel     = 0;
+  int             first   = 0;         // first row in the window
+  bool            editing = false;
+  int32_t         pending = 0;         // value being edited
+  MenuRow         shown[LIST_ROWS];    // what is on the panel now
+  int             shownFirst = 0;      // where the thumb is drawn
+};
+
+inline void menuFormatValue(const MenuValue& mv, int32_t v, char* out, size_t n) {
+  if (mv.names) snprintf(out, n, "%s", mv.names[clampT(v, mv.lo, mv.hi) - mv.lo]);
+  else          snprintf(out, n, "%ld%s%s", (long)v, mv.unit ? " " : "", mv.unit ? mv.unit : "");
+}
+
+inline MenuRow menuRowWanted(const MenuView& v, int row) {
+  MenuRow r;
+  const int idx = v.first + row;
+  if (idx >= v.node->count) return r;
+  const MenuEntry& e = v.node->entries[idx];
+  r.idx  = (int16_t)idx;
+  r.look = idx != v.sel ? ML_PLAIN : v.editing ? ML_EDITING : ML_SELECTED;
+  if (e.kind == MK_VALUE) r.val = (r.look == ML_EDITING) ? v.pending : e.value->get();
+  return r;
+}
+
+inline void menuDrawRow(MenuView& v, int row, const MenuRow& r) {
+  const int yTop = listRowTop(row);
+  v.shown[row] = r;
+  if (r.idx < 0) {
+    tft.fillRect(UI::PAD, yTop, tft.width() - UI::RIGHT_COL_W - 2*UI::PAD, UI::ITEM_H, Theme::BG);
+    return;
+  }
+  const MenuEntry& e = v.node->entries[r.idx];
+  if (e.kind != MK_VALUE) { drawListItemRailAware(yTop, e.label, r.look != ML_PLAIN); return; }
+  char text[16];
+  menuFormatValue(*e.value, r.val, text, sizeof(text));
+  drawPillLabelValue(yTop, e.label, text, r.look != ML_PLAIN, r.look == ML_EDITING);
+}
+
+// Whole screen: after opening a node or coming back from a screen
+inline void menuDraw(MenuView& v) {
+  if (!v.node) return;
+  uiBegin();
+  if (v.node->title) {
+    tft.setTextDatum(TL_DATUM);
+    fontLabel();
+    tft.setTextColor(Theme::TEXT_DIM, Theme::BG);
+    tft.setCursor(UI::PAD, 6);
+    tft.print(v.node->title);
+  }
+  drawRightTabTop("Back");
+  drawRightTabBottom(v.editing ? "Save" : "Select");
+  for (int i = 0; i < LIST_ROWS; ++i) {
+    const MenuRow r = menuRowWanted(v, i);
+    if (r.idx >= 0) menuDrawRow(v, i, r);
+    else            v.shown[i] = r;
+  }
+  drawSlimScroll(v.node->count, v.first, LIST_ROWS);
+  v.shownFirst = v.first;
+}
+
+// Only what changed since the last draw
+inline void menuRefresh(MenuView& v) {
+  for (int i = 0; i < LIST_ROWS; ++i) {
+    const MenuRow r = menuRowWanted(v, i);
+    if (!(r == v.shown[i])) menuDrawRow(v, i, r);
+  }
+  moveSlimThumb(v.node->count, v.shownFirst, v.first, LIST_ROWS);
+  v.shownFirst = v.first;
+}
+
+// Show node; the selection is kept when the view already shows it
+inline void menuOpen(MenuView& v, const MenuNode& node) {
+  if (v.node != &node) { v.node = &node; v.sel = 0; }
+  v.sel     = clampT(v.sel, 0, max(0, node.count - 1));
+  v.first   = clampT(v.sel - 1, 0, max(0, node.count - LIST_ROWS));
+  v.editing = false;
+  menuDraw(v);
+}
+
+// A knob move: the selection (window keeps it centred when it can) or the
+// value being edited
+inline void menuMove(MenuView& v, int delta) {
+  if (!v.node || !delta) return;
+  if (v.editing) {
+    const MenuValue& mv = *v.node->entries[v.sel].value;
+    v.pending = clampT(v.pending + delta * mv.step, mv.lo, mv.hi);
+  } else {
+    v.sel   = clampT(v.sel + delta, 0, v.node->count - 1);
+    v.first = clampT(v.sel - 1, 0, max(0, v.node->count - LIST_ROWS));
+  }
+  menuRefresh(v);
+}
+
+inline void menuSetEditing(MenuView& v, bool on) {
+  v.editing = on;
+  drawRightTabBottom(on ? "Save" : "Select");
+  menuRefresh(v);
+}
+
+// Back: leaves an edit (true = handled); false means leave the node
+inline bool menuBack(MenuView& v) {
+  if (!v.editing) return false;
+  menuSetEditing(v, false);
+  return true;
+}
+
+inline void runMenu(MenuView& v, const MenuNode& node);
+
+// OK on the selected entry
+inline void menuSelect(MenuView& v) {
+  if (!v.node) return;
+  const MenuEntry& e = v.node->entries[v.sel];
+  switch (e.kind) {
+    case MK_ACTION:
+      if (e.action) { e.action(); menuDraw(v); }
+      break;
+    case MK_CHILD: {
+      MenuView sub;
+      runMenu(sub, *e.child);
+      menuDraw(v);
+      break;
+    }
+    case MK_VALUE:
+      if (v.editing) e.value->set(v.pending);
+      else           v.pending = e.value->get();
+      menuSetEditing(v, !v.editing);
+      break;
+  }
+}
+
+// Modal loop for a node and its children; returns on Back
+inline void runMenu(MenuView& v, const MenuNode& node) {
+  menuOpen(v, node);
+  while (true) {
+    updateRotary();
+    menuMove(v, getEncoderDelta());
+    if ((isBackPressed() || isBackPressedLong()) && !menuBack(v)) return;
+    if (isSelectPressed()) menuSelect(v);
+    idleDimmerTick();
+    delay(4);
+  }
+}
+
+#endif
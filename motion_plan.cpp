@@ -0,0 +1,6 @@
+// The compiled plan; the step ISR walks it.
+#include "motion_plan.h"
+
+MotionPlan plan;
+MemStatic  g_planMem("plan", sizeof(plan));   // the ISR reads it: internal RAM, never the heap
+PlanShortfall g_planShort;
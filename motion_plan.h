@@ -0,0 +1,324 @@
+#ifndef MOTION_PLAN_H
+#define MOTION_PLAN_H
+
+// Compiled motion plan: a flat list of constant-rate step segments and dwells
+// that the step generator walks on its own (see step_generator.h). Anything
+// that wants the carriage to move — jobs, jogs, replays — compiles into this.
+
+#include <Arduino.h>
+#include <math.h>
+#include "config.h"
+#include "motor_control.h"
+#include "eeprom_utils.h"
+#include "rig_scale.h"
+#include "mem_pool.h"
+
+#ifndef PLAN_MAX_SEGMENTS
+  #define PLAN_MAX_SEGMENTS 128
+#endif
+#ifndef PLAN_RAMP_CHUNKS
+  #define PLAN_RAMP_CHUNKS  4      // constant-rate chunks per accel/decel ramp
+#endif
+#ifndef PLAN_DWELL_MAX_MS
+  #define PLAN_DWELL_MAX_MS 3600000UL  // longest single dwell segment: 1 h, its µs fit 32 bits
+#endif
+#define PLAN_ACCEL_AXES 1e12f      // no extra cap: each axis's own accel applies
+// One segment = a run of `ticks` timer periods `usPerStep` apart, during which
+// each axis makes |steps[a]| pulses (sign = direction), Bresenham-spread over
+// the shared ticks. The axis with the most steps pulses every tick, so no
+// axis is slowed down by the others. steps all zero = dwell of `dwellMs`.
+// A settle dwell may end early once the encoder reports the rig is still
+// (settle.h); dwellMs is then only the upper bound.
+#define PLAN_SEG_SETTLE 0x01
+
+struct PlanSegment {
+  int32_t  steps[MOTION_AXES] = {0};
+  uint32_t usPerStep = 0;
+  uint32_t dwellMs   = 0;
+  uint8_t  flags     = 0;
+};
+
+inline uint32_t planSegTicks(const PlanSegment& s) {
+  uint32_t t = 0;
+  for (uint8_t a = 0; a < MOTION_AXES; ++a) {
+    uint32_t n = (uint32_t)(s.steps[a] < 0 ? -s.steps[a] : s.steps[a]);
+    if (n > t) t = n;
+  }
+  return t;
+}
+
+struct MotionPlan {
+  volatile bool     active      = false;
+  PlanSegment       seg[PLAN_MAX_SEGMENTS];
+  uint16_t          count       = 0;
+  uint16_t          loopStart   = 0;     // body = seg[loopStart..loopEnd)
+  uint16_t          loopEnd     = 0;     // segments from here on run once, after the last loop
+  uint16_t          loops       = 1;     // times the body runs
+  uint16_t          entry       = 0;     // first segment after initial positioning
+  int32_t           entrySteps[MOTION_AXES] = {0};  // absolute position seg[entry] starts from
+  volatile uint16_t cur         = 0;     // segment being executed
+  volatile uint16_t loopsDone   = 0;
+  volatile uint32_t segLeft     = 0;     // ticks left in seg[cur]
+  volatile uint32_t stepsDone   = 0;     // ticks executed
+  uint32_t          totalSteps  = 0;
+  uint32_t          totalMs     = 0;
+  uint32_t          startedMs   = 0;
+};
+extern MotionPlan plan;
+
+enum PlanError : uint8_t {
+  PLAN_OK = 0,
+  PLAN_ERR_FULL,        // out of segments
+  PLAN_ERR_TOO_FAST,    // duration shorter than the rig can do
+  PLAN_ERR_RANGE,       // outside slider travel
+};
+
+// Why the last timed move was refused: what was asked against the shortest
+// time the rig can do it in (job_check.h reports it).
+struct PlanShortfall {
+  uint32_t steps   = 0;   // ticks of the move
+  uint32_t askedMs = 0;
+  uint32_t minMs   = 0;
+};
+extern PlanShortfall g_planShort;
+
+inline const char* planErrorText(PlanError e) {
+  switch (e) {
+    case PLAN_OK:          return "ok";
+    case PLAN_ERR_FULL:    return "plan too long";
+    case PLAN_ERR_TOO_FAST:return "move too fast for rig";
+    case PLAN_ERR_RANGE:   return "outside travel";
+    default:               return "error";
+  }
+}
+
+// ---------- rig scale ----------
+inline float stepsPerMM() { return rigScale().stepsPerMM; }
+inline float axisStepsPerUnit(uint8_t a) {
+  return a == AXIS_SLIDE ? stepsPerMM() : g_axes[a].stepsPerUnit;
+}
+inline float planMaxRate() { return 1e6f / g_axes[AXIS_SLIDE].minUsPerStep; }  // slide 100 %, steps/s
+inline float planMinRate() { return 1e6f / MOTOR_MAX_US_PER_STEP; }  // start/stop rate
+
+// Tick-rate and tick-accel limits for a move of d[] steps: each axis runs at
+// n_a/ticks of the tick rate, so the slowest-capable axis sets the ceiling.
+inline void planMoveLimits(const int32_t d[MOTION_AXES], float& vmax, float& accel) {
+  uint32_t ticks = 0;
+  for (uint8_t a = 0; a < MOTION_AXES; ++a) ticks = max<uint32_t>(ticks, (uint32_t)abs(d[a]));
+  vmax = 1e6f / MOTOR_FLOOR_US_PER_STEP; accel = 1e12f;
+  for (uint8_t a = 0; a < MOTION_AXES; ++a) {
+    uint32_t n = (uint32_t)abs(d[a]);
+    if (!n) continue;
+    float share = (float)ticks / n;
+    vmax  = min(vmax,  share * 1e6f / g_axes[a].minUsPerStep);
+    accel = min(accel, share * g_axes[a].accel);
+  }
+}
+
+// ---------- building ----------
+inline void planReset() {
+  plan.active = false;
+  plan.count = 0; plan.loopStart = 0; plan.loopEnd = 0; plan.loops = 1;
+  plan.entry = 0;
+  for (uint8_t a = 0; a < MOTION_AXES; ++a) plan.entrySteps[a] = 0;
+  plan.cur = 0; plan.loopsDone = 0; plan.segLeft = 0;
+  plan.stepsDone = 0; plan.totalSteps = 0; plan.totalMs = 0;
+}
+
+inline bool planPush(const int32_t steps[MOTION_AXES], uint32_t usPerStep, uint32_t dwellMs,
+                     uint8_t flags = 0) {
+  if (plan.count >= PLAN_MAX_SEGMENTS) return false;
+  PlanSegment& s = plan.seg[plan.count++];
+  for (uint8_t a = 0; a < MOTION_AXES; ++a) s.steps[a] = steps ? steps[a] : 0;
+  s.usPerStep = usPerStep; s.dwellMs = dwellMs; s.flags = flags;
+  return true;
+}
+
+// Dwells longer than PLAN_DWELL_MAX_MS become several segments.
+inline PlanError planAddDwell(uint32_t ms) {
+  while (ms > 0) {
+    const uint32_t part = min<uint32_t>(ms, PLAN_DWELL_MAX_MS);
+    if (!planPush(nullptr, 0, part)) return PLAN_ERR_FULL;
+    ms -= part;
+  }
+  return PLAN_OK;
+}
+// Wait for the carriage to settle, at most `maxMs` (capped at PLAN_DWELL_MAX_MS).
+inline PlanError planAddSettle(uint32_t maxMs) {
+  if (maxMs == 0) return PLAN_OK;
+  maxMs = min<uint32_t>(maxMs, PLAN_DWELL_MAX_MS);
+  return planPush(nullptr, 0, maxMs, PLAN_SEG_SETTLE) ? PLAN_OK : PLAN_ERR_FULL;
+}
+
+// Time (s) for a symmetric trapezoid over `steps` with cruise rate v.
+inline float planTrapTime(float steps, float v, float a, float v0) {
+  if (v <= v0) return steps / v0;
+  float ramp = (v*v - v0*v0) / (2*a);
+  if (2*ramp > steps) {                       // triangle: peak below v
+    float vp = sqrtf(v0*v0 + a*steps);
+    return 2*(vp - v0)/a;
+  }
+  return 2*(v - v0)/a + (steps - 2*ramp)/v;
+}
+
+// Cruise rate that covers `steps` in `seconds`; <0 if the rig can't.
+inline float planRateForDuration(float steps, float seconds, float a, float v0, float vmax) {
+  if (seconds <= 0) return -1;
+  if (steps / seconds <= v0) return steps / seconds;     // slow: no ramp needed
+  if (planTrapTime(steps, vmax, a, v0) > seconds) return -1;
+  float lo = v0, hi = vmax;
+  for (int i = 0; i < 32; ++i) {
+    float mid = 0.5f*(lo + hi);
+    if (planTrapTime(steps, mid, a, v0) > seconds) lo = mid; else hi = mid;
+  }
+  return hi;
+}
+
+// Coordinated relative move of d[] steps on a shared timeline, cruising at
+// `rate` ticks/s (clamped to what every axis can follow), with accel/decel
+// ramps split into PLAN_RAMP_CHUNKS constant-rate pieces. Each axis gets its
+// share of every chunk, so all axes start, ramp and stop together.
+inline PlanError planAddMoveAxes(const int32_t d[MOTION_AXES], float rate, float accel = PLAN_ACCEL_AXES) {
+  uint32_t n = 0;
+  for (uint8_t a = 0; a < MOTION_AXES; ++a) n = max<uint32_t>(n, (uint32_t)abs(d[a]));
+  if (n == 0) return PLAN_OK;
+
+  float vmax, amax;
+  planMoveLimits(d, vmax, amax);
+  accel = min(accel, amax);
+  const float v0 = min(planMinRate(), vmax);
+  rate = clampT(rate, 1.0f, vmax);
+
+  // resonance bands are measured on the slide: convert tick rate to slide rate
+  const float slideShare = (float)abs(d[AXIS_SLIDE]) / n;
+  auto avoid = [&](float r) {
+    if (slideShare <= 0.0f) return r;
+    return resonanceAvoidRate(r * slideShare, vmax * slideShare) / slideShare;
+  };
+  rate = avoid(rate);
+
+  uint32_t chunkTicks[2*PLAN_RAMP_CHUNKS + 1];
+  uint32_t chunkUs[2*PLAN_RAMP_CHUNKS + 1];
+  int chunks = 0;
+
+  if (rate <= v0) {
+    chunkTicks[chunks] = n; chunkUs[chunks++] = (uint32_t)(1e6f / rate);
+  } else {
+    // triangle if the ramps don't fit
+    float ramp = (rate*rate - v0*v0) / (2*accel);
+    if (2*ramp > n) rate = sqrtf(v0*v0 + accel*n);
+
+    uint32_t rs[PLAN_RAMP_CHUNKS], ru[PLAN_RAMP_CHUNKS], rampTotal = 0;
+    for (int k = 0; k < PLAN_RAMP_CHUNKS; ++k) {
+      float va = v0 + (rate - v0) * k / PLAN_RAMP_CHUNKS;
+      float vb = v0 + (rate - v0) * (k + 1) / PLAN_RAMP_CHUNKS;
+      rs[k] = (uint32_t)((vb*vb - va*va) / (2*accel) + 0.5f);
+      ru[k] = (uint32_t)(1e6f / avoid(0.5f * (va + vb)));   // ramps pass through bands
+      rampTotal += rs[k];
+    }
+    if (2*rampTotal > n) {               // rounding overshoot: trim the top chunk
+      uint32_t trim = min(rs[PLAN_RAMP_CHUNKS-1], (2*rampTotal - n + 1) / 2);
+      rs[PLAN_RAMP_CHUNKS-1] -= trim; rampTotal -= trim;
+    }
+    for (int k = 0; k < PLAN_RAMP_CHUNKS; ++k) { chunkTicks[chunks] = rs[k]; chunkUs[chunks++] = ru[k]; }
+    chunkTicks[chunks] = n - 2*rampTotal; chunkUs[chunks++] = (uint32_t)(1e6f / rate);
+    for (int k = PLAN_RAMP_CHUNKS - 1; k >= 0; --k) { chunkTicks[chunks] = rs[k]; chunkUs[chunks++] = ru[k]; }
+  }
+
+  int used = 0;
+  for (int c = 0; c < chunks; ++c) used += chunkTicks[c] ? 1 : 0;
+  if (plan.count + used > PLAN_MAX_SEGMENTS) return PLAN_ERR_FULL;
+
+  // split each axis over the chunks by cumulative rounding (totals stay exact)
+  uint32_t cum = 0;
+  int32_t given[MOTION_AXES] = {0};
+  for (int c = 0; c < chunks; ++c) {
+    if (!chunkTicks[c]) continue;
+    cum += chunkTicks[c];
+    int32_t part[MOTION_AXES];
+    for (uint8_t a = 0; a < MOTION_AXES; ++a) {
+      int32_t upto = (int32_t)(((int64_t)d[a] * cum + (d[a] < 0 ? -(int64_t)n/2 : (int64_t)n/2)) / n);
+      part[a] = upto - given[a];
+      given[a] = upto;
+    }
+    planPush(part, chunkUs[c], 0);
+  }
+  return PLAN_OK;
+}
+
+// Coordinated relative move that takes `ms` end to end.
+inline PlanError planAddMoveAxesTimed(const int32_t d[MOTION_AXES], uint32_t ms, float accel = PLAN_ACCEL_AXES) {
+  uint32_t n = 0;
+  for (uint8_t a = 0; a < MOTION_AXES; ++a) n = max<uint32_t>(n, (uint32_t)abs(d[a]));
+  if (n == 0) return planAddDwell(ms);
+  float vmax, amax;
+  planMoveLimits(d, vmax, amax);
+  accel = min(accel, amax);
+  const float v0 = min(planMinRate(), vmax);
+  float v = planRateForDuration((float)n, ms / 1000.0f, accel, v0, vmax);
+  if (v < 0) {
+    g_planShort.steps   = n;
+    g_planShort.askedMs = ms;
+    g_planShort.minMs   = (uint32_t)ceilf(planTrapTime((float)n, vmax, accel, v0) * 1000.0f);
+    return PLAN_ERR_TOO_FAST;
+  }
+
+  // A cruise inside a resonance band goes up to the band's top edge when it
+  // can; the time saved becomes a dwell at the end so the leg keeps its length.
+  // When the top edge is beyond the rig, the band's lower edge would make the
+  // leg late, so it is refused with that slower time as the minimum.
+  const float share = (float)abs(d[AXIS_SLIDE]) / n;
+  float v2 = v;
+  if (share > 0.0f) v2 = resonanceAvoidRate(v * share, vmax * share, true) / share;
+  if (v2 < v) {
+    g_planShort.steps   = n;
+    g_planShort.askedMs = ms;
+    g_planShort.minMs   = (uint32_t)ceilf(planTrapTime((float)n, v2, accel, v0) * 1000.0f);
+    return PLAN_ERR_TOO_FAST;
+  }
+  PlanError e = planAddMoveAxes(d, v2, accel);
+  if (e != PLAN_OK || v2 == v) return e;
+  float spare = ms / 1000.0f - planTrapTime((float)n, v2, accel, v0);
+  return spare > 0.001f ? planAddDwell((uint32_t)(spare * 1000.0f)) : PLAN_OK;
+}
+
+// Slide-only shorthands
+inline PlanError planAddMoveAtRate(int32_t steps, float rate, float accel = PLAN_ACCEL_AXES) {
+  int32_t d[MOTION_AXES] = {0}; d[AXIS_SLIDE] = steps;
+  return planAddMoveAxes(d, rate, accel);
+}
+inline PlanError planAddMoveTimed(int32_t steps, uint32_t ms, float accel = PLAN_ACCEL_AXES) {
+  int32_t d[MOTION_AXES] = {0}; d[AXIS_SLIDE] = steps;
+  return planAddMoveAxesTimed(d, ms, accel);
+}
+
+// Everything from here on is independent of where the carriage started, so
+// it can be cached and replayed after a fresh positioning move.
+inline void planMarkEntry(const int32_t at[MOTION_AXES]) {
+  plan.entry = plan.count;
+  for (uint8_t a = 0; a < MOTION_AXES; ++a) plan.entrySteps[a] = at[a];
+}
+
+// Mark where the repeated body begins (everything before runs once).
+inline void planBeginLoop() { plan.loopStart = plan.count; }
+// Mark where it ends; segments added after run once, after the last loop.
+// Without it the body runs to the end of the plan.
+inline void planEndLoop() { plan.loopEnd = plan.count; }
+
+// Totals for progress/ETA; call after the plan is built.
+inline void planFinalize(uint16_t loops) {
+  plan.loops = max<uint16_t>(1, loops);
+  if (plan.loopEnd <= plan.loopStart || plan.loopEnd > plan.count) plan.loopEnd = plan.count;
+  uint64_t preSteps = 0, bodySteps = 0, preUs = 0, bodyUs = 0;
+  for (uint16_t i = 0; i < plan.count; ++i) {
+    const PlanSegment& s = plan.seg[i];
+    uint32_t n = planSegTicks(s);
+    uint64_t us = (uint64_t)n * s.usPerStep + (uint64_t)s.dwellMs * 1000ULL;
+    if (i < plan.loopStart || i >= plan.loopEnd) { preSteps += n; preUs += us; }
+    else                                         { bodySteps += n; bodyUs += us; }
+  }
+  plan.totalSteps = (uint32_t)(preSteps + bodySteps * plan.loops);
+  plan.totalMs    = (uint32_t)((preUs + bodyUs * plan.loops) / 1000ULL);
+}
+
+#endif
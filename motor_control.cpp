@@ -0,0 +1,18 @@
+// Axis table and motor settings.
+#include "motor_control.h"
+
+AxisConfig g_axes[MOTION_AXES] = {
+  { TMC_STEP_PIN, TMC_DIR_PIN, false, 800, 16, 0.0f, 0.0f, DEFAULT_TRAVEL_MM,
+    MOTOR_MIN_US_PER_STEP, DEFAULT_ACCEL_SPS2 },
+#if MOTION_AXES > 1
+  { PAN_STEP_PIN, PAN_DIR_PIN, false, 600, 16, PAN_STEPS_PER_DEG, -180.0f, 180.0f,
+    MOTOR_MIN_US_PER_STEP, DEFAULT_ACCEL_SPS2 },
+#endif
+#if MOTION_AXES > 2
+  { TILT_STEP_PIN, TILT_DIR_PIN, false, 600, 16, TILT_STEPS_PER_DEG, -90.0f, 90.0f,
+    MOTOR_MIN_US_PER_STEP, DEFAULT_ACCEL_SPS2 },
+#endif
+};
+
+uint8_t g_axisDirLevel = 0;
+MotorRuntimeState motorState;
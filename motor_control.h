@@ -1,11 +1,14 @@
 #pragma once
 #include <Arduino.h>
 #include "config.h"   // uses clampT<> declared in your config.h
+#include "resonance_map.h"
+#include "fast_gpio.h"
 
 // Pins must be defined in config.h:
 //   #define TMC_STEP_PIN  <pin>
 //   #define TMC_DIR_PIN   <pin>
 //   // #define TMC_EN_PIN <pin> (optional)
+//   // #define TMC_MS1_PIN / TMC_MS2_PIN <pin> (optional, TMC2209 standalone microstep select)
 
 #ifndef TMC_STEP_PIN
   #error "TMC_STEP_PIN not defined. Define it in config.h (e.g. #define TMC_STEP_PIN 13)."
@@ -14,39 +17,158 @@
   #error "TMC_DIR_PIN not defined. Define it in config.h (e.g. #define TMC_DIR_PIN 11)."
 #endif
 
+// ---------- axes ----------
+// Axis 0 is the slide; pan/tilt exist when their pins are defined in
+// config.h. Plans, the step generator and jobs size themselves from
+// MOTION_AXES, so a slide-only build carries no multi-axis cost.
+#if defined(PAN_STEP_PIN) && defined(TILT_STEP_PIN)
+  #define MOTION_AXES 3
+#elif defined(PAN_STEP_PIN)
+  #define MOTION_AXES 2
+#else
+  #define MOTION_AXES 1
+#endif
+
+// Step interval limits: 100% speed and the slowest percentage speed. 100% is
+// MOTOR_MIN_US_PER_STEP until the auto-tune (speed_tune.h) has measured the
+// rig; tuned limits never go below MOTOR_FLOOR_US_PER_STEP (step ISR headroom).
+#ifndef MOTOR_MIN_US_PER_STEP
+  #define MOTOR_MIN_US_PER_STEP 250
+#endif
+#ifndef MOTOR_FLOOR_US_PER_STEP
+  #define MOTOR_FLOOR_US_PER_STEP 40
+#endif
+#ifndef MOTOR_MAX_US_PER_STEP
+  #define MOTOR_MAX_US_PER_STEP 4000
+#endif
+#ifndef DEFAULT_ACCEL_SPS2
+  #define DEFAULT_ACCEL_SPS2 8000.0f   // steps/s^2
+#endif
+#ifndef DEFAULT_TRAVEL_MM
+  #define DEFAULT_TRAVEL_MM  600.0f
+#endif
+#ifndef PAN_STEPS_PER_DEG
+  #define PAN_STEPS_PER_DEG  (200.0f * 16 * 5 / 360.0f)  // 1.8° motor, 1/16, 5:1 gear
+#endif
+#ifndef TILT_STEPS_PER_DEG
+  #define TILT_STEPS_PER_DEG (200.0f * 16 * 5 / 360.0f)
+#endif
+
+enum AxisId : uint8_t { AXIS_SLIDE = 0, AXIS_PAN = 1, AXIS_TILT = 2 };
+
+struct AxisConfig {
+  uint8_t  stepPin;
+  uint8_t  dirPin;
+  bool     invertDir;
+  uint16_t current_mA;
+  uint16_t microstep;
+  float    stepsPerUnit;   // per degree for pan/tilt; slide uses stepsPerMM()
+  float    minPos;         // travel limits in mm / degrees
+  float    maxPos;
+  uint32_t minUsPerStep;   // fastest step period the axis can follow
+  float    accel;          // steps/s^2
+};
+
+extern AxisConfig g_axes[MOTION_AXES];
+
+// STEP/DIR masks per axis, fixed at compile time from the pin defines
+static constexpr GpioMask AXIS_STEP_MASK[MOTION_AXES] = {
+  FastPin<TMC_STEP_PIN>::mask(),
+#if MOTION_AXES > 1
+  FastPin<PAN_STEP_PIN>::mask(),
+#endif
+#if MOTION_AXES > 2
+  FastPin<TILT_STEP_PIN>::mask(),
+#endif
+};
+static constexpr GpioMask AXIS_DIR_MASK[MOTION_AXES] = {
+  FastPin<TMC_DIR_PIN>::mask(),
+#if MOTION_AXES > 1
+  FastPin<PAN_DIR_PIN>::mask(),
+#endif
+#if MOTION_AXES > 2
+  FastPin<TILT_DIR_PIN>::mask(),
+#endif
+};
+extern uint8_t g_axisDirLevel;   // DIR pin levels, bit per axis
+
 struct MotorRuntimeState {
   uint16_t current_mA    = 800;  // stored only (no UART in this minimal build)
-  uint16_t microstep     = 16;   // stored only
+  uint16_t microstep     = 16;   // stored only, unless the MS pins are wired
   uint8_t  speed_percent = 50;   // 5..100
 };
-static MotorRuntimeState motorState;
+extern MotorRuntimeState motorState;
+
+// ---------- microstep pins ----------
+// TMC2209 standalone: MS2:MS1 = 00 -> 8, 01 -> 32, 10 -> 64, 11 -> 16.
+inline constexpr bool microstepPinsWired() {
+#if defined(TMC_MS1_PIN) && defined(TMC_MS2_PIN)
+  return true;
+#else
+  return false;
+#endif
+}
+inline constexpr bool microstepPinsValid(uint16_t ms) { return ms == 8 || ms == 16 || ms == 32 || ms == 64; }
+inline bool microstepPinsApply(uint16_t ms) {
+  if (!microstepPinsValid(ms)) return false;
+#if defined(TMC_MS1_PIN) && defined(TMC_MS2_PIN)
+  digitalWrite(TMC_MS1_PIN, (ms == 32 || ms == 16) ? HIGH : LOW);
+  digitalWrite(TMC_MS2_PIN, (ms == 64 || ms == 16) ? HIGH : LOW);
+  return true;
+#else
+  return false;
+#endif
+}
 
 // ---------- init & primitives ----------
 inline void initMotor() {
-  pinMode(TMC_STEP_PIN, OUTPUT);
-  pinMode(TMC_DIR_PIN,  OUTPUT);
-  digitalWrite(TMC_STEP_PIN, LOW);
-  digitalWrite(TMC_DIR_PIN,  LOW);
+  for (uint8_t a = 0; a < MOTION_AXES; ++a) {
+    pinMode(g_axes[a].stepPin, OUTPUT);
+    pinMode(g_axes[a].dirPin,  OUTPUT);
+    digitalWrite(g_axes[a].stepPin, LOW);
+    digitalWrite(g_axes[a].dirPin,  LOW);
+  }
+  g_axisDirLevel = 0;
   #ifdef TMC_EN_PIN
     pinMode(TMC_EN_PIN, OUTPUT);
     digitalWrite(TMC_EN_PIN, LOW); // enable
   #endif
+  #if defined(TMC_MS1_PIN) && defined(TMC_MS2_PIN)
+    pinMode(TMC_MS1_PIN, OUTPUT);
+    pinMode(TMC_MS2_PIN, OUTPUT);
+    microstepPinsApply(g_axes[AXIS_SLIDE].microstep);
+  #endif
 }
-inline void setDir(bool forward) {
-  digitalWrite(TMC_DIR_PIN, forward ? HIGH : LOW);
+// Waits out the DIR setup time only when the level actually changes.
+inline void IRAM_ATTR axisSetDir(uint8_t a, bool forward) {
+  const uint8_t bit = (uint8_t)(1u << a);
+  const bool level = forward != g_axes[a].invertDir;
+  if (((g_axisDirLevel & bit) != 0) == level) return;
+  if (level) { gpioSetMask(AXIS_DIR_MASK[a]);   g_axisDirLevel |= bit; }
+  else       { gpioClearMask(AXIS_DIR_MASK[a]); g_axisDirLevel &= (uint8_t)~bit; }
+  gpioDelayNs(DIR_SETUP_NS);
 }
-inline void stepPulse() {
-  digitalWrite(TMC_STEP_PIN, HIGH);
-  delayMicroseconds(2);
-  digitalWrite(TMC_STEP_PIN, LOW);
+// One shared pulse for every axis in `mask`: a single register store
+// raises all STEP lines, so stepping three axes costs the same as one.
+inline void IRAM_ATTR axisStepPulseMask(uint8_t mask) {
+  GpioMask m = { 0, 0 };
+  for (uint8_t a = 0; a < MOTION_AXES; ++a) if (mask & (1u << a)) m = m | AXIS_STEP_MASK[a];
+  gpioSetMask(m);
+  gpioDelayNs(STEP_PULSE_NS);
+  gpioClearMask(m);
 }
+inline void setDir(bool forward) { axisSetDir(AXIS_SLIDE, forward); }
+inline void stepPulse() { axisStepPulseMask(1u << AXIS_SLIDE); }
 
 // ---------- tuning / speed ----------
 inline void setMotorCurrent(uint16_t mA) {
   motorState.current_mA = clampT<uint16_t>(mA, 200, 1700);
+  g_axes[AXIS_SLIDE].current_mA = motorState.current_mA;
 }
 inline void setMicrostepping(uint16_t ustep) {
   motorState.microstep = clampT<uint16_t>(ustep, 1, 256);
+  g_axes[AXIS_SLIDE].microstep = motorState.microstep;
+  microstepPinsApply(motorState.microstep);
 }
 inline void setSpeedPercent(int pct) {
   motorState.speed_percent = clampT<int>(pct, 5, 100);
@@ -55,11 +177,12 @@ inline int getSpeedPercent() { return motorState.speed_percent; }
 
 inline uint32_t usPerStepForPercent(uint8_t percent) {
   percent = clampT<uint8_t>(percent, 5, 100);
-  const float minUS = 250.0f;
-  const float maxUS = 4000.0f;
+  const uint32_t fastest = g_axes[AXIS_SLIDE].minUsPerStep;   // tuned or MOTOR_MIN_US_PER_STEP
+  const float minUS = (float)fastest;
+  const float maxUS = (float)MOTOR_MAX_US_PER_STEP;
   float t = (100.0f - percent) / 95.0f;
   float us = minUS + (maxUS - minUS) * t * t;
-  return (uint32_t)us;
+  return resonanceAvoidUs((uint32_t)us, fastest);
 }
 
 // Blocking runs (used by wizards)
@@ -90,6 +213,8 @@ inline void runForMillis(bool forward, uint32_t ms, uint8_t speedPercent = 0, Ca
 inline void motorEnable(bool en) {
   #ifdef TMC_EN_PIN
     digitalWrite(TMC_EN_PIN, en ? LOW : HIGH);
+  #else
+    (void)en;
   #endif
 }
 inline void checkEStopLongPress() { /* no-op stub */ }
\ No newline at end of file
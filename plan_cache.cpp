@@ -0,0 +1,56 @@
+// Plan cache index and header pool; planCacheStore() is the hook jobRun() calls.
+#include "plan_cache.h"
+
+const esp_partition_t* g_pcPart = nullptr;
+PlanCacheEntry g_pcIndex[PLAN_CACHE_SLOTS];
+uint8_t        g_pcCount   = 0;
+uint32_t       g_pcNextSeq = 1;
+uint32_t       g_pcLastSeq = 0;
+BlockPool<PlanCacheHeader, 3> g_pcHdrPool("pc-header");
+
+bool planCacheStore(const JobSpec& spec) {
+  g_pcLastSeq = 0;
+  if (!planCacheReady() || plan.count == 0) return false;
+  uint8_t* buf = pcBuf();
+  if (!buf) return false;
+  PlanCacheHeader& h = *(PlanCacheHeader*)buf;
+  h = PlanCacheHeader();
+  size_t codeLen = planEncode(buf + sizeof(h), PLAN_CACHE_SLOT_SIZE - sizeof(h));
+  if (codeLen == 0) return false;
+
+  h.magic = PLAN_CACHE_MAGIC; h.version = PLAN_CACHE_VERSION;
+  h.axes = MOTION_AXES;
+  h.codeLen = (uint16_t)codeLen;
+  h.stepsPerMM = stepsPerMM();
+  h.limitsTag = pcLimitsTag();
+  for (uint8_t a = 0; a < MOTION_AXES; ++a) h.entrySteps[a] = plan.entrySteps[a];
+  h.loops = plan.loops;
+  h.spec = spec;
+  h.crc = pcCrc32(buf + sizeof(h), codeLen, pcSpecCrc(h.spec));
+
+  // same job already cached? keep it (saves an erase)
+  {
+    PcHeaderLease old(g_pcHdrPool);
+    for (uint8_t i = 0; old && i < g_pcCount; ++i)
+      if (pcReadHeader(g_pcIndex[i].slot, *old) && old->crc == h.crc && old->codeLen == h.codeLen) { g_pcLastSeq = old->seq; return true; }
+  }
+
+  // free slot, else the oldest
+  const uint8_t slots = (uint8_t)min<size_t>(PLAN_CACHE_SLOTS, g_pcPart->size / PLAN_CACHE_SLOT_SIZE);
+  uint8_t slot = 0;
+  if (g_pcCount < slots) {
+    bool used[PLAN_CACHE_SLOTS] = {false};
+    for (uint8_t i = 0; i < g_pcCount; ++i) used[g_pcIndex[i].slot] = true;
+    while (slot < slots && used[slot]) ++slot;
+  } else {
+    slot = g_pcIndex[g_pcCount - 1].slot;
+  }
+
+  h.seq = g_pcNextSeq++;
+  const size_t off = (size_t)slot * PLAN_CACHE_SLOT_SIZE;
+  if (esp_partition_erase_range(g_pcPart, off, PLAN_CACHE_SLOT_SIZE) != ESP_OK) return false;
+  if (esp_partition_write(g_pcPart, off, buf, sizeof(h) + codeLen) != ESP_OK) return false;
+  g_pcLastSeq = h.seq;
+  planCacheInit();
+  return true;
+}
@@ -0,0 +1,310 @@
+#ifndef PLAN_CACHE_H
+#define PLAN_CACHE_H
+
+// Recently run jobs, kept as compiled plan bytecode in the "plans" flash
+// partition (see partitions.csv) so "Previously Set" can replay them without
+// re-planning. One 4 KB sector per slot; the index of recent jobs is rebuilt
+// in RAM from the slot headers at boot, and the oldest slot is overwritten.
+//
+// Bytecode (version PLAN_CACHE_VERSION), varints are LEB128, steps zigzag:
+//   0x01 RUN    steps, usPerStep        (slide only)
+//   0x02 RUNPREV steps                  (slide only, previous interval)
+//   0x03 DWELL  ms
+//   0x04 LOOP                           (repeated body starts here)
+//   0x05 RUNX   axisMask, steps per set bit, usPerStep
+//   0x06 SETTLE maxMs                   (dwell that may end early)
+//   0x07 LOOPEND                        (repeated body ends, the rest runs once)
+//   0x00 END
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "motion_plan.h"
+#include "step_generator.h"
+#include "job.h"
+
+#ifndef PLAN_CACHE_SLOTS
+  #define PLAN_CACHE_SLOTS     8
+#endif
+#define PLAN_CACHE_SLOT_SIZE   4096
+#define PLAN_CACHE_VERSION     3
+
+static const uint32_t PLAN_CACHE_MAGIC = 0x43505053; // 'SPPC'
+
+enum PlanCacheOp : uint8_t { PC_END=0, PC_RUN=1, PC_RUNPREV=2, PC_DWELL=3, PC_LOOP=4, PC_RUNX=5, PC_SETTLE=6,
+                           PC_LOOPEND=7 };
+
+struct PlanCacheHeader {
+  uint32_t magic;
+  uint8_t  version;
+  uint8_t  axes;         // MOTION_AXES of the build that wrote it
+  uint16_t codeLen;
+  uint32_t seq;          // higher = newer
+  uint32_t crc;          // over spec fields (pcSpecCrc) + code
+  float    stepsPerMM;   // rig scale the code was compiled for
+  int32_t  entrySteps[MOTION_AXES];
+  uint16_t loops;
+  uint16_t limitsTag;    // slide speed/accel limits it was planned with (pcLimitsTag)
+  JobSpec  spec;
+};
+
+// RAM index entry (newest first)
+struct PlanCacheEntry {
+  uint8_t  slot;
+  uint32_t seq;
+  JobType  type;
+  float    a_mm, b_mm;
+  uint32_t totalMS;
+  uint8_t  speedPct;
+  uint16_t repeat;
+  uint16_t shots;
+  uint8_t  kfCount;
+};
+
+extern const esp_partition_t* g_pcPart;
+extern PlanCacheEntry g_pcIndex[PLAN_CACHE_SLOTS];
+extern uint8_t        g_pcCount;
+extern uint32_t       g_pcNextSeq;
+extern uint32_t       g_pcLastSeq;   // entry holding the plan last stored or replayed
+extern BlockPool<PlanCacheHeader, 3> g_pcHdrPool;
+typedef PoolLease<BlockPool<PlanCacheHeader, 3>> PcHeaderLease;
+
+// One slot's worth of header + code, from the job arena (job.h).
+inline uint8_t* pcBuf() {
+  static uint8_t* buf = nullptr;
+  static uint32_t epoch = 0;
+  MemArena& a = jobArena();
+  if (!buf || epoch != a.epoch) { buf = (uint8_t*)arenaAlloc(a, PLAN_CACHE_SLOT_SIZE); epoch = a.epoch; }
+  return buf;
+}
+
+// ---------- encoding helpers ----------
+inline uint32_t pcCrc32(const uint8_t* p, size_t n, uint32_t crc = 0) {
+  crc = ~crc;
+  while (n--) {
+    crc ^= *p++;
+    for (int k = 0; k < 8; ++k) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+  }
+  return ~crc;
+}
+template <typename T>
+inline uint32_t pcCrcOf(const T& v, uint32_t crc) { return pcCrc32((const uint8_t*)&v, sizeof(v), crc); }
+
+// Field by field: the struct's padding is never initialised, so hashing
+// its raw bytes would make equal jobs look different.
+inline uint32_t pcSpecCrc(const JobSpec& j, uint32_t crc = 0) {
+  crc = pcCrcOf((uint8_t)j.type, crc);
+  for (float f : { j.a_mm, j.b_mm, j.aPan, j.bPan, j.aTilt, j.bTilt }) crc = pcCrcOf(f, crc);
+  crc = pcCrcOf(j.totalMS, crc); crc = pcCrcOf(j.speedPct, crc); crc = pcCrcOf(j.pauseMs, crc);
+  crc = pcCrcOf(j.repeat, crc);  crc = pcCrcOf(j.shots, crc);    crc = pcCrcOf(j.kfCount, crc);
+  for (uint8_t i = 0; i < j.kfCount && i < JOB_MAX_KEYFRAMES; ++i) {
+    const JobKeyframe& k = j.kf[i];
+    for (float f : { k.pos_mm, k.pan, k.tilt }) crc = pcCrcOf(f, crc);
+    crc = pcCrcOf(k.ms, crc); crc = pcCrcOf(k.pauseMs, crc);
+  }
+  return crc;
+}
+
+// Slide limits the planner is using now (payload profile, speed_tune.h)
+inline uint16_t pcLimitsTag() {
+  const AxisConfig& s = g_axes[AXIS_SLIDE];
+  const uint32_t v[2] = { s.minUsPerStep, (uint32_t)s.accel };
+  return (uint16_t)pcCrc32((const uint8_t*)v, sizeof(v));
+}
+
+inline bool pcPutVar(uint8_t*& w, const uint8_t* end, uint32_t v) {
+  do {
+    if (w >= end) return false;
+    uint8_t b = v & 0x7F; v >>= 7;
+    *w++ = b | (v ? 0x80 : 0);
+  } while (v);
+  return true;
+}
+inline bool pcGetVar(const uint8_t*& r, const uint8_t* end, uint32_t& v) {
+  v = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (r >= end) return false;
+    uint8_t b = *r++;
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) return true;
+  }
+  return false;
+}
+inline uint32_t pcZig(int32_t v)   { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+inline int32_t  pcUnzig(uint32_t v){ return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+// Encode plan.seg[plan.entry..count) into out; returns length or 0 if it doesn't fit.
+inline size_t planEncode(uint8_t* out, size_t cap) {
+  uint8_t* w = out; const uint8_t* end = out + cap;
+  uint32_t prevUs = 0;
+  for (uint16_t i = plan.entry; i < plan.count; ++i) {
+    if (i == plan.loopStart) { if (w >= end) return 0; *w++ = PC_LOOP; }
+    if (i == plan.loopEnd && i > plan.loopStart) { if (w >= end) return 0; *w++ = PC_LOOPEND; }
+    const PlanSegment& s = plan.seg[i];
+    if (w >= end) return 0;
+    uint8_t mask = 0;
+    for (uint8_t a = 0; a < MOTION_AXES; ++a) if (s.steps[a]) mask |= (uint8_t)(1u << a);
+    if (mask == 0) {
+      *w++ = (s.flags & PLAN_SEG_SETTLE) ? PC_SETTLE : PC_DWELL;
+      if (!pcPutVar(w, end, s.dwellMs)) return 0;
+    } else if (mask != 1) {
+      *w++ = PC_RUNX;
+      if (w >= end) return 0;
+      *w++ = mask;
+      for (uint8_t a = 0; a < MOTION_AXES; ++a)
+        if ((mask & (1u << a)) && !pcPutVar(w, end, pcZig(s.steps[a]))) return 0;
+      if (!pcPutVar(w, end, s.usPerStep)) return 0;
+      prevUs = s.usPerStep;
+    } else if (s.usPerStep == prevUs) {
+      *w++ = PC_RUNPREV;
+      if (!pcPutVar(w, end, pcZig(s.steps[AXIS_SLIDE]))) return 0;
+    } else {
+      *w++ = PC_RUN;
+      if (!pcPutVar(w, end, pcZig(s.steps[AXIS_SLIDE])) || !pcPutVar(w, end, s.usPerStep)) return 0;
+      prevUs = s.usPerStep;
+    }
+  }
+  if (w >= end) return 0;
+  *w++ = PC_END;
+  return (size_t)(w - out);
+}
+
+// Append decoded segments to the plan (loop markers set plan.loopStart/loopEnd).
+inline bool planDecodeAppend(const uint8_t* code, size_t len) {
+  const uint8_t* r = code; const uint8_t* end = code + len;
+  uint32_t prevUs = 0, a, b;
+  int32_t d[MOTION_AXES];
+  while (r < end) {
+    uint8_t op = *r++;
+    for (uint8_t k = 0; k < MOTION_AXES; ++k) d[k] = 0;
+    switch (op) {
+      case PC_END:  return true;
+      case PC_LOOP: planBeginLoop(); break;
+      case PC_LOOPEND: planEndLoop(); break;
+      case PC_DWELL:
+        if (!pcGetVar(r, end, a) || planAddDwell(a) != PLAN_OK) return false;
+        break;
+      case PC_SETTLE:
+        if (!pcGetVar(r, end, a) || planAddSettle(a) != PLAN_OK) return false;
+        break;
+      case PC_RUNPREV:
+        if (!pcGetVar(r, end, a)) return false;
+        d[AXIS_SLIDE] = pcUnzig(a);
+        if (!planPush(d, prevUs, 0)) return false;
+        break;
+      case PC_RUN:
+        if (!pcGetVar(r, end, a) || !pcGetVar(r, end, b)) return false;
+        d[AXIS_SLIDE] = pcUnzig(a);
+        if (!planPush(d, b, 0)) return false;
+        prevUs = b;
+        break;
+      case PC_RUNX: {
+        if (r >= end) return false;
+        uint8_t mask = *r++;
+        if (mask >> MOTION_AXES) return false;     // axis this build doesn't have
+        for (uint8_t k = 0; k < MOTION_AXES; ++k) {
+          if (!(mask & (1u << k))) continue;
+          if (!pcGetVar(r, end, a)) return false;
+          d[k] = pcUnzig(a);
+        }
+        if (!pcGetVar(r, end, b) || !planPush(d, b, 0)) return false;
+        prevUs = b;
+        break;
+      }
+      default: return false;
+    }
+  }
+  return false;
+}
+
+// ---------- flash ----------
+inline bool pcReadHeader(uint8_t slot, PlanCacheHeader& h) {
+  if (!g_pcPart) return false;
+  if (esp_partition_read(g_pcPart, (size_t)slot * PLAN_CACHE_SLOT_SIZE, &h, sizeof(h)) != ESP_OK) return false;
+  return h.magic == PLAN_CACHE_MAGIC && h.version == PLAN_CACHE_VERSION
+      && h.axes == MOTION_AXES && sizeof(h) + h.codeLen <= PLAN_CACHE_SLOT_SIZE;
+}
+
+// Scan slot headers and rebuild the newest-first index.
+inline void planCacheInit() {
+  g_pcPart = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "plans");
+  g_pcCount = 0;
+  if (!g_pcPart) return;
+  const uint8_t slots = (uint8_t)min<size_t>(PLAN_CACHE_SLOTS, g_pcPart->size / PLAN_CACHE_SLOT_SIZE);
+  PcHeaderLease lease(g_pcHdrPool);
+  if (!lease) return;
+  PlanCacheHeader& h = *lease;
+  for (uint8_t s = 0; s < slots; ++s) {
+    if (!pcReadHeader(s, h)) continue;
+    PlanCacheEntry e;
+    e.slot = s; e.seq = h.seq; e.type = h.spec.type;
+    e.a_mm = h.spec.a_mm; e.b_mm = h.spec.b_mm; e.totalMS = h.spec.totalMS;
+    e.speedPct = h.spec.speedPct; e.repeat = h.spec.repeat;
+    e.shots = h.spec.shots; e.kfCount = h.spec.kfCount;
+    // insertion sort, newest first
+    int i = g_pcCount++;
+    while (i > 0 && g_pcIndex[i-1].seq < e.seq) { g_pcIndex[i] = g_pcIndex[i-1]; --i; }
+    g_pcIndex[i] = e;
+    if (h.seq >= g_pcNextSeq) g_pcNextSeq = h.seq + 1;
+  }
+}
+
+inline bool planCacheReady() {
+  static bool scanned = false;
+  if (!scanned) { planCacheInit(); scanned = true; }
+  return g_pcPart != nullptr;
+}
+
+inline uint8_t planCacheCount() { planCacheReady(); return g_pcCount; }
+inline const PlanCacheEntry& planCacheEntry(uint8_t i) { return g_pcIndex[i]; }
+
+// Store the plan just compiled for `spec`. Identical jobs are not rewritten.
+bool planCacheStore(const JobSpec& spec);
+
+// Position to the cached entry point and start streaming the stored plan.
+inline bool planCacheReplay(uint8_t idx) {
+  if (!planCacheReady() || idx >= g_pcCount || plan.active) return false;
+  jobArenaReset();
+  uint8_t* buf = pcBuf();
+  if (!buf) return false;
+  PlanCacheHeader& h = *(PlanCacheHeader*)buf;
+  if (!pcReadHeader(g_pcIndex[idx].slot, h)) return false;
+  const size_t off = (size_t)g_pcIndex[idx].slot * PLAN_CACHE_SLOT_SIZE;
+  if (esp_partition_read(g_pcPart, off, buf, sizeof(h) + h.codeLen) != ESP_OK) return false;
+  const uint8_t* code = buf + sizeof(h);
+  if (pcCrc32(code, h.codeLen, pcSpecCrc(h.spec)) != h.crc) return false;
+
+  // rig scale or limits changed since caching: the steps are stale, recompile instead
+  if (fabsf(h.stepsPerMM - stepsPerMM()) > 1e-3f || h.limitsTag != pcLimitsTag()) {
+    JobSpec* j = arenaNew<JobSpec>(jobArena());
+    if (!j) return false;
+    *j = h.spec;              // buf is reused when the recompiled plan is cached
+    return jobRun(*j);
+  }
+
+  planReset();
+  float rate = 1e6f / usPerStepForPercent(JOB_REHOME_PCT);
+  int32_t d[MOTION_AXES];
+  for (uint8_t a = 0; a < MOTION_AXES; ++a) d[a] = h.entrySteps[a] - axisPosition(a);
+  if (planAddMoveAxes(d, rate) != PLAN_OK) return false;
+  planMarkEntry(h.entrySteps);
+  planBeginLoop();                       // no LOOP marker = whole tail repeats
+  if (!planDecodeAppend(code, h.codeLen)) { planReset(); return false; }
+  planFinalize(h.loops);
+  g_job = h.spec;
+  g_jobLoaded = true;
+  g_pcLastSeq = h.seq;
+  settleReset();
+  resumeArm();
+  return planStart();
+}
+
+// Short label for list rows, e.g. "Bounce 10-110mm x2"
+inline void planCacheLabel(const PlanCacheEntry& e, char* out, size_t cap) {
+  const char* name = e.type == JOB_SINGLE ? "Single" : e.type == JOB_BOUNCE ? "Bounce"
+                   : e.type == JOB_MULTI  ? "Multi"  : e.type == JOB_TIMELAPSE ? "Lapse" : "Job";
+  if (e.type == JOB_MULTI)          snprintf(out, cap, "%s %ukf x%u", name, e.kfCount, e.repeat);
+  else if (e.type == JOB_TIMELAPSE) snprintf(out, cap, "%s %u shots", name, e.shots);
+  else snprintf(out, cap, "%s %d-%dmm x%u", name, (int)e.a_mm, (int)e.b_mm, e.repeat);
+}
+
+#endif
@@ -4,14 +4,69 @@
 #include "wizard_ui.h"
 #include "ui_helpers.h"
 #include "rotary_input.h"
+#include "plan_cache.h"
 
-inline void runPreviouslySavedScreen() {
-  while (true) {
+// Recently run jobs from the plan cache, newest first. OK replays the cached
+// plan directly (no re-planning); Back/OK during the run stops it.
+
+static inline void drawPreviouslySaved(int sel) {
+  const int count = planCacheCount();
+  if (count == 0) {
     wizardFrameStart("Begin");
     wizardCenterTwo("Previously Set", "No saved data");
+    return;
+  }
+  uiBegin();
+  drawRightTabTop("Back");
+  drawRightTabBottom("Begin");
 
+  int firstVisible = constrain(sel - 1, 0, max(0, count - LIST_ROWS));
+  char label[32];
+  for (int i = 0; i < LIST_ROWS; ++i) {
+    int idx = firstVisible + i;
+    if (idx >= count) break;
+    planCacheLabel(planCacheEntry(idx), label, sizeof(label));
+    drawListItemRailAware(listRowTop(i), label, idx == sel);
+  }
+  drawSlimScroll(count, firstVisible, LIST_ROWS);
+}
+
+// Progress until the plan finishes or the user stops it
+static inline void runCachedPlanProgress() {
+  int lastPct = -1;
+  while (planRunning()) {
+    int pct = plan.totalSteps ? (int)((uint64_t)plan.stepsDone * 100 / plan.totalSteps) : 0;
+    if (pct != lastPct) {
+      wizardFrameStart("Stop");
+      drawCenteredProgress(pct);
+      lastPct = pct;
+    }
     updateRotary();
-    if (isSelectPressed()) return; // Begin would start; here just return
+    if (isSelectPressed() || isBackPressed()) { planStop(); break; }
+    settleTick();
+    idleDimmerTick();
+    delay(10);
+  }
+}
+
+inline void runPreviouslySavedScreen() {
+  int sel = 0;
+  drawPreviouslySaved(sel);
+  while (true) {
+    updateRotary();
+    const int count = planCacheCount();
+
+    int d = getEncoderDelta();
+    if (d != 0 && count > 0) {
+      sel = constrain(sel + (d > 0 ? 1 : -1), 0, count - 1);
+      drawPreviouslySaved(sel);
+    }
+
+    if (isSelectPressed()) {
+      if (count == 0) return;
+      if (planCacheReplay((uint8_t)sel)) runCachedPlanProgress();
+      drawPreviouslySaved(sel);
+    }
     if (isBackPressed()) return;
     idleDimmerTick();
     delay(10);
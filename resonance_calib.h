@@ -0,0 +1,155 @@
+#ifndef RESONANCE_CALIB_H
+#define RESONANCE_CALIB_H
+
+// Resonance scan: hold the slide at a sweep of step rates while the AS5600
+// measures velocity ripple, then store the ripple map and the bands to
+// avoid (see resonance_map.h). The carriage alternates direction per rate
+// so it stays within a few centimetres of where the scan started.
+
+#include <Arduino.h>
+#include <math.h>
+#include "config.h"
+#include "encoder_utils.h"
+#include "motion_plan.h"
+#include "step_generator.h"
+#include "resonance_map.h"
+#include "rig_scale.h"
+#include "eeprom_utils.h"
+#include "wizard_ui.h"
+
+#ifndef RESONANCE_BAND_FACTOR
+  #define RESONANCE_BAND_FACTOR 1.8f   // ripple vs. the median that marks a band
+#endif
+#ifndef RESONANCE_MIN_RIPPLE
+  #define RESONANCE_MIN_RIPPLE  0.06f  // never flag bins below 6 % ripple
+#endif
+#define RES_COUNTS_PER_SAMPLE 24       // encoder counts per velocity sample
+#define RES_SAMPLES           40       // velocity samples per rate
+
+typedef bool (*ResCancelFn)();
+typedef void (*ResProgressFn)(int pct);
+
+// AS5600 counts per slide microstep (sensor on the motor shaft)
+inline float resCountsPerStep() {
+  return 65536.0f / rigScale().stepsPerCountQ16;
+}
+
+// Cruise at `rate` in direction `dir` and return velocity ripple
+// (stddev/mean of per-sample encoder deltas), or <0 if cancelled.
+inline float resonanceMeasure(float rate, int8_t dir, ResCancelFn cancel) {
+  const float cps = rate * resCountsPerStep();
+  const uint32_t sampleUs = (uint32_t)(1e6f * RES_COUNTS_PER_SAMPLE / cps);
+  const float holdS = max(0.4f, sampleUs * (RES_SAMPLES + 2) / 1e6f);
+
+  planReset();
+  if (planAddMoveAtRate(dir * (int32_t)(rate * holdS), rate) != PLAN_OK) return -1;
+  // cruise = the segment with the shortest period
+  uint16_t cruise = 0;
+  for (uint16_t i = 1; i < plan.count; ++i)
+    if (plan.seg[i].usPerStep < plan.seg[cruise].usPerStep) cruise = i;
+  planFinalize(1);
+  if (!planStart()) return -1;
+
+  while (plan.active && plan.cur < cruise) { if (cancel && cancel()) { planStop(); return -1; } }
+
+  float sum = 0, sumSq = 0; int n = 0;
+  uint16_t prev = readRawAngle();
+  uint32_t t = micros();
+  while (plan.active && plan.cur == cruise && n < RES_SAMPLES) {
+    if (cancel && cancel()) { planStop(); return -1; }
+    if ((uint32_t)(micros() - t) < sampleUs) continue;
+    t += sampleUs;
+    uint16_t raw = readRawAngle();
+    float d = (float)(encoderRawDelta(prev, raw) * dir);
+    prev = raw;
+    sum += d; sumSq += d*d; n++;
+  }
+  while (plan.active) { if (cancel && cancel()) { planStop(); return -1; } }
+
+  if (n < 4 || sum <= 0) return 0;
+  const float mean = sum / n;
+  float var = sumSq / n - mean*mean - 1.0f/6.0f;   // minus quantisation noise
+  return var > 0 ? sqrtf(var) / mean : 0.0f;
+}
+
+// Full sweep over the plannable slide rates; returns bands found or -1.
+inline int resonanceCalibrate(ResProgressFn progress, ResCancelFn cancel) {
+  encoderInit();
+  if (!encoderIsPresent()) return -1;
+
+  const float lo = planMinRate(), hi = planMaxRate();
+  float ripple[RESONANCE_BINS];
+  int8_t dir = 1;
+  g_resonanceBypass = true;
+  for (int b = 0; b < RESONANCE_BINS; ++b) {
+    float rate = lo + (b + 0.5f) * (hi - lo) / RESONANCE_BINS;
+    ripple[b] = resonanceMeasure(rate, dir, cancel);
+    if (ripple[b] < 0) { g_resonanceBypass = false; return -1; }
+    dir = -dir;
+    if (progress) progress((b + 1) * 100 / RESONANCE_BINS);
+  }
+  g_resonanceBypass = false;
+
+  // median ripple as the rig's baseline
+  float sorted[RESONANCE_BINS];
+  memcpy(sorted, ripple, sizeof(sorted));
+  for (int i = 1; i < RESONANCE_BINS; ++i) {
+    float v = sorted[i]; int j = i;
+    while (j > 0 && sorted[j-1] > v) { sorted[j] = sorted[j-1]; --j; }
+    sorted[j] = v;
+  }
+  const float limit = max(RESONANCE_MIN_RIPPLE, RESONANCE_BAND_FACTOR * sorted[RESONANCE_BINS/2]);
+
+  uint32_t mask = 0; int bands = 0;
+  for (int b = 0; b < RESONANCE_BINS; ++b) {
+    runtimeState.resRipple[b] = (uint8_t)min(255.0f, ripple[b] * 200.0f);
+    if (ripple[b] > limit) {
+      if (b == 0 || !(mask & (1UL << (b - 1)))) bands++;
+      mask |= 1UL << b;
+    }
+  }
+  runtimeState.resRateLo   = lo;
+  runtimeState.resRateHi   = hi;
+  runtimeState.resBandMask = mask;
+  eepromSaveRuntime();
+  return bands;
+}
+
+// ---------- screen ----------
+static inline bool resCancelByButton() {
+  updateRotary();
+  return isBackPressed() || isSelectPressed();
+}
+static inline void resDrawProgress(int pct) {
+  wizardFrameStart("Stop");
+  drawCenteredProgress(pct);
+}
+
+inline void runResonanceCalibration() {
+  wizardFrameStart("Start");
+  wizardCenterTwo("Resonance scan", "Centre carriage, OK");
+  while (true) {
+    updateRotary();
+    if (isSelectPressed()) break;
+    if (isBackPressed()) return;
+    idleDimmerTick();
+    delay(10);
+  }
+
+  resDrawProgress(0);
+  int bands = resonanceCalibrate(resDrawProgress, resCancelByButton);
+
+  char line[24];
+  if (bands < 0) snprintf(line, sizeof(line), "%s", encoderIsPresent() ? "Cancelled" : "No encoder");
+  else           snprintf(line, sizeof(line), "%d band%s saved", bands, bands == 1 ? "" : "s");
+  wizardFrameStart("OK");
+  wizardCenterTwo("Resonance scan", line);
+  while (true) {
+    updateRotary();
+    if (isSelectPressed() || isBackPressed()) return;
+    idleDimmerTick();
+    delay(10);
+  }
+}
+
+#endif
@@ -0,0 +1,4 @@
+// Resonance skipping switch.
+#include "resonance_map.h"
+
+bool g_resonanceBypass = false;
@@ -0,0 +1,61 @@
+#ifndef RESONANCE_MAP_H
+#define RESONANCE_MAP_H
+
+// Slide step-rate bands where the rig resonates, as measured by
+// resonance_calib.h and stored in runtimeState. Speeds are nudged out of a
+// band to its nearest edge, so nothing ever cruises inside one; ramps only
+// pass through. Rates are in microsteps/s; slSetSetting(SLK_MICROSTEP)
+// rescales them so a band stays at the same carriage speed.
+
+#include <Arduino.h>
+#include "eeprom_utils.h"
+
+#ifndef RESONANCE_EDGE_MARGIN
+  #define RESONANCE_EDGE_MARGIN 0.02f   // fraction of a bin beyond the band edge
+#endif
+
+extern bool g_resonanceBypass;   // set while calibrating
+
+inline bool resonanceMapValid() {
+  return runtimeState.resBandMask != 0 && runtimeState.resRateHi > runtimeState.resRateLo;
+}
+inline float resonanceBinWidth() {
+  return (runtimeState.resRateHi - runtimeState.resRateLo) / RESONANCE_BINS;
+}
+inline int resonanceBinForRate(float rate) {
+  if (rate < runtimeState.resRateLo || rate >= runtimeState.resRateHi) return -1;
+  return (int)((rate - runtimeState.resRateLo) / resonanceBinWidth());
+}
+inline bool resonanceBinIsBand(int b) {
+  return b >= 0 && b < RESONANCE_BINS && (runtimeState.resBandMask & (1UL << b));
+}
+
+// Nearest rate outside the band containing `rate` (or `rate` itself).
+// preferUp picks the upper edge when it is <= maxRate; the result never
+// exceeds maxRate.
+inline float resonanceAvoidRate(float rate, float maxRate, bool preferUp = false) {
+  if (g_resonanceBypass || !resonanceMapValid()) return rate;
+  int b = resonanceBinForRate(rate);
+  if (!resonanceBinIsBand(b)) return rate;
+
+  int b0 = b, b1 = b;
+  while (resonanceBinIsBand(b0 - 1)) --b0;
+  while (resonanceBinIsBand(b1 + 1)) ++b1;
+  const float w  = resonanceBinWidth();
+  const float lo = runtimeState.resRateLo + b0 * w - RESONANCE_EDGE_MARGIN * w;
+  const float hi = runtimeState.resRateLo + (b1 + 1) * w + RESONANCE_EDGE_MARGIN * w;
+
+  const bool upOk = hi <= maxRate;
+  if (lo <= 1.0f) return upOk ? hi : rate;
+  if (!upOk) return lo;
+  if (preferUp) return hi;
+  return (rate - lo <= hi - rate) ? lo : hi;
+}
+
+inline uint32_t resonanceAvoidUs(uint32_t us, uint32_t minUs) {
+  if (us == 0) return us;
+  float r = resonanceAvoidRate(1e6f / us, 1e6f / max<uint32_t>(1, minUs));
+  return (uint32_t)(1e6f / r);
+}
+
+#endif
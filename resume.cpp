@@ -0,0 +1,16 @@
+// Resume journal (the record survives a reset in RTC RAM) and resumeArm(),
+// which jobRun() and planCacheReplay() call.
+#include "resume.h"
+
+ResumeJournal g_rj;
+RTC_NOINIT_ATTR ResumeRecord g_resumeRtc;
+
+void resumeArm() {
+  resumeBegin();
+  g_rj.jobSeq = g_pcLastSeq;
+  g_rj.wasActive = false;
+  g_rj.startMs = g_rj.lastFlashMs = millis();
+  g_rj.lastFlashPos = g_axisPos[AXIS_SLIDE];
+  resumeDiscard();                                    // a new job replaces the old one
+  rjPrepare(true);                                    // timer not running yet: erase is harmless
+}
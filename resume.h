@@ -0,0 +1,378 @@
+#ifndef RESUME_H
+#define RESUME_H
+
+// Power-loss resume. While a job runs, a RESUME_TICK_MS esp_timer tick
+// snapshots where it is: segment, loop pass, ticks into the segment,
+// axis positions, the AS5600 angle and elapsed time. Every snapshot goes
+// to RTC memory (covers resets); one is appended to a journal in the
+// "resume" flash partition (covers a pulled battery) every RESUME_FLASH_MS,
+// or sooner once the slide has moved a quarter turn of the encoder since
+// the last one: 40 bytes per write, sectors used round-robin. A job that
+// ends or is stopped appends a DONE record.
+//
+// Sector erases stall interrupts, so the next sector is erased ahead of
+// time, when the job starts or when the step ISR is idle for at least
+// RESUME_ERASE_GAP_US (a dwell or a slow step). If no erased slot is
+// ready, that checkpoint is skipped.
+//
+// On boot a job whose last record is a checkpoint is offered for resume.
+// The slide is re-seated from the encoder: its single-turn angle gives the
+// travel since the checkpoint, within a window biased towards the
+// direction the job was moving. The carriage then moves back to the
+// checkpoint position and the cached plan (plan_cache.h) restarts exactly
+// there.
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <esp_partition.h>
+#include "config.h"
+#include "motion_plan.h"
+#include "step_generator.h"
+#include "job.h"
+#include "plan_cache.h"
+#include "encoder_utils.h"
+#include "rig_scale.h"
+#include "flight_recorder.h"
+#include "http_router.h"
+
+#ifndef RESUME_TICK_MS
+  #define RESUME_TICK_MS 100
+#endif
+#ifndef RESUME_FLASH_MS
+  #define RESUME_FLASH_MS 10000
+#endif
+#ifndef RESUME_ERASE_GAP_US
+  #define RESUME_ERASE_GAP_US 80000
+#endif
+#define RESUME_SECTOR 4096
+
+static const uint16_t RESUME_MAGIC = 0x5352; // 'RS'
+
+enum ResumeKind  : uint8_t { RK_CHECKPOINT = 1, RK_DONE = 2 };
+enum ResumeState : uint8_t { RS_IDLE = 0, RS_OFFER, RS_SEEKING };
+
+struct ResumeRecord {
+  uint16_t magic;
+  uint8_t  kind;
+  uint8_t  axes;
+  uint32_t seq;          // journal sequence, higher = newer
+  uint32_t jobSeq;       // plan cache entry of the job
+  uint16_t seg;          // segment, counted from the plan's entry
+  uint16_t loopsDone;
+  uint32_t segDone;      // ticks into the segment, or ms into a dwell
+  int32_t  pos[3];       // axis positions, steps
+  uint16_t raw;          // AS5600 raw angle at pos (0xFFFF = no encoder)
+  uint16_t crc;
+  uint32_t elapsedMs;
+};
+static_assert(sizeof(ResumeRecord) == 40, "ResumeRecord is a fixed 40-byte journal slot");
+
+#define RESUME_PER_SECTOR (RESUME_SECTOR / sizeof(ResumeRecord))
+
+struct ResumeJournal {
+  const esp_partition_t* part = nullptr;
+  bool     ready = false;
+  uint16_t sectors = 0;
+  uint16_t head = 0;          // next slot to write
+  int16_t  erased = -1;       // sector known to be blank, -1 = none
+  uint32_t seq = 0;           // newest sequence written or found
+  uint16_t skipped = 0;       // flash checkpoints dropped for want of an erased slot
+  esp_timer_handle_t timer = nullptr;
+
+  // the running job
+  uint32_t jobSeq = 0;        // 0 = no job armed
+  bool     wasActive = false;
+  uint32_t startMs = 0;
+  uint32_t lastFlashMs = 0;
+  int32_t  lastFlashPos = 0;  // slide position of the last flash checkpoint
+
+  // the offer
+  volatile ResumeState state = RS_IDLE;
+  ResumeRecord cp = {};
+  uint8_t  cacheIdx = 0;
+  float    progress = 0.0f;
+  int32_t  seatSteps = 0;     // correction the encoder applied on resume
+};
+extern ResumeJournal g_rj;
+extern ResumeRecord g_resumeRtc;
+
+inline uint16_t resumeCrc(const ResumeRecord& r) {
+  ResumeRecord c = r;
+  c.crc = 0;
+  return (uint16_t)pcCrc32((const uint8_t*)&c, sizeof(c));
+}
+inline bool resumeValid(const ResumeRecord& r) {
+  return r.magic == RESUME_MAGIC && r.axes == MOTION_AXES && r.crc == resumeCrc(r);
+}
+
+// ---------- journal ----------
+inline uint32_t rjSlots() { return (uint32_t)g_rj.sectors * RESUME_PER_SECTOR; }
+inline size_t   rjOffset(uint32_t slot) {
+  return (slot / RESUME_PER_SECTOR) * RESUME_SECTOR + (slot % RESUME_PER_SECTOR) * sizeof(ResumeRecord);
+}
+inline bool rjRead(uint32_t slot, ResumeRecord& r) {
+  return esp_partition_read(g_rj.part, rjOffset(slot), &r, sizeof(r)) == ESP_OK && resumeValid(r);
+}
+inline bool rjSectorBlank(uint16_t sector) {
+  uint32_t buf[64];
+  for (size_t off = 0; off < RESUME_SECTOR; off += sizeof(buf)) {
+    if (esp_partition_read(g_rj.part, (size_t)sector * RESUME_SECTOR + off, buf, sizeof(buf)) != ESP_OK) return false;
+    for (uint32_t w : buf) if (w != 0xFFFFFFFFu) return false;
+  }
+  return true;
+}
+
+// Erase the sector the next write needs, if not done yet. Without `force`
+// only while the step ISR has a long enough gap.
+inline void rjPrepare(bool force) {
+  if (!g_rj.part || !g_rj.sectors) return;
+  uint16_t need = (uint16_t)(g_rj.head / RESUME_PER_SECTOR);
+  if (g_rj.head % RESUME_PER_SECTOR) need = (uint16_t)((need + 1) % g_rj.sectors);   // the one after this
+  if (g_rj.erased == need) return;
+  if (!force && stepGenQuietUs() < RESUME_ERASE_GAP_US) return;
+  if (esp_partition_erase_range(g_rj.part, (size_t)need * RESUME_SECTOR, RESUME_SECTOR) == ESP_OK) g_rj.erased = need;
+}
+
+inline bool rjAppend(ResumeRecord& r) {
+  if (!g_rj.part || !g_rj.sectors) return false;
+  const uint16_t sector = (uint16_t)(g_rj.head / RESUME_PER_SECTOR);
+  if (g_rj.head % RESUME_PER_SECTOR == 0 && g_rj.erased != sector) { g_rj.skipped++; return false; }
+  r.seq = ++g_rj.seq;
+  r.crc = resumeCrc(r);
+  if (esp_partition_write(g_rj.part, rjOffset(g_rj.head), &r, sizeof(r)) != ESP_OK) return false;
+  g_rj.head = (uint16_t)((g_rj.head + 1) % rjSlots());
+  return true;
+}
+
+// Newest record: newest sector by its first record, then along that sector.
+inline bool rjScan(ResumeRecord& newest) {
+  int16_t best = -1;
+  ResumeRecord r;
+  for (uint16_t s = 0; s < g_rj.sectors; ++s)
+    if (rjRead((uint32_t)s * RESUME_PER_SECTOR, r) && (best < 0 || (int32_t)(r.seq - newest.seq) > 0)) { best = (int16_t)s; newest = r; }
+  if (best < 0) { g_rj.head = 0; return false; }
+  uint32_t slot = (uint32_t)best * RESUME_PER_SECTOR;
+  for (uint32_t i = 1; i < RESUME_PER_SECTOR && rjRead(slot + i, r) && (int32_t)(r.seq - newest.seq) > 0; ++i) newest = r;
+  uint32_t i = 0;
+  while (i < RESUME_PER_SECTOR && rjRead(slot + i, r) && r.seq <= newest.seq) ++i;
+  g_rj.head = (uint16_t)((slot + i) % rjSlots());
+  g_rj.seq = newest.seq;
+  return true;
+}
+
+// ---------- checkpoints ----------
+inline void resumeCapture(ResumeRecord& r, uint8_t kind) {
+  r = ResumeRecord();
+  r.magic = RESUME_MAGIC; r.kind = kind; r.axes = MOTION_AXES;
+  r.jobSeq = g_rj.jobSeq;
+  portENTER_CRITICAL(&g_stepMux);
+  const uint16_t cur = plan.cur;
+  r.seg = (uint16_t)(cur >= plan.entry ? cur - plan.entry : 0);
+  r.loopsDone = plan.loopsDone;
+  if (plan.segLeft) r.segDone = planSegTicks(plan.seg[cur]) - plan.segLeft;
+  else              r.segDone = (micros() - g_dwellStartUs) / 1000;
+  for (uint8_t a = 0; a < MOTION_AXES; ++a) r.pos[a] = g_axisPos[a];
+  portEXIT_CRITICAL(&g_stepMux);
+  r.raw = encoderIsPresent() ? readRawAngle() : 0xFFFF;
+  r.elapsedMs = millis() - g_rj.startMs;
+}
+
+inline void resumeTick(void*);
+inline float resumeOfferProgress();
+
+inline void resumeBegin() {
+  if (g_rj.ready) return;
+  g_rj.ready = true;
+  g_rj.part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "resume");
+  g_rj.sectors = g_rj.part ? (uint16_t)(g_rj.part->size / RESUME_SECTOR) : 0;
+
+  ResumeRecord last;
+  bool have = g_rj.sectors && rjScan(last);
+  if (g_rj.sectors && rjSectorBlank((uint16_t)(g_rj.head / RESUME_PER_SECTOR)) && g_rj.head % RESUME_PER_SECTOR == 0)
+    g_rj.erased = (int16_t)(g_rj.head / RESUME_PER_SECTOR);
+  // RTC copy: newer when the reset came between flash writes
+  if (resumeValid(g_resumeRtc) && (!have || (int32_t)(g_resumeRtc.seq - last.seq) > 0)) { last = g_resumeRtc; have = true; }
+  if (have && (int32_t)(last.seq - g_rj.seq) > 0) g_rj.seq = last.seq;
+
+  if (have && last.kind == RK_CHECKPOINT) {
+    for (uint8_t i = 0; i < planCacheCount(); ++i)
+      if (planCacheEntry(i).seq == last.jobSeq) { g_rj.cp = last; g_rj.cacheIdx = i; g_rj.state = RS_OFFER; break; }
+    if (g_rj.state == RS_OFFER) resumeOfferProgress();
+  }
+  esp_timer_create_args_t args = {};
+  args.callback = &resumeTick;
+  args.name = "resume";
+  if (esp_timer_create(&args, &g_rj.timer) == ESP_OK) esp_timer_start_periodic(g_rj.timer, RESUME_TICK_MS * 1000ULL);
+}
+
+// Forget the interrupted job.
+inline void resumeDiscard() {
+  if (g_rj.state != RS_OFFER) return;
+  g_rj.state = RS_IDLE;
+  ResumeRecord r = g_rj.cp;
+  r.kind = RK_DONE;
+  rjPrepare(true);
+  rjAppend(r);
+  g_resumeRtc = r;
+  frec(FR_RESUME, 0, g_rj.cp.seg, 0);
+}
+
+// Called by jobRun() and planCacheReplay() just before the plan starts.
+void resumeArm();
+
+inline void resumeWrite(uint8_t kind, bool flash) {
+  ResumeRecord r;
+  resumeCapture(r, kind);
+  if (flash) rjAppend(r);
+  else { r.seq = g_rj.seq + 1; r.crc = resumeCrc(r); }
+  g_resumeRtc = r;
+}
+
+inline void resumeContinue();
+
+// Runs in the esp_timer task.
+inline void resumeTick(void*) {
+  ResumeJournal& j = g_rj;
+  if (j.state == RS_SEEKING) {
+    if (plan.active) return;
+    if (plan.stepsDone >= plan.totalSteps) resumeContinue();
+    else j.state = RS_OFFER;                 // seek was stopped
+    return;
+  }
+  if (!j.jobSeq) return;
+  if (!plan.active) {
+    if (j.wasActive) {                       // finished or stopped: nothing to resume
+      resumeWrite(RK_DONE, true);
+      j.jobSeq = 0;
+      j.wasActive = false;
+    }
+    return;
+  }
+  j.wasActive = true;
+  if (plan.cur < plan.entry) return;         // still positioning
+  // the encoder only resolves a single turn: keep flash checkpoints closer
+  const uint32_t now = millis();
+  const int32_t pos = g_axisPos[AXIS_SLIDE];
+  const bool flash = now - j.lastFlashMs >= RESUME_FLASH_MS
+                  || abs(pos - j.lastFlashPos) >= scaleCountsToSteps(1024);
+  resumeWrite(RK_CHECKPOINT, flash);
+  if (flash) { j.lastFlashMs = now; j.lastFlashPos = pos; }
+  rjPrepare(false);
+}
+
+// ---------- resuming ----------
+// Rebuild the cached plan body into `plan` (no positioning prefix).
+inline bool resumeDecode(PlanCacheHeader& h) {
+  if (!planCacheReady() || g_rj.cacheIdx >= planCacheCount()) return false;
+  const uint8_t slot = planCacheEntry(g_rj.cacheIdx).slot;
+  if (!pcReadHeader(slot, h) || h.seq != g_rj.cp.jobSeq) return false;
+  if (fabsf(h.stepsPerMM - stepsPerMM()) > 1e-3f) return false;      // rig rescaled since
+  uint8_t* buf = pcBuf();
+  if (!buf || esp_partition_read(g_pcPart, (size_t)slot * PLAN_CACHE_SLOT_SIZE + sizeof(h),
+                                 buf, h.codeLen) != ESP_OK) return false;
+  if (pcCrc32(buf, h.codeLen, pcSpecCrc(h.spec)) != h.crc) return false;
+  planReset();
+  planMarkEntry(h.entrySteps);
+  planBeginLoop();
+  if (!planDecodeAppend(buf, h.codeLen)) { planReset(); return false; }
+  planFinalize(h.loops);
+  return g_rj.cp.seg < plan.count;
+}
+
+inline bool  resumePending()  { resumeBegin(); return g_rj.state == RS_OFFER; }
+inline ResumeState resumeState() { return g_rj.state; }
+inline float resumeProgress() { return g_rj.progress; }
+
+// Where the slide really is: the checkpoint plus the encoder's travel since,
+// taken in a window leaning three quarters into the direction of motion.
+inline int32_t resumeSeat(int8_t dir) {
+  const ResumeRecord& cp = g_rj.cp;
+  if (cp.raw == 0xFFFF || !encoderIsPresent()) return cp.pos[AXIS_SLIDE];
+  int32_t d = (int32_t)readRawAngle() - cp.raw;
+  const int32_t lo = dir > 0 ? -1024 : (dir < 0 ? -3071 : -2047);
+  while (d < lo)        d += 4096;
+  while (d >= lo + 4096) d -= 4096;
+  return cp.pos[AXIS_SLIDE] + scaleCountsToSteps(d);
+}
+
+// Re-seat, then move back to the checkpoint; the tick takes over from there.
+inline bool resumeStart() {
+  if (g_rj.state != RS_OFFER || motionBusy()) return false;
+  jobArenaReset();
+  {
+    PcHeaderLease h(g_pcHdrPool);
+    if (!h || !resumeDecode(*h)) return false;
+  }
+  const PlanSegment& s = plan.seg[g_rj.cp.seg];
+  const int8_t dir = s.steps[AXIS_SLIDE] > 0 ? 1 : (s.steps[AXIS_SLIDE] < 0 ? -1 : 0);
+
+  const int32_t seated = resumeSeat(dir);
+  g_rj.seatSteps = seated - g_rj.cp.pos[AXIS_SLIDE];
+  g_axisPos[AXIS_SLIDE] = seated;
+  for (uint8_t a = 1; a < MOTION_AXES; ++a) g_axisPos[a] = g_rj.cp.pos[a];   // no sensor: trust the checkpoint
+  frec(FR_RESUME, 1, g_rj.cp.seg, g_rj.seatSteps);
+
+  int32_t d[MOTION_AXES];
+  for (uint8_t a = 0; a < MOTION_AXES; ++a) d[a] = g_rj.cp.pos[a] - g_axisPos[a];
+  planReset();
+  if (planAddMoveAxes(d, 1e6f / usPerStepForPercent(JOB_REHOME_PCT)) != PLAN_OK) return false;
+  planFinalize(1);
+  g_rj.state = RS_SEEKING;
+  if (plan.count == 0) { resumeContinue(); return true; }
+  if (!planStart()) { g_rj.state = RS_OFFER; return false; }
+  return true;
+}
+
+// At the checkpoint: restart the cached plan where it was.
+inline void resumeContinue() {
+  ResumeJournal& j = g_rj;
+  {
+    PcHeaderLease h(g_pcHdrPool);
+    if (!h || !resumeDecode(*h)) { j.state = RS_OFFER; return; }
+    g_job = h->spec;
+    g_pcLastSeq = h->seq;
+  }
+  g_jobLoaded = true;
+  settleReset();
+  resumeArm();
+  j.startMs -= j.cp.elapsedMs;
+  if (!planStartAt(j.cp.seg, j.cp.loopsDone, j.cp.segDone)) { j.jobSeq = 0; j.state = RS_OFFER; return; }
+  plan.startedMs -= j.cp.elapsedMs;
+  j.state = RS_IDLE;
+}
+
+// Share of the interrupted job already done (for the offer).
+inline float resumeOfferProgress() {
+  if (g_rj.state != RS_OFFER || motionBusy()) return 0.0f;
+  {
+    PcHeaderLease h(g_pcHdrPool);
+    if (!h || !resumeDecode(*h)) return 0.0f;
+  }
+  uint64_t before = 0, body = 0;
+  for (uint16_t i = 0; i < plan.count; ++i) {
+    const uint32_t n = planSegTicks(plan.seg[i]);
+    if (i < g_rj.cp.seg) before += n;
+    if (i >= plan.loopStart && i < plan.loopEnd) body += n;
+  }
+  const uint64_t done = before + body * g_rj.cp.loopsDone + (plan.seg[g_rj.cp.seg].dwellMs ? 0 : g_rj.cp.segDone);
+  g_rj.progress = plan.totalSteps ? min(1.0f, (float)done / plan.totalSteps) : 0.0f;
+  planReset();
+  return g_rj.progress;
+}
+
+// GET /api/resume → {"state":"offer","job":"Lapse 120 shots","progress":0.43,..}
+inline void resumeStatusJson(HttpResponse& r) {
+  const ResumeJournal& j = g_rj;
+  char label[32] = "";
+  if (j.state != RS_IDLE && j.cacheIdx < planCacheCount()) planCacheLabel(planCacheEntry(j.cacheIdx), label, sizeof(label));
+  r.type = "application/json";
+  r.add("{\"state\":\"").add(j.state == RS_OFFER ? "offer" : j.state == RS_SEEKING ? "seeking" : "idle")
+   .add("\",\"job\":\"").add(label)
+   .add("\",\"progress\":").add(j.progress, 3)
+   .add(",\"elapsedS\":").add((long)(j.cp.elapsedMs / 1000))
+   .add(",\"armed\":").add(j.jobSeq ? "true" : "false")
+   .add(",\"skipped\":").add((long)j.skipped)
+   .add(",\"seatSteps\":").add((long)j.seatSteps).add("}");
+}
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef RESUME_SCREEN_H
+#define RESUME_SCREEN_H
+
+#include "wizard_ui.h"
+#include "ui_helpers.h"
+#include "rotary_input.h"
+#include "control.h"
+
+// Offered at boot when a job was cut off by a reset or power loss
+// (resume.h). OK moves back to where it stopped and carries on, showing
+// progress until it ends; Back forgets it. Back/OK during the run stops.
+inline void openResumeScreen() {
+  if (!resumePending()) return;
+  char label[32] = "Job";
+  if (g_rj.cacheIdx < planCacheCount()) planCacheLabel(planCacheEntry(g_rj.cacheIdx), label, sizeof(label));
+  char l2[24];
+  snprintf(l2, sizeof(l2), "%.16s %d%%", label, (int)(resumeProgress() * 100.0f));
+  wizardFrameStart("Resume");
+  wizardCenterTwo("Resume job?", l2);
+
+  while (true) {
+    updateRotary();
+    if (isBackPressed() || isBackPressedLong()) { ctlResume(false); return; }
+    if (isSelectPressed()) {
+      if (ctlResume(true) == CTL_OK) break;
+      wizardCenterTwo("Resume job?", "Cannot resume");
+    }
+    idleDimmerTick();
+    delay(10);
+  }
+
+  int lastPct = -1;
+  bool seeking = true;
+  while (resumeState() == RS_SEEKING || planRunning()) {
+    const bool nowSeeking = resumeState() == RS_SEEKING;
+    const int pct = nowSeeking || !plan.totalSteps ? 0 : (int)((uint64_t)plan.stepsDone * 100 / plan.totalSteps);
+    if (pct != lastPct || nowSeeking != seeking) {
+      wizardFrameStart("Stop");
+      if (nowSeeking) wizardCenterTwo("Resume job", "Returning...");
+      else            drawCenteredProgress(pct);
+      lastPct = pct; seeking = nowSeeking;
+    }
+    updateRotary();
+    if (isSelectPressed() || isBackPressed()) { ctlStop(); break; }
+    settleTick();
+    idleDimmerTick();
+    delay(10);
+  }
+}
+
+#endif
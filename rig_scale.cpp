@@ -0,0 +1,4 @@
+// Derived rig scale.
+#include "rig_scale.h"
+
+RigScale g_scale;
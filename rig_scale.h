@@ -0,0 +1,70 @@
+#ifndef RIG_SCALE_H
+#define RIG_SCALE_H
+
+// Slide scale factors, worked out once from runtimeState (and the encoder
+// calibration from scale_calib.h, when there is one) and cached, so the
+// planner, status and encoder paths never redo the float maths. The active
+// payload's tuned speed/accel (speed_tune.h) is turned into step limits on
+// the slide axis here too. Call scaleRefresh() after changing
+// microstep/pulley/belt/calibration/payload.
+
+#include <Arduino.h>
+#include "eeprom_utils.h"
+#include "motor_control.h"
+
+struct RigScale {
+  bool     ready            = false;
+  bool     calibrated       = false;
+  float    stepsPerMM       = 1.0f;   // planner maths stays float
+  uint32_t stepsPerMMQ16    = 0;      // microsteps per mm, Q16.16
+  uint32_t umPerStepQ16     = 0;      // micrometres per microstep, Q16.16
+  uint32_t stepsPerCountQ16 = 0;      // microsteps per AS5600 count, Q16.16
+  uint16_t backlashSteps    = 0;      // lost motion on reversal
+  bool     tuned            = false;  // slide limits come from a payload profile
+};
+extern RigScale g_scale;
+
+inline void scaleRefresh() {
+  const float mmPerRev = max(1.0f, runtimeState.pulley_teeth * runtimeState.belt_pitch_mm);
+  float stepsPerRev = (float)runtimeState.steps_per_rev * runtimeState.microstep;
+
+  g_scale.calibrated = runtimeState.calStepsPerCountQ16 != 0;
+  if (g_scale.calibrated) stepsPerRev = runtimeState.calStepsPerCountQ16 * (4096.0f / 65536.0f);
+
+  g_scale.stepsPerMM       = stepsPerRev / mmPerRev;
+  g_scale.stepsPerMMQ16    = (uint32_t)lroundf(g_scale.stepsPerMM * 65536.0f);
+  g_scale.umPerStepQ16     = (uint32_t)lroundf(1000.0f / g_scale.stepsPerMM * 65536.0f);
+  g_scale.stepsPerCountQ16 = (uint32_t)lroundf(stepsPerRev / 4096.0f * 65536.0f);
+  g_scale.backlashSteps    = g_scale.calibrated ? runtimeState.calBacklashSteps : 0;
+
+  const SlideLimits& lim = runtimeState.limits[min<uint8_t>(runtimeState.payload, TUNE_PROFILES - 1)];
+  g_scale.tuned = lim.maxMmS > 0.0f && lim.accelMmS2 > 0.0f;
+  AxisConfig& slide = g_axes[AXIS_SLIDE];
+  if (g_scale.tuned) {
+    const float us = 1e6f / (lim.maxMmS * g_scale.stepsPerMM);
+    slide.minUsPerStep = (uint32_t)ceilf(clampT(us, (float)MOTOR_FLOOR_US_PER_STEP, MOTOR_MAX_US_PER_STEP / 2.0f));
+    slide.accel        = lim.accelMmS2 * g_scale.stepsPerMM;
+  } else {
+    slide.minUsPerStep = MOTOR_MIN_US_PER_STEP;
+    slide.accel        = DEFAULT_ACCEL_SPS2;
+  }
+  g_scale.ready = true;
+}
+
+inline const RigScale& rigScale() {
+  if (!g_scale.ready) scaleRefresh();
+  return g_scale;
+}
+
+// ---------- fixed-point conversions ----------
+inline int32_t scaleCountsToSteps(int32_t counts) {
+  return (int32_t)(((int64_t)counts * rigScale().stepsPerCountQ16) >> 16);
+}
+inline int32_t scaleStepsToUm(int32_t steps) {
+  return (int32_t)(((int64_t)steps * rigScale().umPerStepQ16) >> 16);
+}
+inline int32_t scaleUmToSteps(int32_t um) {
+  return (int32_t)(((int64_t)um * rigScale().stepsPerMMQ16 / 1000) >> 16);
+}
+
+#endif
@@ -0,0 +1,15 @@
+// Encoder and button state.
+#include "rotary_input.h"
+
+volatile int    g_accumPos = 0;
+volatile int    g_stepDelta = 0;
+InputDecoder    g_input;
+bool            g_okLatched = false;
+bool            g_backLatched = false;
+bool            g_backLongLatched = false;
+
+#if INPUT_TRACE_LEN > 0
+InputSample     g_inputTrace[INPUT_TRACE_LEN];
+uint32_t        g_inputTraceHead = 0;
+uint8_t         g_inputTraceLast = 0xFF;
+#endif
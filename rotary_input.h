@@ -1,6 +1,7 @@
 #pragma once
 #include <Arduino.h>
 #include "config.h"
+#include "flight_recorder.h"
 
 // Map legacy names used by various modules to your finalized pins
 #define ROTARY_A_PIN   ROTARY_CLK_PIN   // KY-040 CLK
@@ -13,56 +14,40 @@ static const bool ROTARY_SW_ACTIVE_LOW = true;   // KY-040 switch is usually act
 static const bool BACK_BTN_ACTIVE_LOW  = true;
 
 // Debounce timings
-static const uint16_t DEBOUNCE_MS      = 15;
+static const uint16_t DEBOUNCE_MS      = 15;    // a button level must hold this long
 static const uint16_t LONG_PRESS_MS    = 650;
 
-// ----- Internal state -----
-static volatile int    g_accumPos = 0;      // running position for legacy getters
-static volatile int    g_stepDelta = 0;     // delta since last read
-static uint8_t         g_encState = 0;      // last 2-bit state
-static uint8_t         g_encHalf  = 0;      // half-step coalescer for detent=1
-
-// Button edge/hold tracking
-static bool            g_okPrev = false;
-static uint32_t        g_okLastChange = 0;
-static bool            g_backPrev = false;
-static uint32_t        g_backLastChange = 0;
-static bool            g_backLongLatched = false;
+// Quadrature transitions per detent: 2 for the common KY-040 (rests at 00
+// and 11), 4 for full-cycle encoders (rest at 11), 1 to count every edge.
+#ifndef ROTARY_STEPS_PER_DETENT
+  #define ROTARY_STEPS_PER_DETENT 2
+#endif
+// Raw samples kept for capturing traces (serial op INPUT); 0 = off
+#ifndef INPUT_TRACE_LEN
+  #define INPUT_TRACE_LEN 0
+#endif
 
 // Helpers
 inline bool phys_low(uint8_t pin){ return digitalRead(pin)==LOW;  }
 inline bool phys_high(uint8_t pin){ return digitalRead(pin)==HIGH; }
 
-// Read button raw with polarity
-inline bool read_ok_down(){
-  bool raw = digitalRead(ROTARY_SW_PIN)==LOW;
-  return ROTARY_SW_ACTIVE_LOW ? raw : !raw;
-}
-inline bool read_back_down(){
-  bool raw = digitalRead(BACK_BTN_PIN)==LOW;
-  return BACK_BTN_ACTIVE_LOW ? raw : !raw;
-}
+// ---------- Sample-driven decoder ----------
+// The decoder never touches pins or millis(); it is fed InputSample values.
+// handleRotary() samples the pins, and inputReplay() runs a recorded trace
+// through exactly the same code.
+enum InputBit : uint8_t { IN_B = 1, IN_A = 2, IN_OK = 4, IN_BACK = 8 };  // OK/BACK set = pressed
 
-// Public API expected by the rest of the app
-inline void inputInit(){
-  pinMode(ROTARY_A_PIN,  INPUT_PULLUP);
-  pinMode(ROTARY_B_PIN,  INPUT_PULLUP);
-  pinMode(ROTARY_SW_PIN, INPUT_PULLUP);
-  pinMode(BACK_BTN_PIN,  INPUT_PULLUP);
+struct InputSample {
+  uint32_t ms;
+  uint8_t  pins;     // InputBit
+};
 
-  // Initialize encoder state
-  uint8_t a = digitalRead(ROTARY_A_PIN);
-  uint8_t b = digitalRead(ROTARY_B_PIN);
-  g_encState = ((a?1:0) << 1) | (b?1:0);
-
-  g_accumPos = 0;
-  g_stepDelta = 0;
-  g_okPrev = false;
-  g_backPrev = false;
-  g_okLastChange = millis();
-  g_backLastChange = millis();
-  g_backLongLatched = false;
-}
+struct InputEvents {
+  int16_t detents   = 0;     // + = clockwise
+  uint8_t okPress   = 0;
+  uint8_t backPress = 0;
+  uint8_t backLong  = 0;
+};
 
 // Quadrature table: returns -1,0,+1 per transition
 static inline int8_t quadStep(uint8_t prev, uint8_t curr){
@@ -83,61 +68,157 @@ static inline int8_t quadStep(uint8_t prev, uint8_t curr){
   }
 }
 
-// Call this every loop() to update encoder/buttons
-inline void handleRotary(){
-  // --- Encoder ---
-  uint8_t a = digitalRead(ROTARY_A_PIN) ? 1 : 0;
-  uint8_t b = digitalRead(ROTARY_B_PIN) ? 1 : 0;
-  uint8_t curr = (a<<1) | b;
-
-  int8_t step = quadStep(g_encState, curr);
-  g_encState = curr;
-
-  // Coalesce 2 half-steps into one detent (typical KY-040 behavior)
-  if (step != 0){
-    g_encHalf += (step>0 ? 1 : 3); // 1 forward, 3 backward mod 4
-    g_encHalf &= 0x03;
-    // Only update on every 2 transitions (0 -> 2 -> 0)
-    // Simpler: accumulate raw transitions and only emit on even count
-    static int8_t rawSum=0;
-    rawSum += (step>0 ? 1 : -1);
-    if (abs(rawSum) >= 2){
-      int dir = (rawSum>0) ? +1 : -1;
-      g_accumPos += dir;
-      g_stepDelta += dir;
-      rawSum = 0;
-    }
+inline bool quadAtRest(uint8_t ab) {
+  if (ROTARY_STEPS_PER_DETENT >= 4) return ab == 3;
+  if (ROTARY_STEPS_PER_DETENT == 2) return ab == 0 || ab == 3;
+  return true;
+}
+
+// Level must be stable for DEBOUNCE_MS before it counts.
+struct Debouncer {
+  bool     state = false;
+  bool     raw   = false;
+  uint32_t since = 0;        // when raw last changed
+
+  void reset(bool v, uint32_t ms) { state = raw = v; since = ms; }
+  // true when the debounced state changes
+  bool feed(bool v, uint32_t ms) {
+    if (v != raw) { raw = v; since = ms; }
+    if (raw != state && ms - since >= DEBOUNCE_MS) { state = raw; return true; }
+    return false;
   }
+};
 
-  // --- OK button (edge + debounce) ---
-  bool nowOK = read_ok_down();
-  uint32_t ms = millis();
-  if (nowOK != g_okPrev){
-    if ((ms - g_okLastChange) > DEBOUNCE_MS){
-      g_okPrev = nowOK;
-      g_okLastChange = ms;
-    }
+struct InputDecoder {
+  uint8_t   ab      = 3;
+  int8_t    sub     = 0;     // transitions since the last rest position
+  int8_t    lastDir = 0;
+  Debouncer ok, back;
+  bool      longSent = false;
+
+  void reset(const InputSample& s) {
+    ab = s.pins & (IN_A | IN_B); sub = 0; lastDir = 0;
+    ok.reset(s.pins & IN_OK, s.ms);
+    back.reset(s.pins & IN_BACK, s.ms);
+    longSent = back.state;   // held through boot: no long press
   }
 
-  // --- BACK button (edge + debounce + long) ---
-  bool nowBK = read_back_down();
-  if (nowBK != g_backPrev){
-    if ((ms - g_backLastChange) > DEBOUNCE_MS){
-      g_backPrev = nowBK;
-      g_backLastChange = ms;
-      if (!nowBK){
-        // released: clear long latch after release
-        g_backLongLatched = false;
-      }
-    }
-  }else{
-    // held logic for long-press
-    if (nowBK && !g_backLongLatched){
-      if ((ms - g_backLastChange) >= LONG_PRESS_MS){
-        g_backLongLatched = true; // will report true once and then latch
+  void feed(const InputSample& s, InputEvents& ev) {
+    const uint8_t cur = s.pins & (IN_A | IN_B);
+    if (cur != ab) {
+      int8_t st = quadStep(ab, cur);
+      if (st == 0) st = (int8_t)(2 * lastDir);   // both lines moved: a sample was missed
+      else         lastDir = st;
+      sub += st;
+      ab = cur;
+      // Count whole detents only at a rest position, then resync there, so
+      // contact bounce and half turns can't drift the phase.
+      if (quadAtRest(cur)) {
+        ev.detents += sub / ROTARY_STEPS_PER_DETENT;
+        sub = 0;
       }
     }
+
+    if (ok.feed(s.pins & IN_OK, s.ms) && ok.state) ev.okPress++;
+    if (back.feed(s.pins & IN_BACK, s.ms) && back.state) { ev.backPress++; longSent = false; }
+    if (back.state && !longSent && s.ms - back.since >= LONG_PRESS_MS) { longSent = true; ev.backLong++; }
+  }
+};
+
+// Run a recorded trace through a fresh decoder.
+inline InputEvents inputReplay(const InputSample* s, size_t n) {
+  InputEvents ev;
+  if (n == 0) return ev;
+  InputDecoder d;
+  d.reset(s[0]);
+  for (size_t i = 1; i < n; ++i) d.feed(s[i], ev);
+  return ev;
+}
+
+// ----- Internal state -----
+extern volatile int    g_accumPos;    // running position for legacy getters
+extern volatile int    g_stepDelta;   // delta since last read
+extern InputDecoder    g_input;
+
+// Press latches; an unconsumed press is dropped when the button is released
+extern bool            g_okLatched;
+extern bool            g_backLatched;
+extern bool            g_backLongLatched;
+
+#if INPUT_TRACE_LEN > 0
+extern InputSample     g_inputTrace[INPUT_TRACE_LEN];
+extern uint32_t        g_inputTraceHead;   // samples recorded
+extern uint8_t         g_inputTraceLast;
+inline void inputTraceRecord(const InputSample& s) {
+  if (s.pins == g_inputTraceLast) return;        // changes only
+  g_inputTraceLast = s.pins;
+  g_inputTrace[g_inputTraceHead++ % INPUT_TRACE_LEN] = s;
+}
+inline uint16_t inputTraceCount() { return (uint16_t)min<uint32_t>(g_inputTraceHead, INPUT_TRACE_LEN); }
+// idx 0 = oldest kept
+inline InputSample inputTraceAt(uint16_t idx) {
+  return g_inputTrace[(g_inputTraceHead - inputTraceCount() + idx) % INPUT_TRACE_LEN];
+}
+#else
+inline void inputTraceRecord(const InputSample&) {}
+inline uint16_t inputTraceCount() { return 0; }
+inline InputSample inputTraceAt(uint16_t) { return InputSample{0, 0}; }
+#endif
+
+// Read button raw with polarity
+inline bool read_ok_down(){
+  bool raw = digitalRead(ROTARY_SW_PIN)==LOW;
+  return ROTARY_SW_ACTIVE_LOW ? raw : !raw;
+}
+inline bool read_back_down(){
+  bool raw = digitalRead(BACK_BTN_PIN)==LOW;
+  return BACK_BTN_ACTIVE_LOW ? raw : !raw;
+}
+
+inline InputSample inputSamplePins(){
+  InputSample s;
+  s.ms   = millis();
+  s.pins = (digitalRead(ROTARY_A_PIN) ? IN_A : 0) | (digitalRead(ROTARY_B_PIN) ? IN_B : 0)
+         | (read_ok_down() ? IN_OK : 0) | (read_back_down() ? IN_BACK : 0);
+  return s;
+}
+
+// Public API expected by the rest of the app
+inline void inputInit(){
+  pinMode(ROTARY_A_PIN,  INPUT_PULLUP);
+  pinMode(ROTARY_B_PIN,  INPUT_PULLUP);
+  pinMode(ROTARY_SW_PIN, INPUT_PULLUP);
+  pinMode(BACK_BTN_PIN,  INPUT_PULLUP);
+
+  const InputSample s = inputSamplePins();
+  g_input.reset(s);
+  inputTraceRecord(s);
+
+  g_accumPos = 0;
+  g_stepDelta = 0;
+  g_okLatched = false;
+  g_backLatched = false;
+  g_backLongLatched = false;
+}
+
+// Call this every loop() to update encoder/buttons
+inline void handleRotary(){
+  const InputSample s = inputSamplePins();
+  inputTraceRecord(s);
+  InputEvents ev;
+  g_input.feed(s, ev);
+
+  if (ev.detents){
+    g_accumPos += ev.detents;
+    g_stepDelta += ev.detents;
+    for (int16_t n = ev.detents; n != 0; n += (n > 0 ? -1 : 1))
+      frec(FR_INPUT, ev.detents > 0 ? FRI_CW : FRI_CCW);
   }
+  if (ev.okPress)  { g_okLatched = true;       frec(FR_INPUT, FRI_OK); }
+  if (ev.backPress){ g_backLatched = true;     frec(FR_INPUT, FRI_BACK); }
+  if (ev.backLong) { g_backLongLatched = true; frec(FR_INPUT, FRI_BACK_LONG); }
+  if (!g_input.ok.state)   g_okLatched = false;
+  if (!g_input.back.state) { g_backLatched = false; g_backLongLatched = false; }
 }
 
 // Read and clear delta (preferred by menus to move one per detent)
@@ -151,36 +232,18 @@ inline int getEncoderDelta(){
 inline int getRotaryDelta(){ return getEncoderDelta(); }
 inline int getRotaryPosition(){ return g_accumPos; }
 
-// Buttons
+// Buttons: each debounced press is reported once (handleRotary() must run)
 inline bool isSelectPressed(){
-  static bool prevReported=false;
-  bool down = read_ok_down();
-  bool edge = false;
-  // positive edge (press)
-  if (down && !prevReported){
-    // ensure it’s stable per debounce
-    if ((millis() - g_okLastChange) > DEBOUNCE_MS){
-      edge = true;
-      prevReported = true;
-    }
-  }
-  if (!down) prevReported=false;
-  return edge;
+  if (!g_okLatched) return false;
+  g_okLatched = false;
+  return true;
 }
 
 // Short back press: return true on press edge
 inline bool isBackPressed(){
-  static bool prevRep=false;
-  bool down = read_back_down();
-  bool edge=false;
-  if (down && !prevRep){
-    if ((millis() - g_backLastChange) > DEBOUNCE_MS){
-      edge = true;
-      prevRep = true;
-    }
-  }
-  if (!down) prevRep=false;
-  return edge;
+  if (!g_backLatched) return false;
+  g_backLatched = false;
+  return true;
 }
 
 // Long back press (some screens might still call this)
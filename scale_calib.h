@@ -0,0 +1,128 @@
+#ifndef SCALE_CALIB_H
+#define SCALE_CALIB_H
+
+// Scale calibration: command known step counts, measure them on the AS5600
+// and store microsteps per encoder count plus the lost motion on reversal.
+// A stored microstep setting that disagrees with the driver is corrected
+// when the measurement lands clearly on another power of two. Belt pitch
+// and pulley teeth still give mm per revolution (rig_scale.h).
+
+#include <Arduino.h>
+#include "config.h"
+#include "encoder_utils.h"
+#include "motion_plan.h"
+#include "step_generator.h"
+#include "rig_scale.h"
+#include "eeprom_utils.h"
+#include "wizard_ui.h"
+
+#ifndef SCALE_CAL_REVS
+  #define SCALE_CAL_REVS   1       // motor revolutions per measured move
+#endif
+#ifndef SCALE_CAL_REST_MS
+  #define SCALE_CAL_REST_MS 150    // let the carriage stop before the last read
+#endif
+
+struct ScaleCalResult {
+  bool     ok               = false;
+  float    stepsPerCount    = 0;
+  uint16_t backlashSteps    = 0;
+  uint16_t oldMicrostep     = 0;   // != microstep when it was corrected
+  uint16_t microstep        = 0;
+};
+
+// Move `steps` slowly, tracking the encoder; returns unwrapped travel in counts.
+inline bool scaleCalMove(int32_t steps, int32_t& counts) {
+  planReset();
+  if (planAddMoveAtRate(steps, 4.0f * planMinRate()) != PLAN_OK) return false;
+  planFinalize(1);
+  uint16_t prev = readRawAngle();
+  counts = 0;
+  if (!planStart()) return false;
+  while (plan.active) {
+    delay(5);
+    uint16_t raw = readRawAngle();
+    counts += encoderRawDelta(prev, raw);
+    prev = raw;
+  }
+  delay(SCALE_CAL_REST_MS);
+  counts += encoderRawDelta(prev, readRawAngle());
+  return true;
+}
+
+inline ScaleCalResult scaleCalibrate() {
+  ScaleCalResult r;
+  encoderInit();
+  if (!encoderIsPresent()) return r;
+
+  // nominal steps; the measurement tolerates a wrong microstep setting
+  const int32_t n    = (int32_t)runtimeState.steps_per_rev * runtimeState.microstep * SCALE_CAL_REVS;
+  const int32_t take = n / 8;
+  int32_t c0, c1, c2, c3;
+
+  if (!scaleCalMove(take, c0)) return r;    // take up slack in +
+  if (!scaleCalMove(n, c1))    return r;    // clean forward move
+  if (!scaleCalMove(-n, c2))   return r;    // reversal loses the backlash
+  if (!scaleCalMove(-take, c3)) return r;   // back to the start
+  if (abs(c1) < 64) return r;               // encoder not following the motor
+
+  const float k = (float)n / abs(c1);
+  const float lost = n - abs(c2) * k;
+  r.stepsPerCount = k;
+  r.backlashSteps = lost > 0 ? (uint16_t)min(65535.0f, roundf(lost)) : 0;
+
+  // snap the stored microstep to what the driver is evidently doing
+  r.oldMicrostep = r.microstep = runtimeState.microstep;
+  const float ms = 4096.0f * k / runtimeState.steps_per_rev;
+  for (uint16_t p = 1; p <= 256; p <<= 1) {
+    if (fabsf(ms / p - 1.0f) < 0.04f) { r.microstep = p; break; }
+  }
+
+  runtimeState.microstep           = r.microstep;
+  setMicrostepping(r.microstep);
+  runtimeState.calStepsPerCountQ16 = (uint32_t)lroundf(k * 65536.0f);
+  runtimeState.calBacklashSteps    = r.backlashSteps;
+  eepromSaveRuntime();
+  scaleRefresh();
+  r.ok = true;
+  return r;
+}
+
+// ---------- screen ----------
+inline void runScaleCalibration() {
+  wizardFrameStart("Start");
+  wizardCenterTwo("Scale calibration", "Needs 50mm free, OK");
+  while (true) {
+    updateRotary();
+    if (isSelectPressed()) break;
+    if (isBackPressed()) return;
+    idleDimmerTick();
+    delay(10);
+  }
+
+  wizardFrameStart("OK");
+  wizardCenterTwo("Scale calibration", "Measuring...");
+  ScaleCalResult r = scaleCalibrate();
+
+  char l1[24], l2[24];
+  if (!r.ok) {
+    snprintf(l1, sizeof(l1), "Scale calibration");
+    snprintf(l2, sizeof(l2), "%s", encoderIsPresent() ? "No encoder motion" : "No encoder");
+  } else if (r.microstep != r.oldMicrostep) {
+    snprintf(l1, sizeof(l1), "Microstep %u -> %u", r.oldMicrostep, r.microstep);
+    snprintf(l2, sizeof(l2), "Backlash %u steps", r.backlashSteps);
+  } else {
+    snprintf(l1, sizeof(l1), "%.3f steps/count", r.stepsPerCount);
+    snprintf(l2, sizeof(l2), "Backlash %u steps", r.backlashSteps);
+  }
+  wizardFrameStart("OK");
+  wizardCenterTwo(l1, l2);
+  while (true) {
+    updateRotary();
+    if (isSelectPressed() || isBackPressed()) return;
+    idleDimmerTick();
+    delay(10);
+  }
+}
+
+#endif
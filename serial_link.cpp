@@ -0,0 +1,14 @@
+// Serial link buffers and subscription state.
+#include "serial_link.h"
+
+uint8_t  g_slRx[SERIAL_LINK_RX_MAX];
+size_t   g_slRxLen    = 0;
+bool     g_slOverflow = false;
+uint16_t g_slBadFrames = 0;
+uint8_t  g_slTx[SERIAL_LINK_TX_MAX];
+size_t   g_slTxLen = 0;
+uint8_t  g_slTxEnc[SERIAL_LINK_TX_MAX + SERIAL_LINK_TX_MAX / 254 + 2];
+MemStatic g_slMem("serial", sizeof(g_slRx) + sizeof(g_slTx) + sizeof(g_slTxEnc));
+uint16_t g_slSubMs = 0;
+uint32_t g_slSubLast = 0;
+uint8_t  g_slTelSeq = 0;
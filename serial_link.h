@@ -0,0 +1,408 @@
+#ifndef SERIAL_LINK_H
+#define SERIAL_LINK_H
+
+// Binary control protocol on the USB serial port, for driving the slider
+// from a host script. Frames are COBS-encoded and 0x00-delimited; decoded,
+// a frame is
+//   type u8 | seq u8 | payload ... | crc16 LE (CCITT-FALSE over type..payload)
+// Replies echo seq with type|0x80 and payload[0] = CtlStatus; telemetry
+// pushes are type 0xC0. Fields are little-endian. tools/slidectl.py is the
+// host side.
+//
+//   0x01 PING                          -> u8 version, u8 axes, u16 bad frames
+//   0x10 MOVE   f32 mm, u8 pct         absolute slide position (pct 0 = current)
+//   0x11 JOG    f32 mm
+//   0x12 STOP
+//   0x13 DRIVE  i8 pct (-100..100, 0 = stop)  velocity drive; repeat within 300 ms
+//   0x14 TAKE   u8 cmd (0 stop, 1 record, 2 play, 0xFF status), [f32 scale]
+//                                      -> u8 state, u32 ms, u32 bytes, u16 progress/1000
+//   0x15 CRAWL  f32 mm/h (signed, 0 = stop), [f32 mm (0 = to the end)]
+//   0x16 RESUME u8 cmd (0 discard, 1 resume, 0xFF status)
+//                                      -> u8 state, u16 progress/1000, u32 elapsed s
+//   0x20 JOB    u8 flags (1 = dry), job JSON or binary
+//                                      -> u16 segments, u32 steps, u32 etaMs | error text
+//                                      dry -> the same, then u16 violations (JC_*),
+//                                         u8 peak rate %, u8 peak accel %, u16 leg,
+//                                         u32 legMs, u32 legMinMs, error text
+//   0x21 STATUS                        -> telemetry record
+//   0x30 SET    u8 key, i32 value
+//   0x31 GET    u8 key                 -> i32 value
+//   0x32 SAVE                          settings to EEPROM
+//   0x40 SUB    u16 periodMs (0 = off) telemetry pushes
+//   0x50 LOG    u8 rec, u16 from       flight recorder page (rec 0 = live ring)
+//                                      -> u8 reset, u32 boots, u16 count, u16 from,
+//                                         u8 n, n x {u32 us, u8 type, u8 a8, u16 a16, i32 val}
+//   0x51 BOOT                          -> u32 menuUs, u32 motionUs, u8 n,
+//                                         n x {u32 us, u8 len, name}
+//   0x52 INPUT  u16 from               raw input trace page (INPUT_TRACE_LEN > 0)
+//                                      -> u16 count, u16 from, u8 n, n x {u32 ms, u8 pins}
+//
+// Telemetry record: u8 state, u16 seg, u16 loop, u32 steps, u32 total,
+// i32 slide um, then i32 centidegrees per pan/tilt axis.
+
+#include <Arduino.h>
+#include "config.h"
+#include "control.h"
+#include "rig_scale.h"
+#include "flight_log.h"
+#include "boot.h"
+#include "rotary_input.h"
+
+#ifndef SERIAL_LINK_BAUD
+  #define SERIAL_LINK_BAUD 921600   // ignored by native USB CDC
+#endif
+#ifndef SERIAL_LINK_RX_MAX
+  #define SERIAL_LINK_RX_MAX 1280   // encoded frame; fits a 1 KB job body
+#endif
+#define SERIAL_LINK_TX_MAX 200    // fits a 15-event log page
+#define SERIAL_LINK_VERSION 1
+
+enum SerialLinkOp : uint8_t {
+  SL_PING = 0x01,
+  SL_MOVE = 0x10, SL_JOG = 0x11, SL_STOP = 0x12, SL_DRIVE = 0x13, SL_TAKE = 0x14, SL_CRAWL = 0x15, SL_RESUME = 0x16,
+  SL_JOB  = 0x20, SL_STATUS = 0x21,
+  SL_SET  = 0x30, SL_GET = 0x31, SL_SAVE = 0x32,
+  SL_SUB  = 0x40,
+  SL_LOG  = 0x50, SL_BOOT = 0x51, SL_INPUT = 0x52,
+  SL_REPLY = 0x80, SL_TELEMETRY = 0xC0,
+};
+
+enum SerialLinkKey : uint8_t {
+  SLK_SPEED_PCT = 1, SLK_PAUSE_MS, SLK_SETTLE_MS, SLK_SETTLE_COUNTS,
+  SLK_CURRENT_MA, SLK_MICROSTEP, SLK_ACCEL, SLK_PAYLOAD,
+};
+
+extern uint8_t  g_slRx[SERIAL_LINK_RX_MAX];
+extern size_t   g_slRxLen;
+extern bool     g_slOverflow;   // drop bytes until the next delimiter
+extern uint16_t g_slBadFrames;
+extern uint8_t  g_slTx[SERIAL_LINK_TX_MAX];
+extern size_t   g_slTxLen;
+extern uint8_t  g_slTxEnc[SERIAL_LINK_TX_MAX + SERIAL_LINK_TX_MAX / 254 + 2];
+extern uint16_t g_slSubMs;
+extern uint32_t g_slSubLast;
+extern uint8_t  g_slTelSeq;
+
+// ---------- framing ----------
+inline uint16_t slCrc16(const uint8_t* p, size_t n) {
+  uint16_t c = 0xFFFF;
+  while (n--) {
+    c ^= (uint16_t)(*p++) << 8;
+    for (uint8_t k = 0; k < 8; ++k) c = (c & 0x8000) ? (uint16_t)((c << 1) ^ 0x1021) : (uint16_t)(c << 1);
+  }
+  return c;
+}
+
+inline size_t cobsEncode(const uint8_t* in, size_t n, uint8_t* out) {
+  size_t w = 1, codeAt = 0;
+  uint8_t code = 1;
+  for (size_t i = 0; i < n; ++i) {
+    if (in[i] == 0) { out[codeAt] = code; codeAt = w++; code = 1; continue; }
+    out[w++] = in[i];
+    if (++code == 0xFF) { out[codeAt] = code; codeAt = w++; code = 1; }
+  }
+  out[codeAt] = code;
+  return w;
+}
+
+// In place is fine (out == in); returns decoded length, 0 if malformed.
+inline size_t cobsDecode(const uint8_t* in, size_t n, uint8_t* out) {
+  size_t r = 0, w = 0;
+  while (r < n) {
+    uint8_t code = in[r++];
+    if (code == 0) return 0;
+    for (uint8_t i = 1; i < code; ++i) {
+      if (r >= n) return 0;
+      out[w++] = in[r++];
+    }
+    if (code != 0xFF && r < n) out[w++] = 0;
+  }
+  return w;
+}
+
+// ---------- replies ----------
+inline void slBegin(uint8_t type, uint8_t seq) { g_slTxLen = 0; g_slTx[g_slTxLen++] = type; g_slTx[g_slTxLen++] = seq; }
+inline void slPut(const void* p, size_t n) {
+  const size_t room = g_slTxLen + 2 < sizeof(g_slTx) ? sizeof(g_slTx) - 2 - g_slTxLen : 0;   // keep room for CRC
+  if (n > room) n = room;
+  memcpy(g_slTx + g_slTxLen, p, n); g_slTxLen += n;
+}
+inline void slPut8(uint8_t v)   { slPut(&v, 1); }
+inline void slPut16(uint16_t v) { slPut(&v, 2); }
+inline void slPut32(uint32_t v) { slPut(&v, 4); }
+inline void slPutText(const char* s) { if (s) slPut(s, strlen(s)); }
+
+inline void slSend() {
+  uint16_t crc = slCrc16(g_slTx, g_slTxLen);
+  g_slTx[g_slTxLen++] = (uint8_t)crc;
+  g_slTx[g_slTxLen++] = (uint8_t)(crc >> 8);
+  size_t n = cobsEncode(g_slTx, g_slTxLen, g_slTxEnc);
+  g_slTxEnc[n++] = 0;
+  Serial.write(g_slTxEnc, n);
+}
+
+inline void slPutTelemetry() {
+  slPut8((uint8_t)jobRunState());
+  slPut16(plan.cur);
+  slPut16(plan.loopsDone + 1);
+  slPut32(plan.stepsDone);
+  slPut32(plan.totalSteps);
+  slPut32((uint32_t)scaleStepsToUm(stepPosition()));
+  for (uint8_t a = 1; a < MOTION_AXES; ++a) slPut32((uint32_t)lroundf(axisPositionUnits(a) * 100.0f));
+}
+
+// ---------- settings ----------
+inline bool slGetSetting(uint8_t key, int32_t& v) {
+  switch (key) {
+    case SLK_SPEED_PCT:     v = getSpeedPercent(); return true;
+    case SLK_PAUSE_MS:      v = (int32_t)runtimeState.defaultPauseMs; return true;
+    case SLK_SETTLE_MS:     v = runtimeState.settleWindowMs; return true;
+    case SLK_SETTLE_COUNTS: v = runtimeState.settleCounts; return true;
+    case SLK_CURRENT_MA:    v = runtimeState.current_mA; return true;
+    case SLK_MICROSTEP:     v = runtimeState.microstep; return true;
+    case SLK_ACCEL:         v = (int32_t)g_axes[AXIS_SLIDE].accel; return true;
+    case SLK_PAYLOAD:       v = runtimeState.payload; return true;
+    default:                return false;
+  }
+}
+
+inline CtlStatus slSetSetting(uint8_t key, int32_t v) {
+  if (motionBusy() && (key == SLK_MICROSTEP || key == SLK_ACCEL || key == SLK_PAYLOAD)) return CTL_BUSY;
+  switch (key) {
+    case SLK_SPEED_PCT:
+      if (v < 5 || v > 100) return CTL_RANGE;
+      ctlSetSpeed(v); return CTL_OK;
+    case SLK_PAUSE_MS:
+      if (v < 0 || v > 600000) return CTL_RANGE;
+      runtimeState.defaultPauseMs = (uint32_t)v; return CTL_OK;
+    case SLK_SETTLE_MS:
+      if (v < 0 || v > 5000) return CTL_RANGE;
+      runtimeState.settleWindowMs = (uint16_t)v; return CTL_OK;
+    case SLK_SETTLE_COUNTS:
+      if (v < 1 || v > 64) return CTL_RANGE;
+      runtimeState.settleCounts = (uint8_t)v; return CTL_OK;
+    case SLK_CURRENT_MA:
+      if (v < 200 || v > 2000) return CTL_RANGE;
+      runtimeState.current_mA = (uint16_t)v; setMotorCurrent((uint16_t)v); return CTL_OK;
+    case SLK_MICROSTEP:
+      if (v < 1 || v > 256 || (v & (v - 1))) return CTL_RANGE;
+      {
+        // the carriage stays put: restate its position, and the encoder
+        // calibration and resonance bands (measured in microsteps), in the
+        // new step size
+        const int64_t old = g_axes[AXIS_SLIDE].microstep;
+        auto rescale = [&](int64_t x) { x *= v; return (x + (x < 0 ? -old / 2 : old / 2)) / old; };
+        const int64_t cal = rescale(runtimeState.calStepsPerCountQ16);
+        if (runtimeState.calStepsPerCountQ16 && (cal < 655 || cal > (64LL << 16))) return CTL_RANGE;
+        g_axisPos[AXIS_SLIDE]            = (int32_t)rescale(g_axisPos[AXIS_SLIDE]);
+        runtimeState.calStepsPerCountQ16 = (uint32_t)cal;
+        runtimeState.calBacklashSteps    = (uint16_t)min<int64_t>(rescale(runtimeState.calBacklashSteps), 0xFFFF);
+        runtimeState.resRateLo          *= (float)v / old;
+        runtimeState.resRateHi          *= (float)v / old;
+      }
+      runtimeState.microstep = (uint16_t)v; setMicrostepping((uint16_t)v); scaleRefresh();
+      eepromSaveRuntime();   // never leave a stored calibration or band map in the other step size
+      return CTL_OK;
+    case SLK_ACCEL:
+      if (v < 100 || v > 200000) return CTL_RANGE;
+      g_axes[AXIS_SLIDE].accel = (float)v; return CTL_OK;
+    case SLK_PAYLOAD:
+      if (v < 0 || v >= TUNE_PROFILES) return CTL_RANGE;
+      runtimeState.payload = (uint8_t)v; scaleRefresh(); return CTL_OK;
+    default:
+      return CTL_BAD;
+  }
+}
+
+// ---------- dispatch ----------
+inline void slHandleFrame(const uint8_t* f, size_t n) {
+  const uint8_t type = f[0], seq = f[1];
+  const uint8_t* p = f + 2;
+  const size_t   pn = n - 2;
+  slBegin(type | SL_REPLY, seq);
+
+  CtlStatus st = CTL_OK;
+  switch (type) {
+    case SL_PING:
+      slPut8(CTL_OK); slPut8(SERIAL_LINK_VERSION); slPut8(MOTION_AXES); slPut16(g_slBadFrames);
+      slSend(); return;
+
+    case SL_MOVE: {
+      if (pn < 5) { st = CTL_BAD; break; }
+      float mm; memcpy(&mm, p, 4);
+      st = ctlMoveTo(mm, p[4]);
+      break;
+    }
+    case SL_JOG: {
+      if (pn < 4) { st = CTL_BAD; break; }
+      float mm; memcpy(&mm, p, 4);
+      st = ctlJog(mm);
+      break;
+    }
+    case SL_STOP:
+      ctlStop();
+      break;
+    case SL_DRIVE: {
+      if (pn < 1) { st = CTL_BAD; break; }
+      const int8_t pct = (int8_t)p[0];
+      st = ctlDrive(pct > 0 ? 1 : (pct < 0 ? -1 : 0), abs(pct));
+      break;
+    }
+    case SL_CRAWL: {
+      if (pn < 4) { st = CTL_BAD; break; }
+      float mmh, mm = 0.0f;
+      memcpy(&mmh, p, 4);
+      if (pn >= 8) memcpy(&mm, p + 4, 4);
+      st = ctlCrawl(mmh, mm);
+      break;
+    }
+    case SL_RESUME: {
+      if (pn < 1) { st = CTL_BAD; break; }
+      st = p[0] == 0xFF ? CTL_OK : ctlResume(p[0] != 0);
+      if (st != CTL_OK) break;
+      slPut8(CTL_OK); slPut8(resumeState());
+      slPut16((uint16_t)lroundf(resumeProgress() * 1000.0f));
+      slPut32(g_rj.cp.elapsedMs / 1000);
+      slSend(); return;
+    }
+    case SL_TAKE: {
+      if (pn < 1) { st = CTL_BAD; break; }
+      float scale = 1.0f;
+      if (pn >= 5) memcpy(&scale, p + 1, 4);
+      st = p[0] == 0xFF ? CTL_OK : ctlTake(p[0], scale);
+      if (st != CTL_OK) break;
+      slPut8(CTL_OK); slPut8(takeState());
+      slPut32((uint32_t)lroundf(takeSeconds() * 1000.0f));
+      slPut32(takeState() == TAKE_RECORDING ? (g_take.w.nib + 1) / 2 : g_take.hdr.bytes);
+      slPut16((uint16_t)lroundf(takeProgress() * 1000.0f));
+      slSend(); return;
+    }
+
+    case SL_JOB: {
+      if (pn < 2) { st = CTL_BAD; break; }
+      if (p[0] & 1) {
+        JobCheck c;
+        if (ctlJobCheck(StrView{ (const char*)p + 1, pn - 1 }, c) == CTL_BUSY) { st = CTL_BUSY; break; }
+        slPut8(CTL_OK);
+        slPut16(c.segments); slPut32(c.totalSteps); slPut32(c.totalMs);
+        slPut16(c.flags);
+        slPut8((uint8_t)min(255.0f, c.ratePct + 0.5f)); slPut8((uint8_t)min(255.0f, c.accelPct + 0.5f));
+        slPut16(c.leg); slPut32(c.legMs); slPut32(c.legMinMs);
+        slPutText(c.error);
+        slSend(); return;
+      }
+      const char* err = nullptr;
+      st = ctlJobSubmit(StrView{ (const char*)p + 1, pn - 1 }, false, err);
+      slPut8(st);
+      if (st == CTL_OK) { slPut16(plan.count); slPut32(plan.totalSteps); slPut32(plan.totalMs); }
+      else              slPutText(err);
+      slSend(); return;
+    }
+    case SL_STATUS:
+      slPut8(CTL_OK); slPutTelemetry();
+      slSend(); return;
+
+    case SL_SET: {
+      if (pn < 5) { st = CTL_BAD; break; }
+      int32_t v; memcpy(&v, p + 1, 4);
+      st = slSetSetting(p[0], v);
+      break;
+    }
+    case SL_GET: {
+      int32_t v = 0;
+      if (pn < 1 || !slGetSetting(p[0], v)) { st = CTL_BAD; break; }
+      slPut8(CTL_OK); slPut32((uint32_t)v);
+      slSend(); return;
+    }
+    case SL_SAVE:
+      eepromSaveRuntime();
+      break;
+
+    case SL_SUB:
+      if (pn < 2) { st = CTL_BAD; break; }
+      memcpy(&g_slSubMs, p, 2);
+      g_slSubLast = millis();
+      break;
+
+    case SL_LOG: {
+      int slot; uint16_t count, from; FrecRecordHeader h;
+      if (pn < 3) { st = CTL_BAD; break; }
+      memcpy(&from, p + 1, 2);
+      if (!frecOpen(p[0], slot, count, h)) { st = CTL_RANGE; break; }
+      const uint8_t n = (uint8_t)min<uint32_t>(count > from ? count - from : 0,
+                                               (sizeof(g_slTx) - g_slTxLen - 13) / sizeof(FrecEvent));
+      slPut8(CTL_OK); slPut8(h.resetReason); slPut32(h.boots);
+      slPut16(count); slPut16(from); slPut8(n);
+      FrecEvent e;
+      for (uint8_t i = 0; i < n; ++i) { frecGet(slot, from + i, e); slPut(&e, sizeof(e)); }
+      slSend(); return;
+    }
+    case SL_BOOT: {
+      slPut8(CTL_OK); slPut32(g_bootMenuUs); slPut32(g_bootMotionUs);
+      const size_t nAt = g_slTxLen;
+      slPut8(0);
+      uint8_t n = 0;
+      for (uint8_t i = 0; i < bootMarkCount(); ++i) {
+        const uint8_t len = (uint8_t)strlen(g_bootMarks[i].name);
+        if (g_slTxLen + 5 + len > sizeof(g_slTx) - 2) break;   // room for the CRC
+        slPut32(g_bootMarks[i].us); slPut8(len); slPut(g_bootMarks[i].name, len);
+        n++;
+      }
+      g_slTx[nAt] = n;
+      slSend(); return;
+    }
+    case SL_INPUT: {
+      uint16_t from;
+      if (pn < 2) { st = CTL_BAD; break; }
+      memcpy(&from, p, 2);
+      const uint16_t count = inputTraceCount();
+      const uint8_t n = (uint8_t)min<uint32_t>(count > from ? count - from : 0,
+                                               (sizeof(g_slTx) - g_slTxLen - 8) / 5);
+      slPut8(CTL_OK); slPut16(count); slPut16(from); slPut8(n);
+      for (uint8_t i = 0; i < n; ++i) { InputSample s = inputTraceAt(from + i); slPut32(s.ms); slPut8(s.pins); }
+      slSend(); return;
+    }
+    default:
+      st = CTL_BAD;
+      break;
+  }
+  slPut8(st);
+  if (st != CTL_OK) slPutText(ctlStatusText(st));
+  slSend();
+}
+
+inline void slOnFrame() {
+  size_t n = cobsDecode(g_slRx, g_slRxLen, g_slRx);
+  if (n < 4) { g_slBadFrames++; return; }
+  uint16_t crc = (uint16_t)(g_slRx[n-2] | (g_slRx[n-1] << 8));
+  if (slCrc16(g_slRx, n - 2) != crc) { g_slBadFrames++; return; }
+  slHandleFrame(g_slRx, n - 2);
+}
+
+// ---------- public ----------
+inline void serialLinkBegin() { Serial.begin(SERIAL_LINK_BAUD); }
+
+inline void serialLinkLoop() {
+  while (Serial.available() > 0) {
+    int c = Serial.read();
+    if (c < 0) break;
+    if (c == 0) {
+      if (g_slOverflow) g_slBadFrames++;
+      else if (g_slRxLen) slOnFrame();
+      g_slRxLen = 0; g_slOverflow = false;
+      continue;
+    }
+    if (g_slRxLen >= sizeof(g_slRx)) { g_slOverflow = true; continue; }
+    g_slRx[g_slRxLen++] = (uint8_t)c;
+  }
+
+  if (g_slSubMs && (uint32_t)(millis() - g_slSubLast) >= g_slSubMs) {
+    g_slSubLast += g_slSubMs;
+    if ((uint32_t)(millis() - g_slSubLast) >= g_slSubMs) g_slSubLast = millis();   // don't burst after a stall
+    slBegin(SL_TELEMETRY, g_slTelSeq++);
+    slPutTelemetry();
+    slSend();
+  }
+}
+
+#endif
@@ -1,167 +1,106 @@
 #pragma once
 #include <Arduino.h>
-#include "ui_helpers.h"
-#include "rotary_input.h"
-#include "config.h"   // for BTN_BACK_PIN if defined
+#include "menu_tree.h"
+#include "serial_link.h"   // slGetSetting/slSetSetting: ranges and side effects
+#include "wifi_link.h"
+#include "scale_calib.h"
+#include "resonance_calib.h"
+#include "speed_tune.h"
 
 // Forward decl so the main menu can call into this
 void openSettingsMenu();
 
 
 // -----------------------------
-// Items in Settings
+// Setting accessors for the value rows; a change is saved at once
 // -----------------------------
-static const char* const settingsItems[] = {
-  "Motor Tuning",
-  "Set Endpoints",
-  "Motion Profile",
-  "Wi-Fi Setup",
-  "Units / UI"
-};
-static const int SETTINGS_COUNT = sizeof(settingsItems)/sizeof(settingsItems[0]);
-
-// -----------------------------
-// Layout helpers (3 visible rows, equal top/bottom margin)
-// -----------------------------
-static inline int rowYTopForIndex(int visibleIndex /*0..2*/) {
-  const int totalVisH = 3*UI::ITEM_H + 2*UI::GAP;
-  const int cy        = tft.height()/2;
-  const int baseTop   = cy - totalVisH/2;
-  return baseTop + visibleIndex*(UI::ITEM_H + UI::GAP);
+// Settings the serial link also exposes go through its table, so the
+// ranges and side effects (driver current, rescale) are the same.
+template<uint8_t K> int32_t settingGet() { int32_t v = 0; slGetSetting(K, v); return v; }
+template<uint8_t K> bool settingSet(int32_t v) {
+  if (slSetSetting(K, v) != CTL_OK) return false;
+  eepromSaveRuntime();
+  return true;
 }
 
-// -----------------------------
-// Short-press Back detector (local, debounced).
-// If BTN_BACK_PIN isn't defined, it compiles away & returns false.
-// -----------------------------
-static inline bool backShortPressed() {
-#ifdef BTN_BACK_PIN
-  static uint32_t lastEdge = 0;
-  static bool prev = false;
-  bool now = (digitalRead(BTN_BACK_PIN) == LOW); // active low button
-  bool pressed = false;
-
-  if (now && !prev) {
-    // press edge
-    lastEdge = millis();
-  }
-  if (!now && prev) {
-    // release edge: short press window
-    uint32_t dur = millis() - lastEdge;
-    if (dur > 40 && dur < 600) pressed = true; // debounce + short-press threshold
-  }
-  prev = now;
-  return pressed;
-#else
-  return false;
-#endif
+// Payload profile, shown 1-based as the tune screen does
+inline int32_t payloadGet() { return runtimeState.payload + 1; }
+inline bool    payloadSet(int32_t v) { return settingSet<SLK_PAYLOAD>(v - 1); }
+
+// Job endpoints (job.h uses them once saved), held inside the travel
+inline bool endpointSet(float& mm, int32_t v) {
+  const AxisConfig& ax = g_axes[AXIS_SLIDE];
+  mm = clampT((float)v, ax.minPos, ax.maxPos);
+  runtimeState.endpointsSaved = true;
+  eepromSaveRuntime();
+  return true;
 }
-
-// -----------------------------
-// Draw Settings screen
-// -----------------------------
-inline void drawSettings() {
-  uiBegin();
-
-  // Title (subtle)
-  tft.setTextDatum(TL_DATUM);
-  fontLabel();
-  tft.setTextColor(Theme::TEXT_DIM, Theme::BG);
-  tft.setCursor(UI::PAD, 6);
-  tft.print("Settings");
-
-  // Right rail tabs
-  drawRightTabTop("Back");
-  drawRightTabBottom("Select");
-
-  // Which three to show?
-  extern int g_settingsIdx;
-  int firstVisible = g_settingsIdx - 1;
-  if (firstVisible < 0) firstVisible = 0;
-  if (firstVisible > SETTINGS_COUNT-3) firstVisible = max(0, SETTINGS_COUNT-3);
-
-  // 3 rows
-  fontBody();
-  for (int i = 0; i < 3; ++i) {
-    int idx = firstVisible + i;
-    if (idx >= SETTINGS_COUNT) break;
-    int yTop = rowYTopForIndex(i);
-    bool selected = (idx == g_settingsIdx);
-    drawListItemRailAware(yTop, settingsItems[idx], selected);
-  }
-
-  // Slim scroll (aligned with Back/Select tabs)
-  drawSlimScroll(SETTINGS_COUNT, firstVisible, 3);
+inline int32_t endpointAGet() { return lroundf(runtimeState.endpointA_mm); }
+inline int32_t endpointBGet() { return lroundf(runtimeState.endpointB_mm); }
+inline bool    endpointASet(int32_t v) { return endpointSet(runtimeState.endpointA_mm, v); }
+inline bool    endpointBSet(int32_t v) { return endpointSet(runtimeState.endpointB_mm, v); }
+
+// Wi-Fi mode; joining a network needs credentials from the web page first
+static const char* const WIFI_MODE_NAMES[] = { "AP", "Station", "Sta+AP" };
+inline int32_t wifiModeGet() { return runtimeState.wifiMode; }
+inline bool wifiModeSet(int32_t v) {
+  if (v == runtimeState.wifiMode) return true;
+  if (v != WLM_AP && !runtimeState.sta_ssid[0]) return false;
+  runtimeState.wifiMode = (uint8_t)v;
+  eepromSaveRuntime();
+  wifiRestartSoon();
+  return true;
 }
 
-// Keep selection index global so it persists
-int g_settingsIdx = 0;
+inline void runMotorTuning() { runScaleCalibration(); runSpeedTune(); runResonanceCalibration(); }
 
 // -----------------------------
-// Main loop for Settings
+// The tree
 // -----------------------------
-void openSettingsMenu() {
-  // clamp index
-  if (g_settingsIdx < 0) g_settingsIdx = 0;
-  if (g_settingsIdx >= SETTINGS_COUNT) g_settingsIdx = SETTINGS_COUNT - 1;
-
-  drawSettings();
-
-  while (true) {
-    updateRotary();
-
-    // Encoder-only scrolling
-    int d = getEncoderDelta();
-    if (d != 0) {
-      g_settingsIdx += d;
-      if (g_settingsIdx < 0) g_settingsIdx = 0;
-      if (g_settingsIdx >= SETTINGS_COUNT) g_settingsIdx = SETTINGS_COUNT - 1;
-      drawSettings();
-    }
+static constexpr MenuValue SET_CURRENT   = { settingGet<SLK_CURRENT_MA>, settingSet<SLK_CURRENT_MA>, 200, 2000, 50, "mA", nullptr };
+static constexpr MenuValue SET_PAYLOAD   = { payloadGet, payloadSet, 1, TUNE_PROFILES, 1, nullptr, nullptr };
+static constexpr MenuValue SET_END_A     = { endpointAGet, endpointASet, 0, 5000, 5, "mm", nullptr };
+static constexpr MenuValue SET_END_B     = { endpointBGet, endpointBSet, 0, 5000, 5, "mm", nullptr };
+static constexpr MenuValue SET_SPEED     = { settingGet<SLK_SPEED_PCT>, settingSet<SLK_SPEED_PCT>, 5, 100, 5, "%", nullptr };
+static constexpr MenuValue SET_PAUSE     = { settingGet<SLK_PAUSE_MS>, settingSet<SLK_PAUSE_MS>, 0, 60000, 100, "ms", nullptr };
+static constexpr MenuValue SET_SETTLE    = { settingGet<SLK_SETTLE_MS>, settingSet<SLK_SETTLE_MS>, 0, 5000, 10, "ms", nullptr };
+static constexpr MenuValue SET_QUIET     = { settingGet<SLK_SETTLE_COUNTS>, settingSet<SLK_SETTLE_COUNTS>, 1, 64, 1, nullptr, nullptr };
+static constexpr MenuValue SET_WIFI_MODE = { wifiModeGet, wifiModeSet, WLM_AP, WLM_STA_AP, 1, nullptr, WIFI_MODE_NAMES };
+
+static constexpr MenuEntry MOTOR_TUNING_ENTRIES[] = {
+  menuAction("Tune all",   runMotorTuning),
+  menuAction("Scale",      runScaleCalibration),
+  menuAction("Speed",      runSpeedTune),
+  menuAction("Resonance",  runResonanceCalibration),
+  menuValue ("Current",    SET_CURRENT),
+  menuValue ("Payload",    SET_PAYLOAD),
+};
+static constexpr MenuNode MOTOR_TUNING_MENU = menuNode("Motor Tuning", MOTOR_TUNING_ENTRIES);
 
-    // SHORT PRESS BACK = EXIT (no more short-press scrolling)
-    if (backShortPressed()) {
-      // quick visual pulse on the "Back" tab
-      drawRightTabTop("Back");
-      delay(120);
-      return;
-    }
+static constexpr MenuEntry ENDPOINT_ENTRIES[] = {
+  menuValue("Start",      SET_END_A),
+  menuValue("End",        SET_END_B),
+};
+static constexpr MenuNode ENDPOINT_MENU = menuNode("Set Endpoints", ENDPOINT_ENTRIES);
 
-    // (Optional) long-press back also exits for safety
-    if (isBackPressedLong()) {
-      drawRightTabTop("Back");
-      delay(120);
-      return;
-    }
+static constexpr MenuEntry MOTION_PROFILE_ENTRIES[] = {
+  menuValue("Speed",      SET_SPEED),
+  menuValue("Pause",      SET_PAUSE),
+  menuValue("Settle",     SET_SETTLE),
+  menuValue("Quiet cnt",  SET_QUIET),
+};
+static constexpr MenuNode MOTION_PROFILE_MENU = menuNode("Motion Profile", MOTION_PROFILE_ENTRIES);
 
-    // Select pressed = pulse feedback (hook up action as needed)
-    if (isSelectPressed()) {
-      // Pulse the selected pill briefly
-      int firstVisible = g_settingsIdx - 1;
-      if (firstVisible < 0) firstVisible = 0;
-      if (firstVisible > SETTINGS_COUNT-3) firstVisible = max(0, SETTINGS_COUNT-3);
-      int visIdx = g_settingsIdx - firstVisible;
-      if (visIdx >= 0 && visIdx < 3) {
-        int yTop = rowYTopForIndex(visIdx);
-        // invert pill colors momentarily
-        tft.fillRoundRect(UI::PAD, yTop,
-                          tft.width() - UI::RIGHT_COL_W - 2*UI::PAD,
-                          UI::ITEM_H, UI::RADIUS, Theme::TEXT);
-        tft.setTextColor(Theme::BG, Theme::TEXT);
-        int tw = textWidth(settingsItems[g_settingsIdx]);
-        int cx = UI::PAD + (tft.width() - UI::RIGHT_COL_W - 2*UI::PAD)/2;
-        int cy = yTop + (UI::ITEM_H - fontHeight())/2;
-        tft.setCursor(cx - tw/2, cy);
-        tft.print(settingsItems[g_settingsIdx]);
-        delay(110);
-      }
-      drawSettings();
+static constexpr MenuEntry SETTINGS_ENTRIES[] = {
+  menuChild("Motor Tuning",   MOTOR_TUNING_MENU),
+  menuChild("Set Endpoints",  ENDPOINT_MENU),
+  menuChild("Motion Profile", MOTION_PROFILE_MENU),
+  menuValue("Wi-Fi",          SET_WIFI_MODE),
+};
+static constexpr MenuNode SETTINGS_MENU = menuNode("Settings", SETTINGS_ENTRIES);
 
-      // TODO: route into the selected submenu here if desired
-      // (e.g., if (g_settingsIdx == 0) motorTuningWizard(); etc.)
-    }
+// Selection (menu.cpp), kept between visits; openSettingsMenu() runs the
+// tree there too
+extern MenuView g_settingsMenu;
 
-    idleDimmerTick();
-    delay(4);
-  }
-}
\ No newline at end of file
+inline void drawSettings() { menuOpen(g_settingsMenu, SETTINGS_MENU); }
@@ -0,0 +1,10 @@
+// Settle statistics and the dwell watcher.
+#include "settle.h"
+
+SettleStats g_settle;
+bool     g_settleArmed   = false;
+uint32_t g_settleArmedAt = 0;
+uint32_t g_settleMaxMs   = 0;
+uint32_t g_settleLastMs  = 0, g_settleQuietMs = 0;
+uint16_t g_settlePrevRaw = 0;
+int16_t  g_settlePos = 0, g_settleLo = 0, g_settleHi = 0;
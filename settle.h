@@ -0,0 +1,106 @@
+#ifndef SETTLE_H
+#define SETTLE_H
+
+// Settle detection for shoot-move-shoot: after a move, a settle dwell ends
+// as soon as the AS5600 has been still (low velocity and low jitter) for
+// runtimeState.settleWindowMs. The dwell length stays the upper bound, so a
+// missing encoder or an unpolled settleTick() just gives the fixed pause.
+// Call settleTick() from loop() and any screen that waits on a running plan.
+
+#include <Arduino.h>
+#include "config.h"
+#include "encoder_utils.h"
+#include "eeprom_utils.h"
+#include "step_generator.h"
+
+#ifndef SETTLE_SAMPLE_MS
+  #define SETTLE_SAMPLE_MS 5
+#endif
+#ifndef SETTLE_LOG_LEN
+  #define SETTLE_LOG_LEN   16    // recent settle times kept for status
+#endif
+
+struct SettleStats {
+  uint16_t log[SETTLE_LOG_LEN] = {0};   // ms, newest at log[(head-1) % LEN]
+  uint8_t  head     = 0;
+  uint16_t count    = 0;
+  uint16_t timeouts = 0;                // dwells that ran to the upper bound
+  uint32_t sumMs    = 0;
+  uint16_t maxMs    = 0;
+};
+extern SettleStats g_settle;
+
+// watcher state for the settle dwell in progress
+extern bool     g_settleArmed;
+extern uint32_t g_settleArmedAt;   // g_settleStartUs of the watched dwell
+extern uint32_t g_settleMaxMs;
+extern uint32_t g_settleLastMs, g_settleQuietMs;
+extern uint16_t g_settlePrevRaw;
+extern int16_t  g_settlePos, g_settleLo, g_settleHi;
+
+inline void settleReset() { g_settle = SettleStats(); g_settleArmed = false; }
+
+inline void settleLog(uint32_t ms, bool timedOut) {
+  if (ms > 0xFFFF) ms = 0xFFFF;
+  g_settle.log[g_settle.head] = (uint16_t)ms;
+  g_settle.head = (uint8_t)((g_settle.head + 1) % SETTLE_LOG_LEN);
+  g_settle.count++;
+  g_settle.sumMs += ms;
+  if (ms > g_settle.maxMs) g_settle.maxMs = (uint16_t)ms;
+  if (timedOut) g_settle.timeouts++;
+  frec(FR_SETTLE, timedOut ? 1 : 0, 0, (int32_t)ms);
+}
+inline uint16_t settleLastMs() {
+  return g_settle.count ? g_settle.log[(g_settle.head + SETTLE_LOG_LEN - 1) % SETTLE_LOG_LEN] : 0;
+}
+inline uint16_t settleAvgMs() { return g_settle.count ? (uint16_t)(g_settle.sumMs / g_settle.count) : 0; }
+
+inline void settleTick() {
+  const bool pending = g_settlePending;
+  const uint32_t start = g_settleStartUs;
+
+  // watched dwell ended without us: it ran to its upper bound
+  if (g_settleArmed && (!pending || start != g_settleArmedAt)) {
+    if (plan.active || plan.stepsDone >= plan.totalSteps) settleLog(g_settleMaxMs, true);
+    g_settleArmed = false;
+  }
+  if (!pending) return;
+
+  const uint32_t now = millis();
+  if (!g_settleArmed) {
+    g_settleArmed   = true;
+    g_settleArmedAt = start;
+    g_settleMaxMs   = plan.seg[plan.cur].dwellMs;
+    if (!encoderIsPresent()) encoderInit();
+    g_settlePrevRaw = encoderIsPresent() ? readRawAngle() : 0;
+    g_settleLastMs = g_settleQuietMs = now;
+    g_settlePos = g_settleLo = g_settleHi = 0;
+    return;
+  }
+  if (runtimeState.settleWindowMs == 0 || !encoderIsPresent()) return;   // fixed pause
+  if ((uint32_t)(now - g_settleLastMs) < SETTLE_SAMPLE_MS) return;
+  g_settleLastMs = now;
+
+  const uint16_t raw = readRawAngle();
+  const int16_t  d   = encoderRawDelta(g_settlePrevRaw, raw);
+  g_settlePrevRaw = raw;
+  g_settlePos += d;
+  if (g_settlePos < g_settleLo) g_settleLo = g_settlePos;
+  if (g_settlePos > g_settleHi) g_settleHi = g_settlePos;
+
+  const int16_t lim = runtimeState.settleCounts;
+  if (abs(d) > lim || g_settleHi - g_settleLo > 2 * lim) {
+    // still moving or still swinging: restart the quiet window here
+    g_settleQuietMs = now;
+    g_settleLo = g_settleHi = g_settlePos;
+    return;
+  }
+  if ((uint32_t)(now - g_settleQuietMs) < runtimeState.settleWindowMs) return;
+
+  const uint32_t took = (micros() - start) / 1000UL;
+  if (stepGenEndSettle())  settleLog(took, false);
+  else if (plan.active)    settleLog(g_settleMaxMs, true);
+  g_settleArmed = false;
+}
+
+#endif
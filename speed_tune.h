@@ -0,0 +1,263 @@
+#ifndef SPEED_TUNE_H
+#define SPEED_TUNE_H
+
+// Auto-tune: find how fast and how hard this rig, with this payload, can
+// really be driven. Trial moves climb ladders of acceleration (at a modest
+// speed), cruise rate, then acceleration near the top speed, while the
+// AS5600 (on the motor shaft) is compared with the commanded steps; the
+// first trial whose tracking error exceeds TUNE_LOST_FULLSTEPS marks the
+// limit. The last good values, less a margin,
+// are stored in mm/s and mm/s^2 for the chosen payload profile and become
+// the slide's limits (rig_scale.h), so 100 % speed and the planner follow
+// the rig instead of MOTOR_MIN_US_PER_STEP / DEFAULT_ACCEL_SPS2. Trials
+// alternate direction, so the carriage stays within TUNE_TRAVEL_MM.
+
+#include <Arduino.h>
+#include <math.h>
+#include "config.h"
+#include "encoder_utils.h"
+#include "motion_plan.h"
+#include "step_generator.h"
+#include "resonance_map.h"
+#include "rig_scale.h"
+#include "eeprom_utils.h"
+#include "wizard_ui.h"
+
+#ifndef TUNE_SPEED_MARGIN
+  #define TUNE_SPEED_MARGIN   0.80f    // stored speed vs the fastest clean trial
+#endif
+#ifndef TUNE_ACCEL_MARGIN
+  #define TUNE_ACCEL_MARGIN   0.70f
+#endif
+#ifndef TUNE_LOST_FULLSTEPS
+  #define TUNE_LOST_FULLSTEPS 2.0f     // tracking error that means steps were lost
+#endif
+#ifndef TUNE_TRAVEL_MM
+  #define TUNE_TRAVEL_MM      80.0f    // longest trial move
+#endif
+#define TUNE_RATE_STEP   1.15f         // ladder factors between trials
+#define TUNE_ACCEL_STEP  1.25f
+#define TUNE_ACCEL_TOP   8.0f          // highest accel tried, x DEFAULT_ACCEL_SPS2
+#define TUNE_CRUISE_S    0.3f          // time at the trial rate
+#define TUNE_REST_MS     150           // let the carriage stop before the last read
+
+typedef bool (*TuneCancelFn)();
+typedef void (*TuneProgressFn)(int pct);
+
+struct TuneResult {
+  bool  ok        = false;
+  bool  cancelled = false;
+  float maxRate   = 0.0f;   // fastest clean trial, steps/s
+  float accel     = 0.0f;   // hardest clean trial, steps/s^2
+  float maxMmS    = 0.0f;   // stored, margin applied
+  float accelMmS2 = 0.0f;
+  uint8_t trials  = 0;
+};
+
+// Move `steps` cruising at `rate` with `accel`, comparing commanded steps
+// with the encoder as it goes. Returns the worst tracking error in
+// microsteps (stops early once it passes `limit`), or <0 if cancelled.
+// The step counter is set to where the encoder says the motor got to.
+inline float tuneTrial(int32_t steps, float rate, float accel, float limit, TuneCancelFn cancel) {
+  planReset();
+  if (planAddMoveAtRate(steps, rate, accel) != PLAN_OK) return -1;
+  planFinalize(1);
+
+  const float stepsPerCount = rigScale().stepsPerCountQ16 / 65536.0f;
+  const int32_t start = g_axisPos[AXIS_SLIDE];
+  uint16_t prev = readRawAngle();
+  int32_t counts = 0;
+  float worst = 0.0f;
+  bool cancelled = false;
+  if (!planStart()) return -1;
+  while (plan.active) {
+    if (cancel && cancel()) { planStop(); cancelled = true; break; }
+    const uint32_t s0 = plan.stepsDone;
+    const uint16_t raw = readRawAngle();
+    const uint32_t s1 = plan.stepsDone;
+    counts += encoderRawDelta(prev, raw);
+    prev = raw;
+    const float err = fabsf(0.5f * (s0 + s1) - abs(counts) * stepsPerCount);
+    if (err > worst) worst = err;
+    if (worst > limit) { planStop(); break; }   // losing steps: stop driving it
+  }
+  delay(TUNE_REST_MS);
+  counts += encoderRawDelta(prev, readRawAngle());
+  worst = max(worst, fabsf((float)plan.stepsDone - abs(counts) * stepsPerCount));
+  g_axisPos[AXIS_SLIDE] = start + (steps < 0 ? -1 : 1) * (int32_t)lroundf(abs(counts) * stepsPerCount);
+  return cancelled ? -1.0f : worst;
+}
+
+// Climb from `from` by `factor` up to `top` while trial(v) passes (1).
+// Returns the last passing value; if the first fails (0), steps down until
+// one passes. 2 = cannot be tested (no room), keep what passed so far.
+// 0 = nothing passed, <0 = cancelled.
+template <typename Trial>
+inline float tuneLadder(float from, float top, float factor, Trial trial) {
+  float v = from, good = 0.0f;
+  while (true) {
+    const int r = trial(v);
+    if (r < 0) return -1.0f;
+    if (r == 2) return good;
+    if (r == 1) {
+      good = v;
+      if (v >= top) return good;
+      v = min(top, v * factor);
+    } else {
+      if (good > 0.0f) return good;
+      v /= factor;
+      if (v < from / 8.0f) return 0.0f;
+    }
+  }
+}
+
+// Tune the slide for payload profile `profile` and make it the active one.
+inline TuneResult speedTune(uint8_t profile, TuneProgressFn progress, TuneCancelFn cancel) {
+  TuneResult r;
+  encoderInit();
+  if (!encoderIsPresent() || profile >= TUNE_PROFILES) return r;
+
+  // lift the limits for the search; scaleRefresh() sets them again after
+  AxisConfig& slide = g_axes[AXIS_SLIDE];
+  slide.minUsPerStep = MOTOR_FLOOR_US_PER_STEP;
+  slide.accel        = DEFAULT_ACCEL_SPS2 * TUNE_ACCEL_TOP;
+  g_resonanceBypass  = true;
+
+  const float spmm   = stepsPerMM();
+  const float limit  = TUNE_LOST_FULLSTEPS * runtimeState.microstep;
+  const float travel = TUNE_TRAVEL_MM * spmm;
+  float       rate0  = 0.5f * 1e6f / MOTOR_MIN_US_PER_STEP;
+  const float rateTop = 1e6f / MOTOR_FLOOR_US_PER_STEP;
+  const float acc0   = 0.5f * DEFAULT_ACCEL_SPS2,           accTop  = slide.accel;
+  int8_t dir = 1;
+  auto verdict = [&](float e) { r.trials++; dir = -dir; return e < 0 ? -1 : (e <= limit ? 1 : 0); };
+  // mostly-ramp move to v with accel a
+  auto accelTrial = [&](float v, float a) {
+    return verdict(tuneTrial(dir * (int32_t)min(travel, v * v / a + v * 0.05f), v, a, limit, cancel));
+  };
+
+  // 1) accel at a modest cruise rate, so the speed search has a ramp to
+  //    use; a rig that cannot reach that rate at all gets a slower one
+  float accLow = 0.0f;
+  for (; rate0 >= 4.0f * planMinRate(); rate0 *= 0.5f) {
+    accLow = tuneLadder(acc0, accTop, TUNE_ACCEL_STEP, [&](float a) {
+      const int v = accelTrial(rate0, a);
+      if (progress) progress((int)(20.0f * logf(a / acc0) / logf(accTop / acc0)));
+      return v;
+    });
+    if (accLow != 0.0f) break;
+  }
+
+  // 2) cruise rate, ramping at most 70 % of that; past what the trial
+  //    travel can reach is as far as this rig lets us test
+  if (accLow > 0.0f) {
+    r.maxRate = tuneLadder(rate0, rateTop, TUNE_RATE_STEP, [&](float v) {
+      const float cruise = v * TUNE_CRUISE_S;
+      if (cruise >= travel) return 2;
+      const float a = max(0.5f * accLow, v * v / (travel - cruise));
+      if (a > TUNE_ACCEL_MARGIN * accLow) return 2;
+      const int res = verdict(tuneTrial(dir * (int32_t)(cruise + v * v / a), v, a, limit, cancel));
+      if (progress) progress(20 + (int)(50.0f * logf(v / rate0) / logf(rateTop / rate0)));
+      return res;
+    });
+  }
+
+  // 3) accel again near the top speed, where torque is lowest
+  if (r.maxRate > 0.0f) {
+    const float v = 0.8f * r.maxRate;
+    const float accHigh = v > 2.0f * rate0 ? tuneLadder(0.5f * accLow, accTop, TUNE_ACCEL_STEP, [&](float a) {
+      const int res = accelTrial(v, a);
+      if (progress) progress(70 + (int)(30.0f * logf(a / acc0) / logf(accTop / acc0)));
+      return res;
+    }) : accLow;
+    r.accel = accHigh < 0.0f ? accHigh : min(accLow, accHigh);
+  }
+  if (accLow < 0.0f) r.accel = accLow;
+  g_resonanceBypass = false;
+  r.cancelled = r.maxRate < 0.0f || r.accel < 0.0f;
+
+  if (!r.cancelled && r.maxRate > 0.0f && r.accel > 0.0f) {
+    SlideLimits& lim = runtimeState.limits[profile];
+    lim.maxMmS    = r.maxRate * TUNE_SPEED_MARGIN / spmm;
+    lim.accelMmS2 = r.accel * TUNE_ACCEL_MARGIN / spmm;
+    runtimeState.payload = profile;
+    eepromSaveRuntime();
+    r.maxMmS = lim.maxMmS; r.accelMmS2 = lim.accelMmS2;
+    r.ok = true;
+  }
+  scaleRefresh();
+  return r;
+}
+
+// Switch payload profile without tuning (untuned = firmware defaults).
+inline void speedTuneSelect(uint8_t profile) {
+  if (profile >= TUNE_PROFILES) return;
+  runtimeState.payload = profile;
+  scaleRefresh();
+}
+
+// ---------- screen ----------
+static inline bool tuneCancelByButton() {
+  updateRotary();
+  return isBackPressed() || isSelectPressed();
+}
+static inline void tuneDrawProgress(int pct) {
+  wizardFrameStart("Stop");
+  drawCenteredProgress(constrain(pct, 0, 100));
+}
+static inline void tuneProfileLine(uint8_t p, char* out, size_t n) {
+  const SlideLimits& l = runtimeState.limits[p];
+  if (l.maxMmS > 0.0f) snprintf(out, n, "%s%d: %d mm/s", p == runtimeState.payload ? "*" : "", p + 1, (int)l.maxMmS);
+  else                 snprintf(out, n, "%s%d: not tuned", p == runtimeState.payload ? "*" : "", p + 1);
+}
+
+// Knob picks a payload profile; OK tunes it, Back makes it the active one.
+inline void runSpeedTune() {
+  int p = runtimeState.payload;
+  int last = getRotaryPosition();
+  bool dirty = true;
+  while (true) {
+    if (dirty) {
+      char line[24];
+      tuneProfileLine((uint8_t)p, line, sizeof(line));
+      wizardFrameStart("Tune");
+      wizardCenterTwo("Payload", line);
+      dirty = false;
+    }
+    updateRotary();
+    const int pos = getRotaryPosition();
+    if (pos != last) { p = constrain(p + (pos > last ? 1 : -1), 0, TUNE_PROFILES - 1); last = pos; dirty = true; }
+    if (isBackPressed()) { if (p != runtimeState.payload) { speedTuneSelect((uint8_t)p); eepromSaveRuntime(); } return; }
+    if (isSelectPressed()) break;
+    idleDimmerTick();
+    delay(10);
+  }
+
+  wizardFrameStart("Start");
+  wizardCenterTwo("Auto-tune", "Centre carriage, OK");
+  while (true) {
+    updateRotary();
+    if (isSelectPressed()) break;
+    if (isBackPressed()) return;
+    idleDimmerTick();
+    delay(10);
+  }
+
+  tuneDrawProgress(0);
+  const TuneResult r = speedTune((uint8_t)p, tuneDrawProgress, tuneCancelByButton);
+
+  char line[24];
+  if (r.ok)             snprintf(line, sizeof(line), "%d mm/s %d mm/s2", (int)r.maxMmS, (int)r.accelMmS2);
+  else if (r.cancelled) snprintf(line, sizeof(line), "Cancelled");
+  else                  snprintf(line, sizeof(line), "%s", encoderIsPresent() ? "No clean trial" : "No encoder");
+  wizardFrameStart("OK");
+  wizardCenterTwo("Auto-tune", line);
+  while (true) {
+    updateRotary();
+    if (isSelectPressed() || isBackPressed()) return;
+    idleDimmerTick();
+    delay(10);
+  }
+}
+
+#endif
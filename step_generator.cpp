@@ -0,0 +1,158 @@
+// Step generator state and the timer ISR, which runs from IRAM.
+#include "step_generator.h"
+
+hw_timer_t*       g_stepTimer = nullptr;
+volatile int32_t  g_axisPos[MOTION_AXES] = {0};
+int8_t            g_axisDir[MOTION_AXES] = {0};
+uint32_t          g_axisN[MOTION_AXES]   = {0};
+uint32_t          g_axisErr[MOTION_AXES] = {0};
+uint32_t          g_segTicks = 0;
+portMUX_TYPE      g_stepMux = portMUX_INITIALIZER_UNLOCKED;
+volatile bool     g_settlePending = false;
+volatile uint32_t g_settleStartUs = 0;
+volatile uint32_t g_dwellStartUs  = 0;
+
+volatile bool     g_velMode     = false;
+uint32_t          g_velPeriodUs = 0;
+int8_t            g_velDir      = 0;
+uint32_t          g_velAccUs    = 0;
+uint32_t          g_velAlarmUs  = STEPGEN_VEL_POLL_US;
+int32_t           g_velMinPos   = 0;
+int32_t           g_velMaxPos   = 0;
+volatile bool     g_stepGenHold = false;
+
+volatile bool     g_crawlMode    = false;
+volatile bool     g_crawlDone    = false;
+uint64_t          g_crawlRateQ32 = 0;
+uint64_t          g_crawlPhase   = 0;
+int8_t            g_crawlDir     = 0;
+uint32_t          g_crawlWaitUs  = CRAWL_MAX_WAIT_US;
+uint8_t           g_crawlBoost   = 1;
+int8_t            g_crawlSub     = 0;
+uint32_t          g_crawlLeft    = 0;
+
+uint32_t IRAM_ATTR stepGenLoadSegment() {
+  while (true) {
+    if (plan.cur == plan.loopEnd && plan.loopsDone + 1 < plan.loops && plan.loopStart < plan.loopEnd) {
+      plan.loopsDone = plan.loopsDone + 1;
+      plan.cur = plan.loopStart;
+    }
+    if (plan.cur >= plan.count) return 0;
+    const PlanSegment& s = plan.seg[plan.cur];
+    const uint32_t ticks = planSegTicks(s);
+    if (ticks == 0) {
+      if (s.dwellMs == 0) { plan.cur = plan.cur + 1; continue; }
+      plan.segLeft = 0;
+      g_dwellStartUs = micros();
+      if (s.flags & PLAN_SEG_SETTLE) { g_settlePending = true; g_settleStartUs = g_dwellStartUs; }
+      return (uint32_t)min<uint64_t>((uint64_t)s.dwellMs * 1000ULL, UINT32_MAX);
+    }
+    g_segTicks = ticks;
+    for (uint8_t a = 0; a < MOTION_AXES; ++a) {
+      const int32_t st = s.steps[a];
+      g_axisN[a]   = (uint32_t)(st < 0 ? -st : st);
+      g_axisErr[a] = ticks / 2;                     // centre the spread
+      if (st) { g_axisDir[a] = st > 0 ? 1 : -1; axisSetDir(a, st > 0); }
+    }
+    plan.segLeft = ticks;
+    return s.usPerStep;
+  }
+}
+
+static inline void IRAM_ATTR stepGenVelocityTick() {
+  portENTER_CRITICAL_ISR(&g_stepMux);
+  const uint32_t per = g_velPeriodUs;
+  const int8_t   dir = g_velDir;
+  portEXIT_CRITICAL_ISR(&g_stepMux);
+
+  uint32_t next = STEPGEN_VEL_POLL_US;
+  if (per == 0 || dir == 0) {
+    g_velAccUs = 0xFFFF;              // holding: step at once when a period arrives
+  } else {
+    g_velAccUs += g_velAlarmUs;
+    if (g_velAccUs >= per) {
+      g_velAccUs = min(g_velAccUs - per, per - 1);
+      const int32_t pos = g_axisPos[AXIS_SLIDE] + dir;
+      if (pos >= g_velMinPos && pos <= g_velMaxPos) {
+        if (g_axisDir[AXIS_SLIDE] != dir) { g_axisDir[AXIS_SLIDE] = dir; axisSetDir(AXIS_SLIDE, dir > 0); }
+        axisStepPulseMask(1u << AXIS_SLIDE);
+        g_axisPos[AXIS_SLIDE] = pos;
+      }
+    }
+    next = min<uint32_t>(per - g_velAccUs, STEPGEN_VEL_POLL_US);
+  }
+  if (next != g_velAlarmUs) { g_velAlarmUs = next; timerAlarmWrite(g_stepTimer, next, true); }
+}
+
+uint32_t IRAM_ATTR stepGenCrawlWait() {
+  if (g_crawlRateQ32 == 0 || g_crawlDir == 0) return CRAWL_MAX_WAIT_US;
+  const uint64_t need = g_crawlPhase >= CRAWL_STEP_PHASE ? 0 : CRAWL_STEP_PHASE - g_crawlPhase;
+  const uint64_t us = (need + g_crawlRateQ32 - 1) / g_crawlRateQ32;
+  return (uint32_t)clampT<uint64_t>(us, CRAWL_MIN_WAIT_US, CRAWL_MAX_WAIT_US);
+}
+
+static inline void IRAM_ATTR stepGenCrawlTick() {
+  portENTER_CRITICAL_ISR(&g_stepMux);
+  g_crawlPhase += g_crawlRateQ32 * g_crawlWaitUs;
+  if (g_crawlPhase >= CRAWL_STEP_PHASE && g_crawlDir != 0) {
+    g_crawlPhase -= CRAWL_STEP_PHASE;
+    const int8_t dir = g_crawlDir;
+    const int32_t pos = g_axisPos[AXIS_SLIDE] + dir;
+    if (g_crawlSub == 0 && (pos < g_velMinPos || pos > g_velMaxPos)) {
+      g_crawlDone = true;
+    } else {
+      if (g_axisDir[AXIS_SLIDE] != dir) { g_axisDir[AXIS_SLIDE] = dir; axisSetDir(AXIS_SLIDE, dir > 0); }
+      axisStepPulseMask(1u << AXIS_SLIDE);
+      g_crawlSub += dir;
+      if (g_crawlSub == g_crawlBoost || g_crawlSub == -g_crawlBoost) {
+        g_crawlSub = 0;
+        g_axisPos[AXIS_SLIDE] = pos;
+        if (g_crawlLeft && --g_crawlLeft == 0) g_crawlDone = true;
+      }
+    }
+  }
+  if (g_crawlDone) {
+    timerAlarmDisable(g_stepTimer);
+  } else {
+    const uint32_t next = stepGenCrawlWait();
+    if (next != g_crawlWaitUs) { g_crawlWaitUs = next; timerAlarmWrite(g_stepTimer, next, true); }
+  }
+  portEXIT_CRITICAL_ISR(&g_stepMux);
+}
+
+void IRAM_ATTR stepGenIsr() {
+  if (g_velMode) { stepGenVelocityTick(); return; }
+  if (g_crawlMode) { stepGenCrawlTick(); return; }
+  if (!plan.active) { timerAlarmDisable(g_stepTimer); return; }
+
+  if (plan.segLeft > 0) {
+    uint8_t mask = 0;
+    for (uint8_t a = 0; a < MOTION_AXES; ++a) {
+      g_axisErr[a] += g_axisN[a];
+      if (g_axisErr[a] >= g_segTicks) {
+        g_axisErr[a] -= g_segTicks;
+        mask |= (uint8_t)(1u << a);
+        g_axisPos[a] = g_axisPos[a] + g_axisDir[a];
+      }
+    }
+    axisStepPulseMask(mask);
+    plan.segLeft = plan.segLeft - 1;
+    plan.stepsDone = plan.stepsDone + 1;
+    if (plan.segLeft > 0) return;
+  }
+
+  // segment or dwell finished: the next one's period starts now, which also
+  // gives DIR a full period to settle before its first pulse
+  portENTER_CRITICAL_ISR(&g_stepMux);
+  g_settlePending = false;
+  plan.cur = plan.cur + 1;
+  uint32_t us = stepGenLoadSegment();
+  if (us == 0) {
+    plan.active = false; timerAlarmDisable(g_stepTimer);
+    frec(FR_PLAN_END, 0, 0, (int32_t)plan.stepsDone); frecPlanActive(false);
+  } else {
+    timerAlarmWrite(g_stepTimer, us, true);
+    frec(FR_SEG, 0, plan.cur, g_axisPos[AXIS_SLIDE]);
+  }
+  portEXIT_CRITICAL_ISR(&g_stepMux);
+}
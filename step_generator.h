@@ -0,0 +1,296 @@
+#ifndef STEP_GENERATOR_H
+#define STEP_GENERATOR_H
+
+// Background step generator: a hardware timer walks the compiled MotionPlan
+// one pulse per alarm, so a running job no longer depends on loop() timing,
+// blocking screens or Wi-Fi.
+
+#include <Arduino.h>
+#include "config.h"
+#include "motor_control.h"
+#include "motion_plan.h"
+#include "flight_recorder.h"
+
+#ifndef STEPGEN_TIMER_ID
+  #define STEPGEN_TIMER_ID 0
+#endif
+
+extern hw_timer_t*       g_stepTimer;
+extern volatile int32_t  g_axisPos[MOTION_AXES];   // absolute microsteps, 0 = power-on position
+extern int8_t            g_axisDir[MOTION_AXES];
+extern uint32_t          g_axisN[MOTION_AXES];     // |steps| of the current segment
+extern uint32_t          g_axisErr[MOTION_AXES];   // Bresenham accumulators
+extern uint32_t          g_segTicks;
+extern portMUX_TYPE      g_stepMux;
+extern volatile bool     g_settlePending;          // a settle dwell is running
+extern volatile uint32_t g_settleStartUs;
+extern volatile uint32_t g_dwellStartUs;           // start of the dwell in progress
+
+// Velocity mode (manual_drive.h): instead of walking a plan, the ISR steps
+// the slide at a period published by the drive's control tick. The alarm
+// never sleeps longer than STEPGEN_VEL_POLL_US, so a new period takes
+// effect within that even when the current one is long.
+#ifndef STEPGEN_VEL_POLL_US
+  #define STEPGEN_VEL_POLL_US 1000
+#endif
+extern volatile bool     g_velMode;
+extern uint32_t          g_velPeriodUs;   // 0 = hold still
+extern int8_t            g_velDir;
+extern uint32_t          g_velAccUs;      // time since the last step
+extern uint32_t          g_velAlarmUs;
+extern int32_t           g_velMinPos;     // travel limits, steps
+extern int32_t           g_velMaxPos;
+extern volatile bool     g_stepGenHold;   // motors handed over (hand-guided take)
+
+// Crawl mode (crawl.h): ultra-slow constant rate for long timelapse and
+// astro moves. The rate is steps/s in Q32.32 and a 64-bit phase gathers
+// rate x elapsed us; a step falls due each time it passes one step
+// (1e6 << 32). The alarm is set straight to that microsecond, so the ISR
+// runs once per step rather than polling, and the rounding of every wait
+// stays in the phase: no drift however long the move.
+//
+// With TMC_MS1_PIN/TMC_MS2_PIN wired (TMC2209 standalone) the driver is
+// switched to CRAWL_MICROSTEP for the crawl and g_crawlSub counts the fine
+// steps inside one base microstep, so g_axisPos keeps its units.
+#ifndef CRAWL_MIN_WAIT_US
+  #define CRAWL_MIN_WAIT_US 50
+#endif
+#ifndef CRAWL_MAX_WAIT_US
+  #define CRAWL_MAX_WAIT_US 10000000UL   // wake at least every 10 s
+#endif
+#ifndef CRAWL_MICROSTEP
+  #define CRAWL_MICROSTEP 64
+#endif
+static const uint64_t    CRAWL_STEP_PHASE = 1000000ULL << 32;
+extern volatile bool     g_crawlMode;
+extern volatile bool     g_crawlDone;      // limit or distance reached; crawlLoop() ends it
+extern uint64_t          g_crawlRateQ32;   // fine steps/s, Q32.32
+extern uint64_t          g_crawlPhase;
+extern int8_t            g_crawlDir;
+extern uint32_t          g_crawlWaitUs;    // armed alarm period
+extern uint8_t           g_crawlBoost;     // fine steps per base microstep
+extern int8_t            g_crawlSub;       // fine steps past g_axisPos, signed
+extern uint32_t          g_crawlLeft;      // base steps to go, 0 = to the limit
+
+// The step ISR and what it runs live in step_generator.cpp, in IRAM.
+// Load plan.seg[plan.cur] (handling loop wrap); returns the first alarm period
+// in µs, or 0 when the plan is finished.
+uint32_t stepGenLoadSegment();
+// Due time of the next fine crawl step from the current phase, in us.
+uint32_t stepGenCrawlWait();
+void     stepGenIsr();
+
+inline void stepGenInit() {
+  if (g_stepTimer) return;
+  g_stepTimer = timerBegin(STEPGEN_TIMER_ID, 80, true);  // 1 MHz tick
+  timerAttachInterrupt(g_stepTimer, &stepGenIsr, true);
+}
+
+// Start executing `plan` from its first segment.
+inline bool planStart() {
+  if (g_velMode || g_crawlMode || g_stepGenHold) return false;
+  stepGenInit();
+  timerAlarmDisable(g_stepTimer);
+  plan.cur = 0; plan.loopsDone = 0; plan.stepsDone = 0; plan.segLeft = 0;
+  g_settlePending = false;
+  uint32_t us = stepGenLoadSegment();
+  if (us == 0) { plan.active = false; return false; }
+  plan.startedMs = millis();
+  frec(FR_PLAN_START, 0, plan.count, (int32_t)plan.totalSteps); frecPlanActive(true);
+  plan.active = true;
+  timerWrite(g_stepTimer, 0);
+  timerAlarmWrite(g_stepTimer, us, true);
+  timerAlarmEnable(g_stepTimer);
+  return true;
+}
+
+// Start `plan` partway through, as a power-loss resume (resume.h) needs:
+// segment cur of loop pass loopsDone, with `done` ticks (or ms of a dwell)
+// already run. The carriage must already be where that point leaves it.
+inline bool planStartAt(uint16_t cur, uint16_t loopsDone, uint32_t done) {
+  if (g_velMode || g_crawlMode || g_stepGenHold || cur >= plan.count || loopsDone >= plan.loops) return false;
+  stepGenInit();
+  timerAlarmDisable(g_stepTimer);
+  plan.cur = cur; plan.loopsDone = loopsDone; plan.segLeft = 0;
+  g_settlePending = false;
+  uint32_t us = stepGenLoadSegment();
+  if (us == 0 || plan.cur != cur) { plan.active = false; return false; }
+
+  uint64_t before = 0, body = 0;
+  for (uint16_t i = 0; i < plan.count; ++i) {
+    const uint32_t n = planSegTicks(plan.seg[i]);
+    if (i < cur) before += n;
+    if (i >= plan.loopStart && i < plan.loopEnd) body += n;
+  }
+  uint32_t k = 0;
+  if (plan.segLeft) {
+    // part-run segment: the Bresenham state after k ticks, err0 = ticks/2
+    k = min(done, g_segTicks - 1);
+    for (uint8_t a = 0; a < MOTION_AXES; ++a)
+      g_axisErr[a] = (uint32_t)(((uint64_t)(g_segTicks / 2) + (uint64_t)k * g_axisN[a]) % g_segTicks);
+    plan.segLeft = g_segTicks - k;
+  } else {
+    const uint32_t ms = us / 1000;
+    us = (ms > done ? ms - done : 1) * 1000;        // what is left of the dwell
+  }
+  plan.stepsDone = (uint32_t)(before + body * loopsDone + k);
+  plan.startedMs = millis();
+  frec(FR_PLAN_START, 1, plan.count, (int32_t)plan.totalSteps); frecPlanActive(true);
+  plan.active = true;
+  timerWrite(g_stepTimer, 0);
+  timerAlarmWrite(g_stepTimer, us, true);
+  timerAlarmEnable(g_stepTimer);
+  return true;
+}
+
+// Microseconds until the step ISR next runs (large when nothing runs); a
+// flash erase stalls interrupts, so callers wait for a gap this long.
+inline uint32_t stepGenQuietUs() {
+  if (!g_stepTimer || !(plan.active || g_velMode || g_crawlMode)) return UINT32_MAX;
+  const uint64_t alarm = timerAlarmRead(g_stepTimer), now = timerRead(g_stepTimer);
+  return alarm > now ? (uint32_t)min<uint64_t>(alarm - now, UINT32_MAX) : 0;
+}
+
+inline void planStop() {
+  if (plan.active) { frec(FR_PLAN_STOP, 0, plan.cur, (int32_t)plan.stepsDone); frecPlanActive(false); }
+  plan.active = false; g_settlePending = false;
+}
+
+// Cut the running settle dwell short; false if it already ran out.
+inline bool stepGenEndSettle() {
+  bool ended = false;
+  portENTER_CRITICAL(&g_stepMux);
+  if (plan.active && g_settlePending) {
+    g_settlePending = false;
+    timerWrite(g_stepTimer, 0);
+    timerAlarmWrite(g_stepTimer, 10, true);   // next segment in 10 µs
+    ended = true;
+  }
+  portEXIT_CRITICAL(&g_stepMux);
+  return ended;
+}
+inline bool planRunning() { return plan.active; }
+
+// ---------- velocity mode ----------
+// Hand the timer to velocity mode (false while a plan runs).
+inline bool stepGenVelocityBegin() {
+  if (plan.active || g_crawlMode || g_stepGenHold) return false;
+  if (g_velMode) return true;
+  stepGenInit();
+  const AxisConfig& ax = g_axes[AXIS_SLIDE];
+  g_velMinPos = (int32_t)lroundf(ax.minPos * stepsPerMM());
+  g_velMaxPos = (int32_t)lroundf(ax.maxPos * stepsPerMM());
+  g_velPeriodUs = 0; g_velDir = 0;
+  g_velAccUs = 0xFFFF;
+  g_velAlarmUs = STEPGEN_VEL_POLL_US;
+  timerAlarmDisable(g_stepTimer);
+  g_velMode = true;
+  frecPlanActive(true);
+  timerWrite(g_stepTimer, 0);
+  timerAlarmWrite(g_stepTimer, g_velAlarmUs, true);
+  timerAlarmEnable(g_stepTimer);
+  return true;
+}
+// Step period in µs and direction; 0 period holds.
+inline void stepGenVelocitySet(uint32_t periodUs, int8_t dir) {
+  portENTER_CRITICAL(&g_stepMux);
+  g_velPeriodUs = periodUs;
+  g_velDir = dir;
+  portEXIT_CRITICAL(&g_stepMux);
+}
+inline void stepGenVelocityEnd() {
+  if (!g_velMode) return;
+  timerAlarmDisable(g_stepTimer);
+  g_velMode = false;
+  frecPlanActive(false);
+}
+// ---------- crawl mode ----------
+// Fine steps per base microstep the driver can be switched to (1 = none).
+inline uint8_t stepGenCrawlBoostFor(uint16_t microstep) {
+  if (!microstepPinsWired() || !microstepPinsValid(microstep) || !microstepPinsValid(CRAWL_MICROSTEP)) return 1;
+  return CRAWL_MICROSTEP > microstep ? (uint8_t)(CRAWL_MICROSTEP / microstep) : 1;
+}
+
+inline uint64_t stepGenCrawlQ32(float baseRate) {
+  return (uint64_t)llroundf(fabsf(baseRate) * g_crawlBoost * 4294967296.0f);
+}
+
+// Start crawling at rate base steps/s (signed) for `steps` base steps
+// (0 = until a travel limit). False while anything else drives the motors.
+inline bool stepGenCrawlBegin(float rate, uint32_t steps) {
+  if (plan.active || g_velMode || g_crawlMode || g_stepGenHold) return false;
+  stepGenInit();
+  timerAlarmDisable(g_stepTimer);
+  const AxisConfig& ax = g_axes[AXIS_SLIDE];
+  g_velMinPos = (int32_t)lroundf(ax.minPos * stepsPerMM());
+  g_velMaxPos = (int32_t)lroundf(ax.maxPos * stepsPerMM());
+  g_crawlBoost = stepGenCrawlBoostFor(ax.microstep);
+  g_crawlSub = 0;
+  g_crawlLeft = steps;
+  g_crawlDone = false;
+  g_crawlRateQ32 = stepGenCrawlQ32(rate);
+  g_crawlDir = rate > 0.0f ? 1 : (rate < 0.0f ? -1 : 0);
+  g_crawlPhase = CRAWL_STEP_PHASE / 2;            // first step half a period in
+  g_crawlWaitUs = stepGenCrawlWait();
+  if (g_crawlBoost > 1) microstepPinsApply(CRAWL_MICROSTEP);
+  g_crawlMode = true;
+  frecPlanActive(true);
+  timerWrite(g_stepTimer, 0);
+  timerAlarmWrite(g_stepTimer, g_crawlWaitUs, true);
+  timerAlarmEnable(g_stepTimer);
+  return true;
+}
+
+// Change the rate mid-crawl; the time already waited is credited first.
+inline void stepGenCrawlSet(float rate) {
+  if (!g_crawlMode) return;
+  portENTER_CRITICAL(&g_stepMux);
+  const uint64_t waited = min<uint64_t>(timerRead(g_stepTimer), g_crawlWaitUs);
+  g_crawlPhase += g_crawlRateQ32 * waited;
+  g_crawlRateQ32 = stepGenCrawlQ32(rate);
+  g_crawlDir = rate > 0.0f ? 1 : (rate < 0.0f ? -1 : 0);
+  g_crawlWaitUs = stepGenCrawlWait();
+  timerWrite(g_stepTimer, 0);
+  timerAlarmWrite(g_stepTimer, g_crawlWaitUs, true);
+  portEXIT_CRITICAL(&g_stepMux);
+}
+
+// Stop, finish any part-done base microstep and restore the microstep mode.
+inline void stepGenCrawlEnd() {
+  if (!g_crawlMode) return;
+  timerAlarmDisable(g_stepTimer);
+  const int8_t dir = g_crawlSub > 0 ? 1 : -1;
+  if (g_crawlSub) { g_axisDir[AXIS_SLIDE] = dir; axisSetDir(AXIS_SLIDE, dir > 0); }
+  while (g_crawlSub != 0) {
+    axisStepPulseMask(1u << AXIS_SLIDE);
+    g_crawlSub += dir;
+    if (g_crawlSub == dir * g_crawlBoost) { g_crawlSub = 0; g_axisPos[AXIS_SLIDE] = g_axisPos[AXIS_SLIDE] + dir; }
+    delayMicroseconds(CRAWL_MIN_WAIT_US * 4);
+  }
+  if (g_crawlBoost > 1) microstepPinsApply(g_axes[AXIS_SLIDE].microstep);
+  g_crawlBoost = 1;
+  g_crawlMode = false;
+  frecPlanActive(false);
+}
+
+// Anything driving the motors: a plan, velocity or crawl mode, or a hand-guided take
+inline bool motionBusy() { return plan.active || g_velMode || g_crawlMode || g_stepGenHold; }
+
+inline int32_t axisPosition(uint8_t a) { return g_axisPos[a]; }
+inline float   axisPositionUnits(uint8_t a) { return g_axisPos[a] / axisStepsPerUnit(a); }
+inline int32_t stepPosition() { return g_axisPos[AXIS_SLIDE]; }
+inline float   stepPositionMM() { return axisPositionUnits(AXIS_SLIDE); }
+
+// Jog: relative move at a percentage speed (ignored while a plan runs).
+inline bool moveDeltaMM(float mm, int speedPct) {
+  if (motionBusy()) return false;               // before planReset(): keep a loaded plan
+  frec(FR_JOG, 0, 0, lroundf(mm * 1000.0f));
+  planReset();
+  int32_t steps = (int32_t)lroundf(mm * stepsPerMM());
+  float rate = 1e6f / usPerStepForPercent((uint8_t)clampT(speedPct, 5, 100));
+  if (planAddMoveAtRate(steps, rate) != PLAN_OK) return false;
+  planFinalize(1);
+  return planStart();
+}
+
+#endif
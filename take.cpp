@@ -0,0 +1,5 @@
+// Take store and its partition.
+#include "take.h"
+
+TakeStore g_take;
+const esp_partition_t* g_takePart = nullptr;
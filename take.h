@@ -0,0 +1,455 @@
+#ifndef TAKE_H
+#define TAKE_H
+
+// Hand-guided takes: record a move by pushing the carriage with the driver
+// disabled, then play it back through the step generator.
+//
+// Recording samples the AS5600 at TAKE_RATE_HZ from an esp_timer, unwraps
+// the angle and holds it through a small deadband so sensor jitter at rest
+// records as stillness. Samples are stored as second differences (change
+// of velocity) in a nibble stream:
+//   0..12  dd = n - 6
+//   13 r   run of r + 2 samples with dd = 0
+//   14 ..  escape: zigzag dd, 3 bits per nibble, bit 3 = more follows
+// A steady hand changes velocity by a count or two per sample, so most
+// samples cost half a byte and a resting carriage 1/17 of a byte: a minute
+// of movement is ~15 KB. The buffer is in PSRAM when the board has it and
+// the last take is kept in the "take" flash partition.
+//
+// Playback first moves to the take's start, then a 1 kHz tick decodes ahead,
+// smooths with a centred moving average and tracks the resulting position
+// in velocity mode (feed-forward velocity plus a proportional correction,
+// clamped to the axis acceleration), at 1x or a scaled speed.
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <esp_partition.h>
+#include "config.h"
+#include "motor_control.h"
+#include "step_generator.h"
+#include "manual_drive.h"
+#include "encoder_utils.h"
+#include "rig_scale.h"
+#include "flight_recorder.h"
+#include "http_router.h"
+
+#ifndef TAKE_RATE_HZ
+  #define TAKE_RATE_HZ 500
+#endif
+#ifndef TAKE_DEADBAND
+  #define TAKE_DEADBAND 1              // counts of jitter ignored at rest
+#endif
+#ifndef TAKE_SMOOTH
+  #define TAKE_SMOOTH 16               // moving-average width, samples (even)
+#endif
+#ifndef TAKE_KP
+  #define TAKE_KP 20.0f                // position correction, 1/s
+#endif
+#ifndef TAKE_TICK_US
+  #define TAKE_TICK_US 1000
+#endif
+#ifndef TAKE_PSRAM_BYTES
+  #define TAKE_PSRAM_BYTES (256 * 1024)
+#endif
+#ifndef TAKE_RAM_BYTES
+  #define TAKE_RAM_BYTES (32 * 1024)
+#endif
+#define TAKE_RING 64                   // decoded samples kept for the average
+static_assert(TAKE_SMOOTH >= 2 && TAKE_SMOOTH % 2 == 0 && TAKE_SMOOTH + 4 <= TAKE_RING, "TAKE_SMOOTH");
+
+static const uint32_t TAKE_MAGIC = 0x454B4154; // 'TAKE'
+
+struct TakeHeader {
+  uint32_t magic;
+  uint16_t rateHz;
+  uint16_t reserved;
+  uint32_t samples;        // positions after the implicit 0 at the start
+  uint32_t bytes;          // code length
+  int32_t  startSteps;     // slide position the take starts at
+  int32_t  endCounts;      // last position, counts from the start
+  uint32_t stepsPerCountQ16;  // scale it was recorded with
+};
+
+enum TakeState : uint8_t { TAKE_IDLE = 0, TAKE_RECORDING, TAKE_SEEKING, TAKE_PLAYING };
+
+// ---------- codec ----------
+struct TakeWriter {
+  uint8_t* buf = nullptr;
+  uint32_t capNib = 0;
+  uint32_t nib = 0;          // nibbles written
+  int32_t  prev = 0, prevV = 0;
+  uint32_t zeros = 0;        // pending run of dd = 0
+  uint32_t samples = 0;
+
+  void begin(uint8_t* b, uint32_t cap) { buf = b; capNib = cap * 2; nib = 0; prev = prevV = 0; zeros = 0; samples = 0; }
+  void put4(uint8_t v) {
+    uint8_t& b = buf[nib >> 1];
+    if (nib & 1) b = (uint8_t)((b & 0x0F) | (v << 4));
+    else         b = v & 0x0F;
+    nib++;
+  }
+  void flushZeros() {
+    if (zeros == 1)      put4(6);
+    else if (zeros >= 2) { put4(13); put4((uint8_t)(zeros - 2)); }
+    zeros = 0;
+  }
+  // Room for one more sample, worst case (run + 11-nibble escape)?
+  bool room() const { return nib + 2 + 12 <= capNib; }
+  bool add(int32_t p) {
+    if (!room()) return false;
+    const int32_t v = p - prev, dd = v - prevV;
+    prev = p; prevV = v; samples++;
+    if (dd == 0) { if (++zeros == 17) flushZeros(); return true; }
+    flushZeros();
+    if (dd >= -6 && dd <= 6) { put4((uint8_t)(dd + 6)); return true; }
+    put4(14);
+    uint32_t z = ((uint32_t)dd << 1) ^ (uint32_t)(dd >> 31);
+    do { uint8_t n = z & 7; z >>= 3; put4(n | (z ? 8 : 0)); } while (z);
+    return true;
+  }
+  uint32_t finish() { flushZeros(); return (nib + 1) >> 1; }
+};
+
+struct TakeReader {
+  const uint8_t* buf = nullptr;
+  uint32_t lenNib = 0, nib = 0;
+  int32_t  prev = 0, prevV = 0;
+  uint32_t zeros = 0;
+
+  void begin(const uint8_t* b, uint32_t bytes) { buf = b; lenNib = bytes * 2; nib = 0; prev = prevV = 0; zeros = 0; }
+  bool get4(uint8_t& v) {
+    if (nib >= lenNib) return false;
+    v = (buf[nib >> 1] >> ((nib & 1) * 4)) & 0x0F;
+    nib++;
+    return true;
+  }
+  bool next(int32_t& p) {
+    int32_t dd = 0;
+    if (zeros) zeros--;
+    else {
+      uint8_t n;
+      if (!get4(n)) return false;
+      if (n <= 12) dd = (int32_t)n - 6;
+      else if (n == 13) { uint8_t r; if (!get4(r)) return false; zeros = r + 1u; }
+      else if (n == 14) {
+        uint32_t z = 0;
+        for (int shift = 0; ; shift += 3) {
+          if (shift > 33 || !get4(n)) return false;
+          z |= (uint32_t)(n & 7) << shift;
+          if (!(n & 8)) break;
+        }
+        dd = (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+      } else return false;
+    }
+    prevV += dd; prev += prevV;
+    p = prev;
+    return true;
+  }
+};
+
+// ---------- state ----------
+struct TakeStore {
+  volatile TakeState state = TAKE_IDLE;
+  TakeHeader hdr = {};         // current take (magic 0 = none)
+  uint8_t*   buf = nullptr;
+  uint32_t   cap = 0;
+  bool       saved = false;
+  esp_timer_handle_t recTimer = nullptr, playTimer = nullptr;
+
+  // recording
+  TakeWriter w;
+  uint16_t   lastRaw = 0;
+  int32_t    acc = 0, held = 0;
+  uint16_t   i2cErrors = 0;
+  volatile bool full = false;
+
+  // playback
+  TakeReader r;
+  int32_t    ring[TAKE_RING];
+  uint32_t   have = 0;         // samples decoded (index 0 = start)
+  float      t = 0.0f;         // playback position, samples
+  float      scale = 1.0f;
+  float      k = 1.0f;         // steps per count
+  float      v = 0.0f;         // commanded steps/s
+  float      lagMax = 0.0f;    // worst tracking error, steps
+  uint32_t   doneMs = 0;
+  volatile bool stopReq = false;
+  volatile bool stopping = false;   // tick released velocity mode; loop tears down
+};
+extern TakeStore g_take;
+extern const esp_partition_t* g_takePart;
+
+inline const char* takeStateName(TakeState s) {
+  switch (s) {
+    case TAKE_RECORDING: return "recording";
+    case TAKE_SEEKING:   return "seeking";
+    case TAKE_PLAYING:   return "playing";
+    default:             return "idle";
+  }
+}
+inline TakeState takeState()   { return g_take.state; }
+inline bool      takeHave()    { return g_take.hdr.magic == TAKE_MAGIC; }
+inline float     takeSeconds() {
+  const TakeHeader& h = g_take.hdr;
+  const uint32_t n = g_take.state == TAKE_RECORDING ? g_take.w.samples : h.samples;
+  return n / (float)TAKE_RATE_HZ;
+}
+inline float takeProgress() {
+  if (g_take.state != TAKE_PLAYING || !g_take.hdr.samples) return 0.0f;
+  return min(1.0f, g_take.t / g_take.hdr.samples);
+}
+
+inline bool takeAlloc() {
+  static MemStats mem;
+  if (g_take.buf) return true;
+  g_take.buf = (uint8_t*)memReserve(mem, "take", TAKE_PSRAM_BYTES, TAKE_RAM_BYTES);
+  g_take.cap = g_take.buf ? mem.cap : 0;
+  return g_take.buf != nullptr;
+}
+
+inline bool takeTimer(esp_timer_handle_t& t, esp_timer_cb_t cb, const char* name) {
+  if (t) return true;
+  esp_timer_create_args_t args = {};
+  args.callback = cb;
+  args.name = name;
+  return esp_timer_create(&args, &t) == ESP_OK;
+}
+
+// ---------- flash ----------
+// Header at 0, code after it; the header goes last so a torn save reads as empty.
+inline bool takeSave() {
+  if (!g_takePart || !takeHave()) return false;
+  const uint32_t len = sizeof(TakeHeader) + g_take.hdr.bytes;
+  if (len > g_takePart->size) return false;
+  const uint32_t erase = (len + 4095) & ~4095u;
+  if (esp_partition_erase_range(g_takePart, 0, erase) != ESP_OK) return false;
+  if (esp_partition_write(g_takePart, sizeof(TakeHeader), g_take.buf, g_take.hdr.bytes) != ESP_OK) return false;
+  if (esp_partition_write(g_takePart, 0, &g_take.hdr, sizeof(TakeHeader)) != ESP_OK) return false;
+  g_take.saved = true;
+  return true;
+}
+
+// Bring the saved take into RAM (after a reboot).
+inline bool takeLoad() {
+  if (takeHave()) return true;
+  if (!g_takePart) g_takePart = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "take");
+  if (!g_takePart || !takeAlloc()) return false;
+  TakeHeader h;
+  if (esp_partition_read(g_takePart, 0, &h, sizeof(h)) != ESP_OK) return false;
+  if (h.magic != TAKE_MAGIC || h.rateHz != TAKE_RATE_HZ || h.bytes > g_take.cap) return false;
+  if (esp_partition_read(g_takePart, sizeof(h), g_take.buf, h.bytes) != ESP_OK) return false;
+  g_take.hdr = h;
+  g_take.saved = true;
+  return true;
+}
+
+// ---------- recording ----------
+// Runs in the esp_timer task at TAKE_RATE_HZ.
+inline void takeRecTick(void*) {
+  TakeStore& s = g_take;
+  if (s.state != TAKE_RECORDING || s.full) return;
+  uint16_t raw;
+  if (i2cRead16(AS5600_ADDR, REG_RAW_ANGLE, raw)) {
+    raw &= 0x0FFF;
+    s.acc += encoderRawDelta(s.lastRaw, raw);
+    s.lastRaw = raw;
+  } else {
+    s.i2cErrors++;                             // repeat the last position
+  }
+  if (s.acc > s.held + TAKE_DEADBAND) s.held = s.acc - TAKE_DEADBAND;
+  if (s.acc < s.held - TAKE_DEADBAND) s.held = s.acc + TAKE_DEADBAND;
+  if (!s.w.add(s.held)) s.full = true;         // loop() finishes the take
+}
+
+// Disable the driver and start sampling. The previous take is dropped.
+inline bool takeRecordStart() {
+  if (g_take.state != TAKE_IDLE || motionBusy() || !encoderIsPresent() || !takeAlloc()) return false;
+  if (!takeTimer(g_take.recTimer, &takeRecTick, "take-rec")) return false;
+  g_stepGenHold = true;
+  motorEnable(false);
+
+  TakeStore& s = g_take;
+  s.hdr = TakeHeader();
+  s.saved = false;
+  s.hdr.startSteps = g_axisPos[AXIS_SLIDE];
+  s.hdr.stepsPerCountQ16 = rigScale().stepsPerCountQ16;
+  s.lastRaw = readRawAngle();
+  s.acc = s.held = 0;
+  s.i2cErrors = 0;
+  s.full = false;
+  s.w.begin(s.buf, s.cap);
+  s.state = TAKE_RECORDING;
+  frec(FR_TAKE, 1, 0, s.hdr.startSteps);
+  esp_timer_start_periodic(s.recTimer, 1000000 / TAKE_RATE_HZ);
+  return true;
+}
+
+// Stop sampling, take the carriage's new position and save to flash.
+inline void takeRecordStop() {
+  TakeStore& s = g_take;
+  if (s.state != TAKE_RECORDING) return;
+  esp_timer_stop(s.recTimer);
+  s.state = TAKE_IDLE;
+  s.hdr.bytes     = s.w.finish();
+  s.hdr.samples   = s.w.samples;
+  s.hdr.endCounts = s.held;
+  s.hdr.rateHz    = TAKE_RATE_HZ;
+  s.hdr.magic     = s.hdr.samples ? TAKE_MAGIC : 0;
+
+  g_axisPos[AXIS_SLIDE] = s.hdr.startSteps + scaleCountsToSteps(s.hdr.endCounts);
+  motorEnable(true);
+  g_stepGenHold = false;
+  frec(FR_TAKE, 0, (uint16_t)min<uint32_t>(s.hdr.bytes / 64, 0xFFFF), (int32_t)s.hdr.samples);
+  if (!g_takePart) g_takePart = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "take");
+  takeSave();
+}
+
+// ---------- playback ----------
+// Decoded position at sample j, clamped to the take's ends.
+inline int32_t takeAt(int32_t j) {
+  const int32_t last = min<int32_t>((int32_t)g_take.hdr.samples, (int32_t)g_take.have - 1);
+  j = clampT(j, (int32_t)0, max<int32_t>(last, 0));
+  return j == 0 ? 0 : g_take.ring[j % TAKE_RING];
+}
+
+// Decode far enough ahead to average around sample i.
+inline void takeDecodeTo(int32_t i) {
+  TakeStore& s = g_take;
+  const uint32_t want = (uint32_t)min<int32_t>(i + TAKE_SMOOTH / 2 + 1, (int32_t)s.hdr.samples);
+  int32_t p;
+  while (s.have <= want) {
+    if (s.have == 0) { s.have = 1; continue; }   // sample 0 is the start, not coded
+    if (!s.r.next(p)) break;
+    s.ring[s.have % TAKE_RING] = p;
+    s.have++;
+  }
+}
+
+inline float takeSmoothAt(int32_t i) {
+  int32_t sum = 0;
+  for (int32_t j = i - TAKE_SMOOTH / 2; j < i + TAKE_SMOOTH / 2; ++j) sum += takeAt(j);
+  return sum / (float)TAKE_SMOOTH;
+}
+
+// One control step; runs in the esp_timer task.
+inline void takePlayTick(void*) {
+  TakeStore& s = g_take;
+  if (s.state != TAKE_PLAYING || s.stopping) return;
+  const float dt = TAKE_TICK_US * 1e-6f;
+  const float A  = max(1.0f, g_axes[AXIS_SLIDE].accel);
+  const float vMax = driveMaxRate();
+  const float last = (float)s.hdr.samples;
+
+  float vCmd;
+  if (s.stopReq) {
+    vCmd = 0.0f;
+  } else {
+    const int32_t i = (int32_t)s.t;
+    const float   f = s.t - i;
+    takeDecodeTo(i + 1);
+    const float p0 = takeSmoothAt(i), p1 = takeSmoothAt(i + 1);
+    const float target = clampT(s.hdr.startSteps + s.k * (p0 + (p1 - p0) * f),
+                                (float)g_velMinPos, (float)g_velMaxPos);
+    const float ff  = s.t < last ? s.k * (p1 - p0) * TAKE_RATE_HZ * s.scale : 0.0f;
+    const float err = target - g_axisPos[AXIS_SLIDE];
+    if (fabsf(err) > s.lagMax) s.lagMax = fabsf(err);
+    vCmd = ff + TAKE_KP * err;
+    if (s.t >= last && fabsf(err) < 2.0f && !s.doneMs) s.doneMs = millis();
+    s.t = min(last, s.t + s.scale * TAKE_RATE_HZ * dt);
+  }
+  vCmd = clampT(vCmd, -vMax, vMax);
+  const float dv = A * dt;
+  float v = clampT(vCmd, s.v - dv, s.v + dv);
+  if (fabsf(v) <= DRIVE_START_RATE && fabsf(vCmd) <= DRIVE_START_RATE) v = vCmd;
+  s.v = v;
+
+  const float r = fabsf(v);
+  if (r < 1.0f) stepGenVelocitySet(0, 0);
+  else          stepGenVelocitySet((uint32_t)(1e6f / r), v > 0.0f ? 1 : -1);
+
+  // Finished (settled at the end) or stopped (ramped down): hand the timer back.
+  if ((s.doneMs && millis() - s.doneMs >= 100) || (s.stopReq && r < 1.0f)) {
+    stepGenVelocityEnd();
+    s.stopping = true;
+  }
+}
+
+inline void takePlayBegin() {
+  TakeStore& s = g_take;
+  if (!stepGenVelocityBegin() || !takeTimer(s.playTimer, &takePlayTick, "take-play")) {
+    s.state = TAKE_IDLE;
+    return;
+  }
+  s.r.begin(s.buf, s.hdr.bytes);
+  s.have = 0; s.t = 0.0f; s.v = 0.0f; s.lagMax = 0.0f; s.doneMs = 0;
+  s.stopping = false;
+  // Same scale as when recorded, unless the rig has been recalibrated since.
+  s.k = (s.hdr.stepsPerCountQ16 ? s.hdr.stepsPerCountQ16 : rigScale().stepsPerCountQ16) / 65536.0f;
+  s.state = TAKE_PLAYING;
+  frec(FR_TAKE, 2, (uint16_t)lroundf(s.scale * 100.0f), g_axisPos[AXIS_SLIDE]);
+  takePlayTick(nullptr);
+  esp_timer_start_periodic(s.playTimer, TAKE_TICK_US);
+}
+
+inline void takePlayRelease() {
+  TakeStore& s = g_take;
+  if (s.playTimer) esp_timer_stop(s.playTimer);
+  stepGenVelocityEnd();
+  s.state = TAKE_IDLE;
+  s.stopping = false;
+  s.v = 0.0f;
+  frec(FR_TAKE, 3, (uint16_t)min<float>(s.lagMax, 65535.0f), g_axisPos[AXIS_SLIDE]);
+}
+
+// Move to the start at seekPct, then play at scale (0.1..4).
+inline bool takePlay(float scale, int seekPct) {
+  if (g_take.state != TAKE_IDLE || motionBusy() || !takeLoad()) return false;
+  TakeStore& s = g_take;
+  s.scale = clampT(scale, 0.1f, 4.0f);
+  s.stopReq = false;
+  const int32_t d = s.hdr.startSteps - g_axisPos[AXIS_SLIDE];
+  if (d == 0) { takePlayBegin(); return s.state == TAKE_PLAYING; }
+  if (!moveDeltaMM(d / stepsPerMM(), seekPct)) return false;
+  s.state = TAKE_SEEKING;
+  return true;
+}
+
+// Recording ends; playback ramps down (seeking halts with the plan).
+inline void takeStop() {
+  switch (g_take.state) {
+    case TAKE_RECORDING: takeRecordStop(); break;
+    case TAKE_SEEKING:   planStop(); g_take.state = TAKE_IDLE; break;
+    case TAKE_PLAYING:   g_take.stopReq = true; break;
+    default: break;
+  }
+}
+
+// Call from loop().
+inline void takeLoop() {
+  TakeStore& s = g_take;
+  switch (s.state) {
+    case TAKE_RECORDING: if (s.full) takeRecordStop(); break;
+    case TAKE_SEEKING:   if (!plan.active) takePlayBegin(); break;
+    case TAKE_PLAYING:   if (s.stopping) takePlayRelease(); break;
+    default: break;
+  }
+}
+
+// GET /api/take → {"state":"idle","have":true,"seconds":..,"bytes":..,..}
+inline void takeStatusJson(HttpResponse& r) {
+  const TakeStore& s = g_take;
+  const bool rec = s.state == TAKE_RECORDING;
+  r.type = "application/json";
+  r.add("{\"state\":\"").add(takeStateName(s.state))
+   .add("\",\"have\":").add(takeHave() || rec ? "true" : "false")
+   .add(",\"seconds\":").add(takeSeconds(), 2)
+   .add(",\"bytes\":").add((long)(rec ? (s.w.nib + 1) / 2 : s.hdr.bytes))
+   .add(",\"capacity\":").add((long)s.cap)
+   .add(",\"saved\":").add(s.saved ? "true" : "false")
+   .add(",\"scale\":").add(s.scale, 2)
+   .add(",\"progress\":").add(takeProgress(), 3)
+   .add(",\"lagMaxSteps\":").add((long)lroundf(s.lagMax))
+   .add(",\"i2cErrors\":").add((long)s.i2cErrors).add("}");
+}
+
+#endif
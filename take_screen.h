@@ -0,0 +1,64 @@
+#ifndef TAKE_SCREEN_H
+#define TAKE_SCREEN_H
+
+#include "wizard_ui.h"
+#include "ui_helpers.h"
+#include "rotary_input.h"
+#include "control.h"
+
+// Record / play a hand-guided take (take.h). The knob picks Record or a
+// playback speed, OK starts it and OK again stops it, Back stops and leaves.
+inline void openTakeScreen() {
+  static const float SCALES[] = { 0.25f, 0.5f, 1.0f, 2.0f, 4.0f };
+  const int count = 1 + (int)(sizeof(SCALES) / sizeof(SCALES[0]));
+  int sel = takeLoad() ? 3 : 0;                 // x1 when there is a take
+  int shownSel = -1;
+  TakeState shownState = (TakeState)0xFF;
+  uint32_t lastDraw = 0;
+  const char* note = nullptr;
+
+  wizardFrameStart("Run");
+  while (true) {
+    updateRotary();
+    const TakeState st = takeState();
+    const int d = getEncoderDelta();
+    if (d && st == TAKE_IDLE) { sel = clampT(sel + d, 0, count - 1); note = nullptr; }
+    if (isSelectPressed()) {
+      if (st != TAKE_IDLE) ctlTake(CTL_TAKE_STOP, 0.0f);
+      else {
+        const CtlStatus r = sel == 0 ? ctlTake(CTL_TAKE_RECORD, 0.0f) : ctlTake(CTL_TAKE_PLAY, SCALES[sel - 1]);
+        note = r == CTL_OK ? nullptr : (r == CTL_BUSY ? "Job running" : (sel == 0 ? "No encoder" : "No take"));
+      }
+      shownSel = -1;
+    }
+    if (isBackPressed() || isBackPressedLong()) break;
+    takeLoop();
+
+    if (sel != shownSel || st != shownState || (st != TAKE_IDLE && millis() - lastDraw >= 200)) {
+      char l1[24], l2[24];
+      switch (st) {
+        case TAKE_RECORDING: snprintf(l1, sizeof(l1), "  * Recording   "); break;
+        case TAKE_SEEKING:   snprintf(l1, sizeof(l1), "  To start...   "); break;
+        case TAKE_PLAYING:   snprintf(l1, sizeof(l1), "  > Play %3d%%   ", (int)(takeProgress() * 100.0f)); break;
+        default:
+          if (sel == 0) snprintf(l1, sizeof(l1), "     Record     ");
+          else          snprintf(l1, sizeof(l1), "   Play x%.2g    ", SCALES[sel - 1]);
+          break;
+      }
+      if (note)                      snprintf(l2, sizeof(l2), "  %-12s  ", note);
+      else if (st == TAKE_RECORDING) snprintf(l2, sizeof(l2), " %5.1fs %4luKB ", takeSeconds(), (unsigned long)(g_take.w.nib / 2048));
+      else if (takeHave())           snprintf(l2, sizeof(l2), "  take %5.1fs   ", takeSeconds());
+      else                           snprintf(l2, sizeof(l2), "  no take yet   ");
+      wizardCenterTwo(l1, l2);
+      shownSel = sel; shownState = st; lastDraw = millis();
+    }
+    idleDimmerTick();
+    delay(10);
+  }
+
+  ctlTake(CTL_TAKE_STOP, 0.0f);
+  wizardCenterTwo("    Stopping    ", "                ");
+  while (takeState() != TAKE_IDLE) { takeLoop(); delay(5); }
+}
+
+#endif
@@ -0,0 +1,11 @@
+#pragma once
+// OTA stand-in for tools/httpbench: uploads are never flashed.
+#include <stddef.h>
+#include <stdint.h>
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+struct HostUpdate {
+  bool   begin(size_t) { return false; }
+  size_t write(const uint8_t*, size_t n) { return n; }
+  bool   end(bool) { return false; }
+};
+static HostUpdate Update;
@@ -0,0 +1,79 @@
+#pragma once
+// WebServer stand-in for tools/httpbench, on top of the socket WiFiServer.
+// It behaves like the ESP32 one in the ways that matter to the loop:
+// handleClient() takes one client at a time and returns straight away
+// while that client's request is still arriving. Once the headers are in,
+// it runs the handler and closes the connection. Request bodies and
+// uploads are not read.
+#include <WiFi.h>
+#include <functional>
+#include <vector>
+
+#ifndef HTTP_MAX_DATA_WAIT
+  #define HTTP_MAX_DATA_WAIT 5000   // ms a client may take to send its request
+#endif
+
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_POST };
+enum HTTPUploadStatus { UPLOAD_FILE_START, UPLOAD_FILE_WRITE, UPLOAD_FILE_END, UPLOAD_FILE_ABORTED };
+struct HTTPUpload {
+  HTTPUploadStatus status = UPLOAD_FILE_ABORTED;
+  String   filename;
+  size_t   totalSize = 0, currentSize = 0;
+  uint8_t  buf[16];
+};
+
+class WebServer {
+ public:
+  explicit WebServer(int port) : listener((uint16_t)port) {}
+
+  void on(const char* path, std::function<void()> fn) { routes.push_back(Route{ path, fn }); }
+  void on(const char* path, HTTPMethod, std::function<void()> fn, std::function<void()>) { on(path, fn); }
+  void onNotFound(std::function<void()> fn) { notFound = fn; }
+  void begin() { listener.begin(); }
+  HTTPUpload& upload() { return up; }
+
+  void handleClient() {
+    if (!client) {
+      client = listener.available();
+      if (!client) return;
+      since = millis();
+      len = 0;
+    }
+    int n;
+    while (len < sizeof(rx) - 1 && (n = client.read((uint8_t*)rx + len, sizeof(rx) - 1 - len)) > 0) len += n;
+    rx[len] = 0;
+    if (!strstr(rx, "\r\n\r\n") && len < sizeof(rx) - 1) {
+      if (client.connected() && millis() - since < HTTP_MAX_DATA_WAIT) return;   // not all here yet
+      client.stop();
+      return;
+    }
+    const char* p = strchr(rx, ' ');
+    std::string path = p ? std::string(p + 1, strcspn(p + 1, " ?")) : "/";
+    std::function<void()> fn = notFound;
+    for (const Route& r : routes) if (path == r.path) { fn = r.fn; break; }
+    if (fn) fn();
+    else send(404, "text/plain", "Not found");
+    client.stop();
+  }
+
+  void send(int code, const char* type, const char* body) {
+    char head[160];
+    const size_t n = strlen(body);
+    const int h = snprintf(head, sizeof(head), "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %u\r\n"
+                           "Connection: close\r\n\r\n", code, code == 200 ? "OK" : "Error", type, (unsigned)n);
+    client.write((const uint8_t*)head, (size_t)h);
+    client.write((const uint8_t*)body, n);
+  }
+  void send_P(int code, const char* type, const char* body) { send(code, type, body); }
+
+ private:
+  struct Route { std::string path; std::function<void()> fn; };
+  WiFiServer            listener;
+  WiFiClient            client;
+  std::vector<Route>    routes;
+  std::function<void()> notFound;
+  HTTPUpload            up;
+  uint32_t              since = 0;
+  char                  rx[1024];
+  size_t                len = 0;
+};
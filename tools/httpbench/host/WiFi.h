@@ -0,0 +1,187 @@
+#pragma once
+// Wi-Fi stand-in for tools/httpbench: WiFiServer and WiFiClient are real
+// non-blocking TCP sockets on 127.0.0.1, so web_server.h serves actual HTTP
+// clients. Port P listens on g_hostPortBase + P - 80 (80 -> base, 81 ->
+// base + 1). The radio itself is a soft AP that is always up.
+//
+// Like the ESP32's WiFiServer, the listen backlog is small
+// (g_hostBacklog). Bytes written to a client can be paced to
+// g_hostLinkKbps; the pacing goes through delay(), so the loop is held
+// for as long as the radio would hold it. Every client remembers the
+// start of its request. g_hostNetOnReply fires when the firmware writes
+// the first byte of its answer, which is after the handler has run.
+#include <Arduino.h>
+#include <string>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+
+struct String {
+  std::string s;
+  // text on the heap, as on the device for anything past a few chars, so
+  // routecheck sees a String built on a route
+  String() {}
+  String(const char* c) : s(c) { s.reserve(32); }
+  String(const std::string& x) : s(x) { s.reserve(32); }
+  const char* c_str() const { return s.c_str(); }
+  size_t length() const { return s.size(); }
+};
+
+struct IPAddress {
+  uint32_t v = 0;
+  IPAddress() {}
+  IPAddress(uint32_t x) : v(x) {}
+  IPAddress(int a, int b, int c, int d) : v((uint32_t)a | b << 8 | c << 16 | (uint32_t)d << 24) {}
+  operator uint32_t() const { return v; }
+  uint8_t operator[](int i) const { return (uint8_t)(v >> (8 * i)); }
+  String toString() const {
+    char b[16];
+    snprintf(b, sizeof(b), "%u.%u.%u.%u", v & 255, (v >> 8) & 255, (v >> 16) & 255, v >> 24);
+    return String(b);
+  }
+};
+#undef INADDR_NONE                       // the socket headers' macro; ESP32 has a constant
+static const IPAddress INADDR_NONE(0u);
+
+enum wifi_mode_t { WIFI_OFF, WIFI_STA, WIFI_AP, WIFI_AP_STA };
+enum wl_status_t { WL_IDLE_STATUS = 0, WL_CONNECTED = 3, WL_DISCONNECTED = 6 };
+
+struct HostWiFi {
+  void persistent(bool) {}
+  void disconnect(bool = false) {}
+  void mode(wifi_mode_t) {}
+  void setSleep(bool) {}
+  void setAutoReconnect(bool) {}
+  bool softAP(const char*, const char*) { return true; }
+  IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+  bool config(IPAddress, IPAddress, IPAddress, IPAddress = IPAddress()) { return true; }
+  void begin(const char*, const char*, int32_t = 0, const uint8_t* = nullptr, bool = true) {}
+  wl_status_t status() { return WL_DISCONNECTED; }
+  uint8_t* BSSID() { static uint8_t b[6]; return b; }
+  int channel() { return 1; }
+  IPAddress localIP() { return IPAddress(); }
+  IPAddress gatewayIP() { return IPAddress(); }
+  IPAddress subnetMask() { return IPAddress(); }
+  IPAddress dnsIP(int = 0) { return IPAddress(); }
+  int RSSI() { return 0; }
+};
+extern HostWiFi WiFi;
+
+// ---------- sockets ----------
+inline uint16_t g_hostPortBase = 18080;
+inline int      g_hostBacklog  = 4;      // WiFiServer's default max clients
+inline uint32_t g_hostLinkKbps = 0;      // 0 = unpaced
+
+struct HostNetConn {
+  int      fd       = -1;
+  uint16_t port     = 0;                 // firmware port (80, 81)
+  uint64_t acceptUs = 0;
+  char     head[256];                    // start of the request as read
+  size_t   headLen  = 0;
+  bool     replied  = false;
+};
+inline void (*g_hostNetOnReply)(const HostNetConn& c) = nullptr;
+
+inline void hostLinkPace(size_t bytes) {
+  static uint64_t debtUs = 0;
+  if (!g_hostLinkKbps) return;
+  debtUs += bytes * 8000ull / g_hostLinkKbps;
+  if (debtUs >= 1000) { const uint32_t ms = (uint32_t)(debtUs / 1000); debtUs %= 1000; delay(ms); }
+}
+
+class WiFiClient {
+ public:
+  WiFiClient() {}
+  explicit WiFiClient(HostNetConn* c) : conn(c) {}
+  operator bool() const { return conn != nullptr; }
+
+  bool connected() {
+    if (!conn) return false;
+    char b;
+    const ssize_t n = recv(conn->fd, &b, 1, MSG_PEEK | MSG_DONTWAIT);
+    return n > 0 || (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+  }
+  int available() {
+    int n = 0;
+    if (!conn || ioctl(conn->fd, FIONREAD, &n) < 0) return 0;
+    return n;
+  }
+  int read() { uint8_t b; return read(&b, 1) == 1 ? b : -1; }
+  int read(uint8_t* buf, size_t n) {
+    if (!conn) return -1;
+    const ssize_t r = recv(conn->fd, buf, n, MSG_DONTWAIT);
+    if (r <= 0) return r == 0 ? 0 : -1;
+    const size_t keep = std::min<size_t>((size_t)r, sizeof(conn->head) - 1 - conn->headLen);
+    memcpy(conn->head + conn->headLen, buf, keep);
+    conn->headLen += keep;
+    conn->head[conn->headLen] = 0;
+    return (int)r;
+  }
+  size_t write(const uint8_t* buf, size_t n) {
+    if (!conn) return 0;
+    if (!conn->replied) { conn->replied = true; if (g_hostNetOnReply) g_hostNetOnReply(*conn); }
+    size_t done = 0;
+    while (done < n) {
+      const ssize_t w = send(conn->fd, buf + done, n - done, MSG_NOSIGNAL);
+      if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) { usleep(100); continue; }
+      if (w <= 0) break;
+      done += (size_t)w;
+    }
+    hostLinkPace(done);
+    return done;
+  }
+  size_t write(const char* s, size_t n) { return write((const uint8_t*)s, n); }
+  void setNoDelay(bool on) { if (conn) { int v = on; setsockopt(conn->fd, IPPROTO_TCP, TCP_NODELAY, &v, sizeof(v)); } }
+  void setTimeout(int) {}
+  void stop() {
+    if (!conn) return;
+    close(conn->fd);
+    delete conn;
+    conn = nullptr;
+  }
+
+ private:
+  HostNetConn* conn = nullptr;
+};
+
+class WiFiServer {
+ public:
+  explicit WiFiServer(uint16_t port) : port(port) {}
+  void begin() {
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in a = {};
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    a.sin_port = htons((uint16_t)(g_hostPortBase + port - 80));
+    if (bind(fd, (sockaddr*)&a, sizeof(a)) < 0 || listen(fd, g_hostBacklog) < 0) {
+      fprintf(stderr, "WiFiServer: cannot listen on %u\n", (unsigned)ntohs(a.sin_port));
+      exit(2);
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  }
+  void setNoDelay(bool on) { noDelay = on; }
+  WiFiClient available() {
+    const int c = accept(fd, nullptr, nullptr);
+    if (c < 0) return WiFiClient();
+    fcntl(c, F_SETFL, fcntl(c, F_GETFL) | O_NONBLOCK);
+    HostNetConn* conn = new HostNetConn();
+    conn->fd = c;
+    conn->port = port;
+    conn->acceptUs = g_hostUs;
+    WiFiClient client(conn);
+    if (noDelay) client.setNoDelay(true);
+    return client;
+  }
+
+ private:
+  uint16_t port;
+  int      fd = -1;
+  bool     noDelay = false;
+};
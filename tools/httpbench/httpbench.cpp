@@ -0,0 +1,411 @@
+// Control-path load on a PC: web_server.h runs on Linux behind socket
+// stand-ins for WiFi/WebServer (host/), with the firmware's loop on the
+// main thread and the step timer and drive tick emulated in real time.
+// Simulated phones hit it the way the web page does: pointermove bursts on
+// the drive pad, jog storms and page loads. The report shows what the rig
+// would do with that traffic.
+//
+//   httpbench [--phones N] [--seconds S] [--link-kbps K] [--loop-us U]
+//             [--backlog B] [--idle-per-s R] [--port P] [--json] [scenario...]
+//
+// For every request kind it reports:
+// - sent, applied (200), busy (409) and failed (network error, timeout,
+//   other status);
+// - stale: applied after a newer request of the same kind from the same
+//   phone;
+// - coalesced: a drive target replaced before the drive tick ever read it;
+// - throughput, and latency from the pointer event to the command
+//   taking effect (p50/p99/max), or to the last byte for page loads.
+// The loop line shows how long the firmware's loop() was held.
+//
+// --link-kbps paces what the rig sends, as the radio would; --loop-us
+// adds work to every loop pass (the UI; see tools/screenbench);
+// --idle-per-s opens connections that never send a request, as browser
+// preconnects do. --backlog is the accept queue (WiFiServer's is 4).
+//
+// Build (from the repo root):
+//   g++ -std=gnu++17 -O2 -pthread -Itools/httpbench/host -Itools/jobcheck/host -I.
+//       tools/httpbench/httpbench.cpp web_server.cpp wifi_link.cpp boot.cpp crawl.cpp
+//       eeprom_utils.cpp encoder_utils.cpp flight_recorder.cpp job.cpp manual_drive.cpp
+//       mem_pool.cpp motion_plan.cpp motor_control.cpp plan_cache.cpp resonance_map.cpp
+//       resume.cpp rig_scale.cpp settle.cpp step_generator.cpp take.cpp logo.cpp
+//       assets.cpp image_asset.cpp -o httpbench
+
+#include <Arduino.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <time.h>
+#include "web_server.h"
+#include "manual_drive.h"
+#include "crawl.h"
+#include "take.h"
+
+TFT_eSPI tft;
+HostWiFi WiFi;
+
+// ---------- clock ----------
+static uint64_t g_t0;
+static uint64_t nowUs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ull + ts.tv_nsec / 1000 - g_t0;
+}
+static void sleepUntil(uint64_t us) {
+  const uint64_t now = nowUs();
+  if (us > now) std::this_thread::sleep_for(std::chrono::microseconds(us - now));
+}
+
+// ---------- requests ----------
+enum ReqKind : uint8_t { RK_DRIVE, RK_STOP, RK_JOG, RK_PAGE, RK_IDLE, RK_KINDS };
+static const char* KIND_NAMES[RK_KINDS] = { "drive", "stop", "jog", "page", "idle" };
+
+struct Req {
+  ReqKind  kind;
+  uint8_t  phone;
+  int      status    = 0;              // HTTP status, 0 = none
+  bool     failed    = false;
+  uint64_t eventUs   = 0;              // pointer event / tap / reload
+  uint64_t doneUs    = 0;              // last byte in
+  uint64_t appliedUs = 0;              // handler done (firmware side)
+  uint32_t tick      = 0;              // drive ticks run before it applied
+};
+
+static const size_t MAX_REQS = 200000;
+static std::vector<Req>     g_reqs(MAX_REQS);
+static std::atomic<size_t>  g_reqCount{0};
+
+static size_t reqNew(ReqKind k, uint8_t phone, uint64_t eventUs) {
+  const size_t id = g_reqCount++;
+  if (id >= MAX_REQS) { fprintf(stderr, "httpbench: too many requests\n"); exit(2); }
+  g_reqs[id].kind = k; g_reqs[id].phone = phone; g_reqs[id].eventUs = eventUs;
+  return id;
+}
+
+// One fetch(): connect, send, read to close. Blocking, on a worker thread.
+static void httpFetch(size_t id, uint16_t port, const char* path) {
+  Req& r = g_reqs[id];
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  timeval tv = { 3, 0 };
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+  sockaddr_in a = {};
+  a.sin_family = AF_INET;
+  a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  a.sin_port = htons((uint16_t)(g_hostPortBase + port - 80));
+  char buf[4096];
+  bool ok = connect(fd, (sockaddr*)&a, sizeof(a)) == 0;
+  if (ok) {
+    const int n = snprintf(buf, sizeof(buf), "GET %s%cid=%u HTTP/1.1\r\nHost: slidepilot\r\n\r\n",
+                           path, strchr(path, '?') ? '&' : '?', (unsigned)id);
+    ok = send(fd, buf, n, MSG_NOSIGNAL) == n;
+  }
+  size_t got = 0;
+  while (ok) {
+    const ssize_t n = recv(fd, buf + min<size_t>(got, 64), sizeof(buf) - 64, 0);
+    if (n < 0) { ok = false; break; }
+    if (n == 0) break;
+    if (got == 0) { buf[min<size_t>((size_t)n, 63)] = 0; sscanf(buf, "HTTP/1.%*d %d", &r.status); }
+    got += (size_t)n;
+  }
+  close(fd);
+  r.doneUs = nowUs();
+  r.failed = !ok || r.status == 0;
+}
+
+// A browser tab: fetches run on up to 6 connections at once, more wait.
+struct Phone {
+  uint8_t                  index;
+  std::mutex               m;
+  std::condition_variable  cv;
+  int                      inFlight = 0;
+  std::vector<std::thread> workers;
+
+  void fetch(ReqKind k, uint64_t eventUs, uint16_t port, std::string path) {
+    {
+      std::unique_lock<std::mutex> l(m);
+      cv.wait(l, [&] { return inFlight < 6; });
+      inFlight++;
+    }
+    const size_t id = reqNew(k, index, eventUs);
+    workers.emplace_back([this, id, port, path] {
+      httpFetch(id, port, path.c_str());
+      std::lock_guard<std::mutex> l(m);
+      inFlight--;
+      cv.notify_one();
+    });
+  }
+  void join() { for (auto& t : workers) t.join(); workers.clear(); }
+};
+
+// ---------- what the phones do ----------
+struct Load {
+  uint8_t  phones   = 3;
+  float    seconds  = 3.0f;
+  float    idlePerS = 0.0f;
+};
+static Load g_load;
+
+// Drag on the drive pad: pointermove at 60 Hz, speed wandering with the
+// finger, direction flipping each second; sent as web_app.h's drive() does.
+static void phoneDrive(Phone& ph, uint64_t t0, uint64_t t1) {
+  int lastDir = 0, lastP = 0;
+  uint64_t lastSent = 0;
+  for (uint64_t t = t0; t < t1; t += 16667) {
+    sleepUntil(t);
+    const float s = (t - t0) / 1e6f;
+    const int dir = ((int)s & 1) ? -1 : 1;
+    const int p = (int)lroundf(50.0f + 20.0f * sinf(s * 5.0f + ph.index));
+    if (dir == lastDir && p == lastP && t - lastSent < 50000) continue;
+    lastDir = dir; lastP = p; lastSent = t;
+    char path[48];
+    snprintf(path, sizeof(path), "/api/drive?dir=%d&p=%d", dir, p);
+    ph.fetch(RK_DRIVE, t, 81, path);
+  }
+  sleepUntil(t1);
+  ph.fetch(RK_STOP, t1, 81, "/api/stop");          // release: centre and stop
+}
+
+// Jog buttons tapped as fast as a thumb goes, alternating direction
+static void phoneJog(Phone& ph, uint64_t t0, uint64_t t1) {
+  int n = 0;
+  for (uint64_t t = t0; t < t1; t += 100000, ++n) {
+    sleepUntil(t);
+    ph.fetch(RK_JOG, t, 81, (n & 1) ? "/api/jog?mm=-2" : "/api/jog?mm=2");
+  }
+}
+
+// Reload the page every half second
+static void phonePages(Phone& ph, uint64_t t0, uint64_t t1) {
+  for (uint64_t t = t0; t < t1; t += 500000) {
+    sleepUntil(t);
+    ph.fetch(RK_PAGE, t, 80, "/");
+  }
+}
+
+// Preconnects: a connection that sends nothing; the server gives up on it
+static void idleConnections(uint64_t t0, uint64_t t1, float perS) {
+  if (perS <= 0.0f) return;
+  std::vector<std::thread> held;
+  for (uint64_t t = t0; t < t1; t += (uint64_t)(1e6f / perS)) {
+    sleepUntil(t);
+    const size_t id = reqNew(RK_IDLE, 255, t);
+    held.emplace_back([id] {
+      const int fd = socket(AF_INET, SOCK_STREAM, 0);
+      sockaddr_in a = {};
+      a.sin_family = AF_INET;
+      a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      a.sin_port = htons((uint16_t)(g_hostPortBase + 1));
+      timeval tv = { 3, 0 };
+      setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+      char b[256];
+      if (connect(fd, (sockaddr*)&a, sizeof(a)) == 0) {
+        const ssize_t n = recv(fd, b, sizeof(b) - 1, 0);
+        if (n > 0) { b[n] = 0; sscanf(b, "HTTP/1.%*d %d", &g_reqs[id].status); }
+      }
+      close(fd);
+      g_reqs[id].doneUs = nowUs();
+    });
+  }
+  for (auto& t : held) t.join();
+}
+
+typedef void (*PhoneFn)(Phone&, uint64_t, uint64_t);
+struct Scenario { const char* name; PhoneFn first; PhoneFn rest; const char* what; };
+static const Scenario SCENARIOS[] = {
+  { "drive",  phoneDrive, phoneDrive, "every phone drags the drive pad" },
+  { "jog",    phoneJog,   phoneJog,   "every phone taps jog 10x/s" },
+  { "pages",  phoneDrive, phonePages, "one phone drives, the rest reload the page" },
+  { "mixed",  phoneDrive, phoneJog,   "one phone drives, the rest jog" },
+};
+
+// ---------- firmware side ----------
+static uint64_t g_simUs;                 // hardware emulated up to here
+static uint32_t g_driveTicks;            // 1 ms drive-tick periods run while driving
+
+// Run the step timer and the esp_timers up to real time, 1 ms at a time.
+static void hardwareCatchUp() {
+  const uint64_t now = nowUs();
+  while (g_simUs + 1000 <= now) {
+    g_simUs += 1000;
+    g_hostUs = g_simUs;
+    hostTimerAdvance(g_stepTimer, 1000);
+    if (g_drive.active) g_driveTicks++;
+    hostEspTimersRun();
+  }
+  g_hostUs = now;
+}
+static void onDelay(uint32_t) { hardwareCatchUp(); }
+
+static void onReply(const HostNetConn& c) {
+  const char* id = strstr(c.head, "id=");
+  if (!id) return;
+  const size_t i = strtoul(id + 3, nullptr, 10);
+  if (i >= g_reqCount) return;
+  g_reqs[i].appliedUs = nowUs();
+  g_reqs[i].tick = g_driveTicks;
+}
+
+struct LoopStats { uint32_t passes = 0; std::vector<uint32_t> gapsUs; };
+
+// The parts of SliderPilot.ino's loop() that the network and motion touch
+static void firmwareLoop(uint64_t untilUs, uint32_t loopUs, LoopStats& ls) {
+  uint64_t last = nowUs();
+  while (nowUs() < untilUs) {
+    hardwareCatchUp();
+    webServerLoop();
+    driveLoop();
+    takeLoop();
+    crawlLoop();
+    if (loopUs) { const uint64_t end = nowUs() + loopUs; while (nowUs() < end) {} }
+    const uint64_t now = nowUs();
+    ls.passes++;
+    ls.gapsUs.push_back((uint32_t)(now - last));
+    last = now;
+  }
+}
+
+// ---------- report ----------
+static uint64_t pct(std::vector<uint64_t>& v, float p) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[min<size_t>(v.size() - 1, (size_t)(p * (v.size() - 1) + 0.5f))];
+}
+
+struct KindReport {
+  uint32_t sent = 0, applied = 0, busy = 0, failed = 0, stale = 0, coalesced = 0;
+  uint64_t p50 = 0, p99 = 0, worst = 0;
+};
+
+static void analyse(size_t from, size_t to, KindReport out[RK_KINDS]) {
+  std::vector<uint64_t> lat[RK_KINDS];
+  for (size_t i = from; i < to; ++i) {
+    const Req& r = g_reqs[i];
+    KindReport& k = out[r.kind];
+    k.sent++;
+    if (r.kind == RK_IDLE) { if (r.status) k.failed++; continue; }   // answered 400 after holding the loop
+    if (r.status == 409) k.busy++;
+    else if (r.failed || r.status != 200) k.failed++;
+    else k.applied++;
+    if (r.kind == RK_PAGE) { if (!r.failed) lat[r.kind].push_back(r.doneUs - r.eventUs); continue; }
+    if (!r.appliedUs) continue;
+    lat[r.kind].push_back(r.appliedUs - r.eventUs);
+    // a later request from the same phone already took effect
+    for (size_t j = i + 1; j < to; ++j) {
+      const Req& n = g_reqs[j];
+      if (n.phone != r.phone || !n.appliedUs) continue;
+      const bool sameAxis = (n.kind == RK_DRIVE || n.kind == RK_STOP) == (r.kind == RK_DRIVE || r.kind == RK_STOP);
+      if (!sameAxis || n.eventUs <= r.eventUs) continue;
+      if (n.appliedUs < r.appliedUs) { k.stale++; break; }
+    }
+  }
+  // drive targets overwritten before a tick ran, in the order they took effect
+  std::vector<const Req*> drives;
+  for (size_t i = from; i < to; ++i)
+    if ((g_reqs[i].kind == RK_DRIVE || g_reqs[i].kind == RK_STOP) && g_reqs[i].status == 200) drives.push_back(&g_reqs[i]);
+  std::sort(drives.begin(), drives.end(), [](const Req* a, const Req* b) { return a->appliedUs < b->appliedUs; });
+  for (size_t i = 0; i + 1 < drives.size(); ++i)
+    if (drives[i]->kind == RK_DRIVE && drives[i + 1]->tick == drives[i]->tick) out[RK_DRIVE].coalesced++;
+  for (int k = 0; k < RK_KINDS; ++k) {
+    out[k].p50 = pct(lat[k], 0.50f);
+    out[k].p99 = pct(lat[k], 0.99f);
+    out[k].worst = lat[k].empty() ? 0 : lat[k].back();
+  }
+}
+
+int main(int argc, char** argv) {
+  uint32_t loopUs = 0;
+  bool json = false;
+  std::vector<const char*> only;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--phones") && i + 1 < argc)       { g_load.phones = (uint8_t)clampT(atoi(argv[++i]), 1, 16); continue; }
+    if (!strcmp(argv[i], "--seconds") && i + 1 < argc)      { g_load.seconds = (float)atof(argv[++i]); continue; }
+    if (!strcmp(argv[i], "--link-kbps") && i + 1 < argc)    { g_hostLinkKbps = (uint32_t)atoi(argv[++i]); continue; }
+    if (!strcmp(argv[i], "--loop-us") && i + 1 < argc)      { loopUs = (uint32_t)atoi(argv[++i]); continue; }
+    if (!strcmp(argv[i], "--backlog") && i + 1 < argc)      { g_hostBacklog = atoi(argv[++i]); continue; }
+    if (!strcmp(argv[i], "--idle-per-s") && i + 1 < argc)   { g_load.idlePerS = (float)atof(argv[++i]); continue; }
+    if (!strcmp(argv[i], "--port") && i + 1 < argc)         { g_hostPortBase = (uint16_t)atoi(argv[++i]); continue; }
+    if (!strcmp(argv[i], "--json"))                         { json = true; continue; }
+    if (argv[i][0] == '-') {
+      fprintf(stderr, "usage: httpbench [--phones N] [--seconds S] [--link-kbps K] [--loop-us U]\n"
+                      "                 [--backlog B] [--idle-per-s R] [--port P] [--json] [scenario...]\n");
+      for (const Scenario& s : SCENARIOS) fprintf(stderr, "  %-8s %s\n", s.name, s.what);
+      return 2;
+    }
+    only.push_back(argv[i]);
+  }
+
+  g_t0 = 0;
+  g_t0 = nowUs();
+  g_hostOnDelay = onDelay;
+  g_hostNetOnReply = onReply;
+
+  // setup(), minus the display and inputs
+  flightRecorderBegin();
+  initMotor();
+  stepGenInit();
+  eepromInit();
+  eepromLoadAllIntoRuntime();
+  scaleRefresh();
+  startWebServer();
+  const AxisConfig& ax = g_axes[AXIS_SLIDE];
+  g_axisPos[AXIS_SLIDE] = (int32_t)lroundf(0.5f * (ax.minPos + ax.maxPos) * stepsPerMM());
+
+  if (json) printf("[");
+  else printf("%-8s %-6s %6s %7s %5s %6s %5s %9s %7s %8s %8s %8s\n", "scenario", "kind", "sent", "applied",
+              "busy", "failed", "stale", "coalesced", "req/s", "p50 ms", "p99 ms", "max ms");
+  bool first = true;
+  for (const Scenario& s : SCENARIOS) {
+    bool want = only.empty();
+    for (const char* o : only) want |= !strcmp(o, s.name);
+    if (!want) continue;
+
+    ctlStop();
+    LoopStats settle;
+    firmwareLoop(nowUs() + 500000, loopUs, settle);           // let the last run wind down
+    g_axisPos[AXIS_SLIDE] = (int32_t)lroundf(0.5f * (ax.minPos + ax.maxPos) * stepsPerMM());
+
+    const size_t from = g_reqCount;
+    const uint64_t t0 = nowUs() + 100000, t1 = t0 + (uint64_t)(g_load.seconds * 1e6f);
+    std::vector<Phone> phones(g_load.phones);
+    std::vector<std::thread> drivers;
+    for (uint8_t p = 0; p < g_load.phones; ++p) {
+      phones[p].index = p;
+      drivers.emplace_back([&, p] { (p == 0 ? s.first : s.rest)(phones[p], t0, t1); });
+    }
+    drivers.emplace_back([&] { idleConnections(t0, t1, g_load.idlePerS); });
+
+    LoopStats ls;
+    firmwareLoop(t1 + 3500000, loopUs, ls);                   // past the clients' timeouts
+    for (auto& d : drivers) d.join();
+    for (auto& p : phones) p.join();
+
+    KindReport rep[RK_KINDS];
+    analyse(from, g_reqCount, rep);
+    std::vector<uint64_t> gaps(ls.gapsUs.begin(), ls.gapsUs.end());
+    const uint64_t gap99 = pct(gaps, 0.99f), gapMax = gaps.empty() ? 0 : gaps.back();
+    const float secs = g_load.seconds;
+    for (int k = 0; k < RK_KINDS; ++k) {
+      const KindReport& r = rep[k];
+      if (!r.sent) continue;
+      if (json) {
+        printf("%s\n  {\"scenario\":\"%s\",\"kind\":\"%s\",\"sent\":%u,\"applied\":%u,\"busy\":%u,\"failed\":%u,"
+               "\"stale\":%u,\"coalesced\":%u,\"perS\":%.1f,\"p50Ms\":%.2f,\"p99Ms\":%.2f,\"maxMs\":%.2f,"
+               "\"loopP99Ms\":%.2f,\"loopMaxMs\":%.2f}",
+               first ? "" : ",", s.name, KIND_NAMES[k], r.sent, r.applied, r.busy, r.failed, r.stale, r.coalesced,
+               r.applied / secs, r.p50 / 1000.0, r.p99 / 1000.0, r.worst / 1000.0, gap99 / 1000.0, gapMax / 1000.0);
+        first = false;
+      } else {
+        printf("%-8s %-6s %6u %7u %5u %6u %5u %9u %7.1f %8.2f %8.2f %8.2f\n", s.name, KIND_NAMES[k], r.sent,
+               r.applied, r.busy, r.failed, r.stale, r.coalesced, r.applied / secs,
+               r.p50 / 1000.0, r.p99 / 1000.0, r.worst / 1000.0);
+      }
+    }
+    if (!json) printf("%-8s %-6s %6u passes, held p99 %.2f ms, max %.2f ms\n", s.name, "loop",
+                      ls.passes, gap99 / 1000.0, gapMax / 1000.0);
+  }
+  if (json) printf("\n]\n");
+  return 0;
+}
@@ -0,0 +1,268 @@
+// Rotary encoder and button decoding on a PC: recorded or synthetic
+// CLK/DT/button traces are replayed through the firmware's input code and
+// the detents and presses it reports are checked against what the trace
+// is known to contain. Any rewrite of rotary_input.h has to keep the
+// golden corpus (corpus/*.trace) passing.
+//
+//   inputcheck [-v] [--bench] [trace...]
+//   inputcheck --gen dir
+//
+// With no traces, everything in tools/inputcheck/corpus is run. Each trace
+// goes through two paths:
+// - decoder: inputReplay(), the InputDecoder on its own;
+// - glue: pin levels scripted under digitalRead(), handleRotary() every
+//   tick and the getters (getEncoderDelta(), isSelectPressed(),
+//   isBackPressed(), isBackPressedLong()) polled as a screen would.
+// --bench also times both, in ns per sample. --gen rewrites the synthetic
+// corpus into dir. Exit status is 1 when a trace fails.
+//
+// Trace files are what `slidectl.py trace` prints, "ms pins" per line
+// (pins = InputBit: 1 B, 2 A, 4 OK pressed, 8 BACK pressed), plus an
+// "expect detents=N ok=N back=N long=N" line; '#' starts a comment. The
+// firmware records changes only, so replay holds each line's pins and
+// feeds a sample every millisecond, as loop() polls.
+//
+// Build (from the repo root):
+//   g++ -std=gnu++17 -O2 -Itools/jobcheck/host -I. tools/inputcheck/inputcheck.cpp
+//       rotary_input.cpp flight_recorder.cpp -o inputcheck
+
+#include <Arduino.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include "rotary_input.h"
+
+TFT_eSPI tft;   // config.h declares it; nothing is drawn
+
+struct Expect { int detents = 0, ok = 0, back = 0, lng = 0; };
+struct Trace {
+  std::string              name;
+  Expect                   expect;
+  bool                     hasExpect = false;
+  std::vector<InputSample> samples;   // one per millisecond
+};
+
+static bool g_verbose = false;
+
+// ---------- trace files ----------
+static bool loadTrace(const std::string& path, Trace& t) {
+  FILE* f = fopen(path.c_str(), "r");
+  if (!f) return false;
+  t = Trace();
+  t.name = path.substr(path.find_last_of('/') + 1);
+  std::vector<InputSample> lines;
+  char buf[256];
+  while (fgets(buf, sizeof(buf), f)) {
+    if (char* c = strchr(buf, '#')) *c = 0;
+    Expect& e = t.expect;
+    unsigned ms, pins;
+    if (sscanf(buf, " expect detents=%d ok=%d back=%d long=%d", &e.detents, &e.ok, &e.back, &e.lng) == 4)
+      t.hasExpect = true;
+    else if (sscanf(buf, "%u %u", &ms, &pins) == 2)
+      lines.push_back(InputSample{ ms, (uint8_t)pins });
+  }
+  fclose(f);
+  for (size_t i = 0; i < lines.size(); ++i) {
+    // hold each level until the next line, and a little past the last one
+    // so a final press can finish debouncing
+    const uint32_t until = i + 1 < lines.size() ? lines[i + 1].ms : lines[i].ms + LONG_PRESS_MS + 50;
+    for (uint32_t ms = lines[i].ms; ms < until || ms == lines[i].ms; ++ms)
+      t.samples.push_back(InputSample{ ms, lines[i].pins });
+  }
+  return t.hasExpect && !t.samples.empty();
+}
+
+static std::vector<std::string> listDir(const std::string& dir) {
+  std::vector<std::string> out;
+  if (DIR* d = opendir(dir.c_str())) {
+    while (dirent* e = readdir(d)) {
+      const std::string n = e->d_name;
+      if (n.size() > 6 && n.compare(n.size() - 6, 6, ".trace") == 0) out.push_back(dir + "/" + n);
+    }
+    closedir(d);
+  }
+  std::sort(out.begin(), out.end());
+  return out;
+}
+
+// ---------- the two paths ----------
+static Expect runDecoder(const Trace& t) {
+  const InputEvents ev = inputReplay(t.samples.data(), t.samples.size());
+  return Expect{ ev.detents, ev.okPress, ev.backPress, ev.backLong };
+}
+
+static uint8_t g_pins = 0;
+static int hostPin(int pin) {
+  switch (pin) {
+    case ROTARY_A_PIN:  return (g_pins & IN_A) ? HIGH : LOW;
+    case ROTARY_B_PIN:  return (g_pins & IN_B) ? HIGH : LOW;
+    case ROTARY_SW_PIN: return ((g_pins & IN_OK)   != 0) == ROTARY_SW_ACTIVE_LOW ? LOW : HIGH;
+    case BACK_BTN_PIN:  return ((g_pins & IN_BACK) != 0) == BACK_BTN_ACTIVE_LOW  ? LOW : HIGH;
+    default:            return HIGH;
+  }
+}
+
+static Expect runGlue(const Trace& t) {
+  Expect got;
+  g_hostPinRead = hostPin;
+  g_pins  = t.samples[0].pins;
+  g_hostUs = (uint64_t)t.samples[0].ms * 1000u;
+  inputInit();
+  for (size_t i = 1; i < t.samples.size(); ++i) {
+    g_pins   = t.samples[i].pins;
+    g_hostUs = (uint64_t)t.samples[i].ms * 1000u;
+    updateRotary();
+    got.detents += getEncoderDelta();
+    got.ok      += isSelectPressed();
+    got.back    += isBackPressed();
+    got.lng     += isBackPressedLong();
+  }
+  g_hostPinRead = nullptr;
+  return got;
+}
+
+static bool same(const Expect& a, const Expect& b) {
+  return a.detents == b.detents && a.ok == b.ok && a.back == b.back && a.lng == b.lng;
+}
+static void printExpect(const char* what, const Expect& e) {
+  printf("    %-8s detents=%d ok=%d back=%d long=%d\n", what, e.detents, e.ok, e.back, e.lng);
+}
+
+template <class F>
+static double nsPerSample(const std::vector<Trace>& traces, F run) {
+  using clock = std::chrono::steady_clock;
+  size_t samples = 0;
+  volatile int sink = 0;
+  const auto t0 = clock::now();
+  auto t1 = t0;
+  do {
+    for (const Trace& t : traces) { sink += run(t).detents; samples += t.samples.size(); }
+    t1 = clock::now();
+  } while (t1 - t0 < std::chrono::milliseconds(300));
+  (void)sink;
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() / samples;
+}
+
+// ---------- synthetic corpus ----------
+// A trace being written: pin levels with the time they start.
+struct Gen {
+  FILE*    f;
+  uint32_t ms   = 1000;
+  uint8_t  pins = IN_A | IN_B;      // KY-040 at rest, lines high
+  void put(uint8_t p, uint32_t after) { ms += after; pins = p; fprintf(f, "%u %u\n", ms, pins); }
+  void ab(uint8_t v, uint32_t after) { put((uint8_t)((pins & ~(IN_A | IN_B)) | v), after); }
+  // one quadrature transition; bounce = extra flips of the changing line
+  void step(int dir, uint32_t after, int bounce = 0) {
+    static const uint8_t CW[4] = { 0, 1, 3, 2 };   // A<<1|B, +1 each (quadStep)
+    const uint8_t cur = pins & (IN_A | IN_B);
+    int i = 0;
+    while (CW[i] != cur) ++i;
+    const uint8_t next = CW[(i + (dir > 0 ? 1 : 3)) & 3];
+    for (int b = 0; b < bounce; ++b) { ab(next, b ? 1 : after); ab(cur, 1); after = 1; }
+    ab(next, bounce ? 1 : after);
+  }
+  void detents(int n, uint32_t stepMs, int bounce = 0) {
+    for (int k = 0; k < abs(n); ++k)
+      for (int s = 0; s < ROTARY_STEPS_PER_DETENT; ++s) step(n > 0 ? 1 : -1, stepMs, bounce);
+  }
+  void button(uint8_t bit, uint32_t after, uint32_t heldMs, int bounce = 0) {
+    for (int b = 0; b < bounce; ++b) { put(pins | bit, b ? 1 : after); put(pins & ~bit, 1); after = 1; }
+    put(pins | bit, bounce ? 1 : after);
+    for (int b = 0; b < bounce; ++b) { put(pins & ~bit, heldMs); put(pins | bit, 1); heldMs = 1; }
+    put(pins & ~bit, heldMs);
+  }
+};
+
+static bool genOne(const std::string& dir, const char* name, const char* what, Expect e,
+                   void (*body)(Gen&)) {
+  const std::string path = dir + "/" + name + ".trace";
+  FILE* f = fopen(path.c_str(), "w");
+  if (!f) { perror(path.c_str()); return false; }
+  fprintf(f, "# %s\n", what);
+  fprintf(f, "expect detents=%d ok=%d back=%d long=%d\n", e.detents, e.ok, e.back, e.lng);
+  Gen g{ f };
+  fprintf(f, "%u %u\n", g.ms, g.pins);
+  body(g);
+  g.put(g.pins, 100);
+  fclose(f);
+  return true;
+}
+
+static int generate(const std::string& dir) {
+  bool ok = true;
+  ok &= genOne(dir, "clean_cw", "10 detents clockwise, 20 ms per edge", Expect{ 10, 0, 0, 0 },
+               [](Gen& g) { g.detents(10, 20); });
+  ok &= genOne(dir, "clean_ccw", "10 detents counter-clockwise, 20 ms per edge", Expect{ -10, 0, 0, 0 },
+               [](Gen& g) { g.detents(-10, 20); });
+  ok &= genOne(dir, "bouncy", "10 detents clockwise, every edge bounces twice", Expect{ 10, 0, 0, 0 },
+               [](Gen& g) { g.detents(10, 20, 2); });
+  ok &= genOne(dir, "bouncy_reverse", "6 clockwise then 4 back, bouncing edges", Expect{ 2, 0, 0, 0 },
+               [](Gen& g) { g.detents(6, 15, 2); g.detents(-4, 15, 2); });
+  ok &= genOne(dir, "fast_spin", "40 detents at one edge per millisecond", Expect{ 40, 0, 0, 0 },
+               [](Gen& g) { g.detents(40, 1); });
+  ok &= genOne(dir, "missed_samples", "20 detents clockwise, every third detent's middle state not sampled",
+               Expect{ 20, 0, 0, 0 }, [](Gen& g) {
+                 g.detents(1, 2);
+                 for (int k = 1; k < 20; ++k) {
+                   if (k % 3) { g.detents(1, 2); continue; }
+                   g.ab((uint8_t)((g.pins & (IN_A | IN_B)) ^ (IN_A | IN_B)), 2);   // both lines at once
+                 }
+               });
+  ok &= genOne(dir, "half_turns", "knob rocked off a detent and back, 8 times", Expect{ 0, 0, 0, 0 },
+               [](Gen& g) { for (int k = 0; k < 8; ++k) { g.step(1, 30); g.step(-1, 30); } });
+  ok &= genOne(dir, "ok_presses", "3 OK presses, bouncing on press and release", Expect{ 0, 3, 0, 0 },
+               [](Gen& g) { for (int k = 0; k < 3; ++k) g.button(IN_OK, 200, 120, 3); });
+  ok &= genOne(dir, "ok_glitches", "OK line spikes shorter than the debounce time", Expect{ 0, 0, 0, 0 },
+               [](Gen& g) { for (int k = 0; k < 5; ++k) g.button(IN_OK, 100, DEBOUNCE_MS / 3); });
+  ok &= genOne(dir, "back_short", "2 short BACK presses", Expect{ 0, 0, 2, 0 },
+               [](Gen& g) { g.button(IN_BACK, 100, 200, 2); g.button(IN_BACK, 300, 150); });
+  ok &= genOne(dir, "back_long", "BACK held for a second: a press, then a long press", Expect{ 0, 0, 1, 1 },
+               [](Gen& g) { g.button(IN_BACK, 100, 1000, 2); });
+  ok &= genOne(dir, "turn_while_pressed", "OK held while turning 5 detents", Expect{ 5, 1, 0, 0 },
+               [](Gen& g) {
+                 g.put(g.pins | IN_OK, 100);
+                 g.detents(5, 25, 1);
+                 g.put(g.pins & ~IN_OK, 50);
+               });
+  return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+  bool bench = false;
+  std::vector<std::string> paths;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-v"))      { g_verbose = true; continue; }
+    if (!strcmp(argv[i], "--bench")) { bench = true; continue; }
+    if (!strcmp(argv[i], "--gen") && i + 1 < argc) return generate(argv[i + 1]);
+    if (argv[i][0] == '-') {
+      fprintf(stderr, "usage: inputcheck [-v] [--bench] [trace...] | --gen dir\n");
+      return 2;
+    }
+    paths.push_back(argv[i]);
+  }
+  if (paths.empty()) paths = listDir("tools/inputcheck/corpus");
+  if (paths.empty()) { fprintf(stderr, "no traces (run from the repo root or name them)\n"); return 2; }
+
+  std::vector<Trace> traces;
+  int failed = 0;
+  for (const std::string& p : paths) {
+    Trace t;
+    if (!loadTrace(p, t)) { printf("FAIL  %s: unreadable or no expect line\n", p.c_str()); failed++; continue; }
+    const Expect dec = runDecoder(t), glue = runGlue(t);
+    const bool ok = same(dec, t.expect) && same(glue, t.expect);
+    if (!ok) failed++;
+    if (!ok || g_verbose) {
+      printf("%s  %-24s %zu samples\n", ok ? "ok  " : "FAIL", t.name.c_str(), t.samples.size());
+      if (!ok) { printExpect("expect", t.expect); printExpect("decoder", dec); printExpect("glue", glue); }
+    }
+    traces.push_back(t);
+  }
+  printf("%zu traces, %d failed\n", paths.size(), failed);
+
+  if (bench && !traces.empty()) {
+    printf("decoder  %.1f ns/sample\n", nsPerSample(traces, runDecoder));
+    printf("glue     %.1f ns/sample\n", nsPerSample(traces, runGlue));
+  }
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,112 @@
+#pragma once
+// Just enough of the Arduino-ESP32 core for the motion headers to compile on
+// a PC. Nothing here drives hardware: critical sections are no-ops, time
+// only moves in delay() (or when a tool sets g_hostUs), pins read LOW. A
+// tool can script input through g_hostPinRead, watch the idle waits through
+// g_hostOnDelay, and run the step timer's ISR with hostTimerAdvance().
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include <new>
+#include <unistd.h>
+#include <sys/ioctl.h>
+using std::min; using std::max;
+
+#define IRAM_ATTR
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
+#define PROGMEM
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define INPUT_PULLDOWN 3
+#define constrain(a, l, h) ((a) < (l) ? (l) : ((a) > (h) ? (h) : (a)))
+
+inline uint64_t g_hostUs = 0;
+inline int  (*g_hostPinRead)(int pin)     = nullptr;
+inline void (*g_hostOnDelay)(uint32_t ms) = nullptr;
+
+inline uint32_t millis() { return (uint32_t)(g_hostUs / 1000u); }
+inline uint32_t micros() { return (uint32_t)g_hostUs; }
+inline void delay(uint32_t ms) { g_hostUs += ms * 1000ull; if (g_hostOnDelay) g_hostOnDelay(ms); }
+inline void delayMicroseconds(uint32_t) {}
+inline void yield() {}
+inline void pinMode(int, int) {}
+inline void digitalWrite(int, int) {}
+inline int  digitalRead(int pin) { return g_hostPinRead ? g_hostPinRead(pin) : 0; }
+
+// 1 MHz auto-reload timer; it only counts when a tool advances it.
+struct hw_timer_t {
+  void   (*isr)()  = nullptr;
+  uint64_t count   = 0;
+  uint64_t alarm   = 0;
+  bool     enabled = false;
+};
+inline hw_timer_t* timerBegin(int, int, bool) { static hw_timer_t t; return &t; }
+inline void timerAttachInterrupt(hw_timer_t* t, void (*isr)(), bool) { t->isr = isr; }
+inline void timerAlarmWrite(hw_timer_t* t, uint64_t us, bool) { t->alarm = us; }
+inline void timerAlarmEnable(hw_timer_t* t) { t->enabled = true; }
+inline void timerAlarmDisable(hw_timer_t* t) { t->enabled = false; }
+inline void timerWrite(hw_timer_t* t, uint64_t v) { t->count = v; }
+inline uint64_t timerRead(hw_timer_t* t) { return t->count; }
+inline uint64_t timerAlarmRead(hw_timer_t* t) { return t->alarm; }
+
+// Let `us` of timer time pass, running the ISR at each alarm.
+inline void hostTimerAdvance(hw_timer_t* t, uint64_t us) {
+  while (t && t->isr && t->enabled && t->alarm) {
+    const uint64_t left = t->alarm > t->count ? t->alarm - t->count : 0;
+    if (left > us) { t->count += us; return; }
+    us -= left;
+    t->count = 0;
+    t->isr();
+  }
+}
+
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(x)
+#define portEXIT_CRITICAL(x)
+#define portENTER_CRITICAL_ISR(x)
+#define portEXIT_CRITICAL_ISR(x)
+
+typedef void (*TaskFunction_t)(void*);
+typedef void* TaskHandle_t;
+#define pdPASS 1
+inline int  xTaskCreatePinnedToCore(TaskFunction_t, const char*, uint32_t, void*, int, TaskHandle_t*, int) { return 0; }
+inline void vTaskDelete(void*) {}
+
+// Bytes go nowhere unless a tool points fd at a file descriptor (a pty in
+// tools/linktest); print() and friends are always dropped.
+struct HostSerial {
+  int fd = -1;
+  void begin(int) {}
+  int  available() { int n = 0; return fd >= 0 && ioctl(fd, FIONREAD, &n) == 0 ? n : 0; }
+  int  read() { uint8_t c; return fd >= 0 && ::read(fd, &c, 1) == 1 ? c : -1; }
+  size_t write(const uint8_t* p, size_t n) {
+    for (size_t w = 0; fd >= 0 && w < n; ) { ssize_t k = ::write(fd, p + w, n - w); if (k <= 0) return w; w += (size_t)k; }
+    return n;
+  }
+  size_t write(uint8_t c) { return write(&c, 1); }
+  template <class T> void print(T) {}
+  template <class T> void println(T) {}
+  void println() {}
+  void printf(const char*, ...) {}
+};
+inline HostSerial Serial;
+
+inline bool  psramFound() { return false; }
+inline void* ps_malloc(size_t n) { return malloc(n); }
+struct HostEsp {
+  uint32_t getFreeHeap()    { return 0; }
+  uint32_t getMinFreeHeap() { return 0; }
+  uint32_t getFreePsram()   { return 0; }
+  void restart() { exit(0); }
+};
+inline HostEsp ESP;
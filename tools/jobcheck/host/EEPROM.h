@@ -0,0 +1,12 @@
+#pragma once
+#include <string.h>
+#include <stdint.h>
+// RAM-only EEPROM: settings start at the firmware defaults every run.
+struct HostEeprom {
+  uint8_t d[4096];
+  void begin(int) {}
+  template <class T> void put(int a, const T& v) { memcpy(d + a, &v, sizeof v); }
+  template <class T> void get(int a, T& v) { memcpy(&v, d + a, sizeof v); }
+  void commit() {}
+};
+static HostEeprom EEPROM;
@@ -0,0 +1,27 @@
+#pragma once
+#include <stdint.h>
+// Headless display: config.h's helpers compile, nothing is drawn.
+#define TFT_BLACK 0
+#define TFT_WHITE 0xFFFF
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define MC_DATUM 4
+struct TFT_eSPI {
+  void begin() {}
+  void setRotation(int) {}
+  int  width()  { return 320; }
+  int  height() { return 170; }
+  void fillScreen(uint16_t) {}
+  void fillRect(int, int, int, int, uint16_t) {}
+  void fillRoundRect(int, int, int, int, int, uint16_t) {}
+  void setTextColor(uint16_t, uint16_t) {}
+  void setTextColor(uint16_t) {}
+  void setTextFont(int) {}
+  void setTextDatum(int) {}
+  void setCursor(int, int) {}
+  template <class T> void print(T) {}
+  void drawString(const char*, int, int) {}
+  bool getSwapBytes() { return false; }
+  void setSwapBytes(bool) {}
+  void pushImage(int32_t, int32_t, int32_t, int32_t, const uint16_t*) {}
+};
@@ -0,0 +1,14 @@
+#pragma once
+#include <Arduino.h>
+// No I2C bus: the encoder never answers, as on a rig without one.
+struct HostWire {
+  void begin(int, int, uint32_t) {}
+  void setClock(uint32_t) {}
+  void beginTransmission(int) {}
+  size_t write(uint8_t) { return 1; }
+  int  endTransmission(bool = true) { return 2; }
+  int  requestFrom(int, int, int = 1) { return 0; }
+  int  available() { return 0; }
+  int  read() { return -1; }
+};
+static HostWire Wire;
@@ -0,0 +1,4 @@
+#pragma once
+#include <stddef.h>
+#define MALLOC_CAP_8BIT 4
+inline size_t heap_caps_get_largest_free_block(int) { return 0; }
@@ -0,0 +1,16 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+// No flash: every partition lookup fails.
+typedef int esp_err_t;
+#ifndef ESP_OK
+  #define ESP_OK 0
+#endif
+#define ESP_FAIL -1
+enum { ESP_PARTITION_TYPE_DATA = 1 };
+enum { ESP_PARTITION_SUBTYPE_ANY = 0xff };
+struct esp_partition_t { size_t size; };
+inline const esp_partition_t* esp_partition_find_first(int, int, const char*) { return nullptr; }
+inline esp_err_t esp_partition_read(const esp_partition_t*, size_t, void*, size_t) { return ESP_FAIL; }
+inline esp_err_t esp_partition_write(const esp_partition_t*, size_t, const void*, size_t) { return ESP_FAIL; }
+inline esp_err_t esp_partition_erase_range(const esp_partition_t*, size_t, size_t) { return ESP_FAIL; }
@@ -0,0 +1,47 @@
+#pragma once
+#include <Arduino.h>
+#ifndef ESP_OK
+  #define ESP_OK 0
+#endif
+typedef void (*esp_timer_cb_t)(void*);
+// Periodic timers only fire when a tool calls hostEspTimersRun().
+struct esp_timer {
+  esp_timer_cb_t callback = nullptr;
+  void*          arg      = nullptr;
+  const char*    name     = nullptr;
+  uint64_t       period   = 0;
+  uint64_t       due      = 0;
+  bool           running  = false;
+};
+typedef esp_timer* esp_timer_handle_t;
+struct esp_timer_create_args_t {
+  esp_timer_cb_t callback = nullptr;
+  void* arg = nullptr;
+  int dispatch_method = 0;
+  const char* name = nullptr;
+  bool skip_unhandled_events = false;
+};
+inline esp_timer g_hostEspTimers[4];
+inline uint8_t   g_hostEspTimerCount = 0;
+
+inline int64_t esp_timer_get_time() { return (int64_t)g_hostUs; }
+inline int esp_timer_create(const esp_timer_create_args_t* a, esp_timer_handle_t* h) {
+  if (g_hostEspTimerCount >= 4) return -1;
+  esp_timer& t = g_hostEspTimers[g_hostEspTimerCount++];
+  t.callback = a->callback; t.arg = a->arg; t.name = a->name;
+  *h = &t;
+  return ESP_OK;
+}
+inline int esp_timer_start_periodic(esp_timer_handle_t t, uint64_t us) {
+  t->period = us; t->due = g_hostUs + us; t->running = true;
+  return ESP_OK;
+}
+inline int esp_timer_stop(esp_timer_handle_t t) { t->running = false; return ESP_OK; }
+
+// Run every periodic callback that is due by g_hostUs.
+inline void hostEspTimersRun() {
+  for (uint8_t i = 0; i < g_hostEspTimerCount; ++i) {
+    esp_timer& t = g_hostEspTimers[i];
+    while (t.running && t.period && t.due <= g_hostUs) { t.due += t.period; t.callback(t.arg); }
+  }
+}
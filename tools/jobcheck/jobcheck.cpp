@@ -0,0 +1,151 @@
+// Feasibility and ETA for job files on a PC, using the firmware's own
+// parser, planner and checker (job_check.h), so a shoot's jobs can be
+// checked in bulk before the rig is even switched on.
+//
+//   jobcheck [--rig rig.json] [--at mm] [--repeat n] [--edges] [--json] job.json...
+//
+// rig.json holds the RuntimeState fields the planner reads; anything left
+// out keeps the firmware default:
+//   {"microstep":16,"stepsPerRev":200,"pulleyTeeth":20,"beltPitch":2,
+//    "calQ16":0,"accel":8000,"minUs":60,"resLo":0,"resHi":0,"resMask":0}
+// --at is where the carriage starts (mm, default 0); the move from there to
+// the job's first point counts toward the ETA, as on the rig.
+// --repeat checks each job n times on one job arena, as the wizard does
+// while the duration is adjusted; every pass must agree and give back its
+// scratch (the host arena is the 6 KB one of a board without PSRAM).
+// --edges also runs a job that passes through the step ISR and checks every
+// axis's STEP pin rose once per planned step, loops included.
+// Exit status is 1 when any job has a violation.
+//
+// Build (from the repo root):
+//   g++ -std=gnu++17 -O2 -Itools/jobcheck/host -I. tools/jobcheck/jobcheck.cpp
+//       job.cpp motion_plan.cpp motor_control.cpp step_generator.cpp rig_scale.cpp
+//       resonance_map.cpp eeprom_utils.cpp mem_pool.cpp flight_recorder.cpp -o jobcheck
+
+#include <Arduino.h>
+#include "job_check.h"
+
+TFT_eSPI tft;   // config.h declares it; nothing is drawn
+
+// jobRun() hooks, normally from plan_cache.cpp and resume.cpp; nothing is
+// cached or resumed here
+bool planCacheStore(const JobSpec&) { return false; }
+void resumeArm() {}
+
+static bool readFile(const char* path, std::string& out) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  char buf[4096];
+  size_t n;
+  out.clear();
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out.append(buf, n);
+  fclose(f);
+  return true;
+}
+
+static bool rigNum(StrView rig, const char* key, float& v) {
+  StrView s;
+  return jsonFind(rig, key, s) && svToFloat(s, v);
+}
+
+// Apply rig.json to runtimeState and the slide axis, then rescale.
+static bool loadRig(const char* path) {
+  std::string text;
+  if (!readFile(path, text)) { fprintf(stderr, "jobcheck: cannot read %s\n", path); return false; }
+  const StrView rig{ text.data(), text.size() };
+  float v;
+  if (rigNum(rig, "microstep", v))   runtimeState.microstep = (uint16_t)v;
+  if (rigNum(rig, "stepsPerRev", v)) runtimeState.steps_per_rev = (uint16_t)v;
+  if (rigNum(rig, "pulleyTeeth", v)) runtimeState.pulley_teeth = (uint16_t)v;
+  if (rigNum(rig, "beltPitch", v))   runtimeState.belt_pitch_mm = v;
+  if (rigNum(rig, "calQ16", v))      runtimeState.calStepsPerCountQ16 = (uint32_t)v;
+  if (rigNum(rig, "resLo", v))       runtimeState.resRateLo = v;
+  if (rigNum(rig, "resHi", v))       runtimeState.resRateHi = v;
+  if (rigNum(rig, "resMask", v))     runtimeState.resBandMask = (uint32_t)v;
+  if (rigNum(rig, "accel", v))       g_axes[AXIS_SLIDE].accel = v;
+  if (rigNum(rig, "minUs", v))       g_axes[AXIS_SLIDE].minUsPerStep = (uint32_t)v;
+  g_axes[AXIS_SLIDE].microstep = runtimeState.microstep;
+  return true;
+}
+
+static void printReport(const char* name, const JobCheck& c) {
+  char eta[16];
+  jobCheckFmtMs(c.totalMs, eta, sizeof(eta));
+  if (c.flags & (JC_INVALID | JC_TOO_FAST | JC_TOO_LONG | JC_RANGE)) printf("%s: FAIL", name);
+  else printf("%s: %s  eta %s  %u segments  %u steps  peak rate %.0f%%  accel %.0f%%",
+              name, c.ok() ? "ok" : "WARN", eta, (unsigned)c.segments, (unsigned)c.totalSteps,
+              c.ratePct, c.accelPct);
+  for (uint8_t b = 0; b < JC_FLAG_COUNT; ++b)
+    if (c.flags & (1u << b)) printf("  [%s]", jobCheckFlagName(b));
+  if (c.error) printf("  %s", c.error);
+  if (c.leg) printf(": leg %u asks %.1f s, the rig needs %.1f s",
+                    (unsigned)c.leg, c.legMs / 1000.0f, c.legMinMs / 1000.0f);
+  printf("\n");
+}
+
+// Compile j again, run it through stepGenIsr() to the end and compare the
+// rising edges on each STEP mask with the steps the plan holds.
+static bool runEdges(const JobSpec& j) {
+  if (jobCompile(j) != PLAN_OK) return false;
+  uint64_t want[MOTION_AXES] = {0};
+  for (uint16_t i = 0; i < plan.count; ++i) {
+    const uint32_t passes = (i >= plan.loopStart && i < plan.loopEnd) ? plan.loops : 1;
+    for (uint8_t a = 0; a < MOTION_AXES; ++a) want[a] += (uint64_t)abs(plan.seg[i].steps[a]) * passes;
+  }
+  memset(g_hostGpioRises, 0, sizeof(g_hostGpioRises));
+  if (planStart()) while (plan.active) { g_hostUs += 1000; stepGenIsr(); }
+  bool ok = true;
+  for (uint8_t a = 0; a < MOTION_AXES; ++a) ok &= hostGpioRises(AXIS_STEP_MASK[a]) == want[a];
+  return ok;
+}
+
+int main(int argc, char** argv) {
+  float atMm = 0.0f;
+  bool json = false, bad = false;
+  int files = 0, repeat = 1;
+  bool edges = false;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--rig") && i + 1 < argc)     { if (!loadRig(argv[++i])) return 2; continue; }
+    if (!strcmp(argv[i], "--at") && i + 1 < argc)      { atMm = (float)atof(argv[++i]); continue; }
+    if (!strcmp(argv[i], "--repeat") && i + 1 < argc)  { repeat = max(1, atoi(argv[++i])); continue; }
+    if (!strcmp(argv[i], "--edges"))                   { edges = true; continue; }
+    if (!strcmp(argv[i], "--json"))                    { json = true; continue; }
+    if (argv[i][0] == '-') {
+      fprintf(stderr, "usage: jobcheck [--rig rig.json] [--at mm] [--repeat n] [--edges] [--json] job.json...\n");
+      return 2;
+    }
+    scaleRefresh();
+    g_axisPos[AXIS_SLIDE] = (int32_t)lroundf(atMm * stepsPerMM());
+
+    std::string text;
+    JobCheck c;
+    if (!readFile(argv[i], text)) { fprintf(stderr, "jobcheck: cannot read %s\n", argv[i]); bad = true; continue; }
+    jobArenaReset();
+    JobSpec* j = arenaNew<JobSpec>(jobArena());
+    const char* err = nullptr;
+    if (!jobParse(StrView{ text.data(), text.size() }, *j, err)) c.fail(JC_INVALID, err);
+    else {
+      jobCheck(*j, c);
+      const uint32_t used = arenaMark(jobArena());
+      for (int r = 1; r < repeat; ++r) {
+        JobCheck again;
+        jobCheck(*j, again);
+        if (again.flags != c.flags || arenaMark(jobArena()) != used) { c.fail(JC_INVALID, "repeated check differs"); break; }
+      }
+      if (edges && c.ok() && !runEdges(*j)) c.fail(JC_INVALID, "STEP edges differ from the plan");
+    }
+    files++;
+    bad |= !c.ok();
+
+    if (json) {
+      static HttpResponse r;
+      r.reset();
+      jobCheckJson(c, r);
+      printf("%s\n", r.body);
+    } else {
+      printReport(argv[i], c);
+    }
+  }
+  if (!files) { fprintf(stderr, "usage: jobcheck [--rig rig.json] [--at mm] [--repeat n] [--edges] [--json] job.json...\n"); return 2; }
+  return bad ? 1 : 0;
+}
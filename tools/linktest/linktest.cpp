@@ -0,0 +1,276 @@
+// Serial link test on a PC: serial_link.h runs on one end of a Linux pty,
+// as it would on the USB port, and this program is the host on the other.
+// Frames are built here independently of the firmware's COBS and CRC code,
+// so both sides of the protocol are checked, not one against itself.
+//
+//   linktest [-v]
+//
+// Checks that replies echo seq and carry the right status and payload,
+// that a frame with a bad CRC gets no reply and is counted (PING reports
+// bad frames), and that the receiver resyncs on the next 0x00 after line
+// noise or an overlong frame. A microstep change must leave the carriage's
+// position in mm alone, calibrated or not, and keep the resonance bands
+// at the same carriage speeds. -v prints every exchange. Exit status is 1
+// when a check fails.
+//
+// Build (from the repo root):
+//   g++ -std=gnu++17 -O2 -Itools/jobcheck/host -I. tools/linktest/linktest.cpp
+//       serial_link.cpp rotary_input.cpp boot.cpp crawl.cpp eeprom_utils.cpp
+//       encoder_utils.cpp flight_recorder.cpp job.cpp manual_drive.cpp mem_pool.cpp
+//       motion_plan.cpp motor_control.cpp plan_cache.cpp resonance_map.cpp resume.cpp
+//       rig_scale.cpp settle.cpp step_generator.cpp take.cpp -o linktest -lutil
+
+#include <Arduino.h>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <termios.h>
+#include "serial_link.h"
+
+TFT_eSPI tft;
+
+typedef std::vector<uint8_t> Bytes;
+
+static bool g_verbose = false;
+static int  g_host    = -1;     // our end of the pty
+static int  g_failed  = 0;
+static uint8_t g_seq  = 0;
+
+static void check(bool ok, const char* what) {
+  if (!ok) g_failed++;
+  if (!ok || g_verbose) printf("%s  %s\n", ok ? "ok  " : "FAIL", what);
+}
+
+// ---------- host side of the framing ----------
+static uint16_t crc16(const Bytes& b) {
+  uint16_t c = 0xFFFF;
+  for (uint8_t x : b) {
+    c ^= (uint16_t)(x << 8);
+    for (int k = 0; k < 8; ++k) c = (c & 0x8000) ? (uint16_t)((c << 1) ^ 0x1021) : (uint16_t)(c << 1);
+  }
+  return c;
+}
+
+static Bytes cobs(const Bytes& in) {
+  Bytes out(1, 0);
+  size_t codeAt = 0;
+  for (uint8_t x : in) {
+    if (x) { out.push_back(x); if (out.size() - codeAt < 0xFF) continue; }
+    out[codeAt] = (uint8_t)(out.size() - codeAt);
+    codeAt = out.size();
+    out.push_back(0);
+  }
+  out[codeAt] = (uint8_t)(out.size() - codeAt);
+  return out;
+}
+
+static Bytes uncobs(const Bytes& in) {
+  Bytes out;
+  for (size_t r = 0; r < in.size(); ) {
+    const uint8_t code = in[r++];
+    if (!code) return Bytes();
+    for (uint8_t i = 1; i < code && r < in.size(); ++i) out.push_back(in[r++]);
+    if (code != 0xFF && r < in.size()) out.push_back(0);
+  }
+  return out;
+}
+
+static Bytes frame(uint8_t type, const Bytes& payload, bool badCrc = false) {
+  Bytes f{ type, ++g_seq };
+  f.insert(f.end(), payload.begin(), payload.end());
+  uint16_t c = crc16(f);
+  if (badCrc) c ^= 0x0100;
+  f.push_back((uint8_t)c); f.push_back((uint8_t)(c >> 8));
+  Bytes e = cobs(f);
+  e.push_back(0);
+  return e;
+}
+
+static void sendRaw(const Bytes& b) {
+  if (write(g_host, b.data(), b.size()) != (ssize_t)b.size()) { perror("write"); exit(2); }
+}
+
+// Run the firmware loop until a whole frame comes back, or `ms` passes.
+// Returns the decoded frame minus its CRC; empty if none came or it was bad.
+static Bytes reply(int ms = 200) {
+  Bytes enc;
+  for (int t = 0; t < ms; ++t) {
+    serialLinkLoop();
+    pollfd p{ g_host, POLLIN, 0 };
+    if (poll(&p, 1, 1) <= 0) continue;
+    uint8_t c;
+    while (read(g_host, &c, 1) == 1) {
+      if (c) { enc.push_back(c); continue; }
+      Bytes f = uncobs(enc);
+      if (f.size() < 4) return Bytes();
+      const uint16_t crc = (uint16_t)(f[f.size() - 2] | (f[f.size() - 1] << 8));
+      f.resize(f.size() - 2);
+      if (crc16(f) != crc) return Bytes();
+      return f;
+    }
+  }
+  return Bytes();
+}
+
+static Bytes call(uint8_t type, const Bytes& payload = Bytes()) {
+  sendRaw(frame(type, payload));
+  return reply();
+}
+
+static Bytes le32(int32_t v) { Bytes b(4); memcpy(b.data(), &v, 4); return b; }
+static int32_t get32(const Bytes& f, size_t at) { int32_t v = 0; if (f.size() >= at + 4) memcpy(&v, &f[at], 4); return v; }
+static uint16_t get16(const Bytes& f, size_t at) { uint16_t v = 0; if (f.size() >= at + 2) memcpy(&v, &f[at], 2); return v; }
+
+static bool isReply(const Bytes& f, uint8_t type, uint8_t status) {
+  return f.size() >= 3 && f[0] == (type | SL_REPLY) && f[1] == g_seq && f[2] == status;
+}
+
+static uint16_t badFrames() {
+  Bytes f = call(SL_PING);
+  return isReply(f, SL_PING, CTL_OK) ? get16(f, 5) : 0xFFFF;
+}
+
+static Bytes setting(uint8_t op, uint8_t key, int32_t v = 0) {
+  Bytes p{ key };
+  if (op == SL_SET) { Bytes b = le32(v); p.insert(p.end(), b.begin(), b.end()); }
+  return call(op, p);
+}
+
+// ---------- checks ----------
+static void testRoundTrip() {
+  Bytes f = call(SL_PING);
+  check(isReply(f, SL_PING, CTL_OK) && f.size() >= 7 && f[3] == SERIAL_LINK_VERSION && f[4] == MOTION_AXES,
+        "PING: version, axes, seq echoed");
+
+  check(isReply(setting(SL_SET, SLK_SPEED_PCT, 60), SL_SET, CTL_OK), "SET speed 60");
+  f = setting(SL_GET, SLK_SPEED_PCT);
+  check(isReply(f, SL_GET, CTL_OK) && get32(f, 3) == 60, "GET speed reads back 60");
+  check(isReply(setting(SL_SET, SLK_SPEED_PCT, 300), SL_SET, CTL_RANGE), "SET speed 300 is out of range");
+
+  f = call(SL_STATUS);
+  check(isReply(f, SL_STATUS, CTL_OK) && f.size() >= 3 + 17, "STATUS carries a telemetry record");
+  check(isReply(call(0x7E), 0x7E, CTL_BAD), "unknown op gets CTL_BAD");
+
+  // a frame longer than one COBS block
+  Bytes job(300, ' ');
+  const char* json = "{\"type\":\"single\",\"a\":0,\"b\":0.0001}";
+  memcpy(job.data(), json, strlen(json));
+  job.insert(job.begin(), 1);       // dry run
+  f = call(SL_JOB, job);
+  check(isReply(f, SL_JOB, CTL_OK), "dry JOB over 254 bytes decodes");
+}
+
+static void testCrcReject() {
+  const uint16_t before = badFrames();
+  sendRaw(frame(SL_PING, Bytes(), true));
+  check(reply(50).empty(), "bad CRC: no reply");
+  check(badFrames() == before + 1, "bad CRC: counted");
+
+  // a frame that decodes to less than type+seq+crc
+  sendRaw(Bytes{ 0x02, 0x01, 0x00 });
+  check(reply(50).empty() && badFrames() == before + 2, "runt frame: dropped and counted");
+}
+
+static void testResync() {
+  uint16_t before = badFrames();
+  // line noise, then a good frame: the noise ends at the frame's delimiter...
+  Bytes noise{ 0x13, 0x37, 0xC0, 0xFF, 0x42 };
+  Bytes f = frame(SL_PING, Bytes());
+  noise.insert(noise.end(), f.begin(), f.end());
+  sendRaw(noise);
+  check(reply(50).empty(), "noise glued to a frame: both dropped");
+  // ...so the next frame is read cleanly
+  check(isReply(call(SL_PING), SL_PING, CTL_OK), "resync after noise");
+  check(badFrames() == before + 1, "noise counted once");
+
+  // more than the receive buffer without a delimiter
+  before = badFrames();
+  sendRaw(Bytes(SERIAL_LINK_RX_MAX + 100, 0x55));
+  sendRaw(Bytes{ 0 });
+  check(reply(50).empty(), "overlong frame: no reply");
+  check(isReply(call(SL_PING), SL_PING, CTL_OK), "resync after overflow");
+  check(badFrames() == before + 1, "overflow counted once");
+
+  // stray delimiters are empty frames: ignored, not errors
+  before = badFrames();
+  sendRaw(Bytes{ 0, 0, 0 });
+  check(isReply(call(SL_PING), SL_PING, CTL_OK) && badFrames() == before, "empty frames ignored");
+}
+
+static void testMicrostep() {
+  const int32_t ms = g_axes[AXIS_SLIDE].microstep;
+  g_axisPos[AXIS_SLIDE] = 1001;
+  check(isReply(setting(SL_SET, SLK_MICROSTEP, ms * 2), SL_SET, CTL_OK) && g_axisPos[AXIS_SLIDE] == 2002,
+        "SET microstep x2 rescales the position");
+  check(isReply(setting(SL_SET, SLK_MICROSTEP, ms), SL_SET, CTL_OK) && g_axisPos[AXIS_SLIDE] == 1001,
+        "SET microstep back restores it");
+  g_velMode = true;
+  check(isReply(setting(SL_SET, SLK_MICROSTEP, ms * 2), SL_SET, CTL_BUSY) && g_axisPos[AXIS_SLIDE] == 1001,
+        "SET microstep while driving is refused");
+  g_velMode = false;
+
+  // on a calibrated rig the encoder calibration is in microsteps too
+  runtimeState.calStepsPerCountQ16 = (uint32_t)lroundf(200.0f * ms / 4096.0f * 1.01f * 65536.0f);
+  runtimeState.calBacklashSteps    = 24;
+  scaleRefresh();
+  g_axisPos[AXIS_SLIDE] = 12345;
+  const float   spmm = rigScale().stepsPerMM;
+  const int32_t um   = scaleStepsToUm(g_axisPos[AXIS_SLIDE]);
+  check(isReply(setting(SL_SET, SLK_MICROSTEP, ms * 2), SL_SET, CTL_OK), "SET microstep x2 on a calibrated rig");
+  check(fabsf(rigScale().stepsPerMM - 2 * spmm) < 1e-3f * spmm && rigScale().backlashSteps == 48,
+        "calibrated stepsPerMM and backlash follow the microstep");
+  check(abs(scaleStepsToUm(g_axisPos[AXIS_SLIDE]) - um) <= 1, "calibrated position in mm unchanged");
+  check(isReply(setting(SL_SET, SLK_MICROSTEP, ms), SL_SET, CTL_OK)
+        && fabsf(rigScale().stepsPerMM - spmm) < 1e-3f * spmm && g_axisPos[AXIS_SLIDE] == 12345,
+        "calibrated rig: microstep back restores scale and position");
+  runtimeState.calStepsPerCountQ16 = 0;
+  runtimeState.calBacklashSteps    = 0;
+  scaleRefresh();
+
+  // resonance is mechanical: the band stays at the same carriage speed
+  runtimeState.resRateLo   = 400.0f * ms;
+  runtimeState.resRateHi   = 800.0f * ms;
+  runtimeState.resBandMask = 1UL << 4;
+  check(isReply(setting(SL_SET, SLK_MICROSTEP, ms * 2), SL_SET, CTL_OK)
+        && fabsf(runtimeState.resRateLo - 800.0f * ms) < 1e-2f * ms && fabsf(runtimeState.resRateHi - 1600.0f * ms) < 1e-2f * ms,
+        "resonance band rates follow the microstep");
+  check(isReply(setting(SL_SET, SLK_MICROSTEP, ms), SL_SET, CTL_OK)
+        && fabsf(runtimeState.resRateLo - 400.0f * ms) < 1e-2f * ms && runtimeState.resBandMask == 1UL << 4,
+        "resonance bands restored with the microstep");
+  runtimeState.resBandMask = 0;
+  g_axisPos[AXIS_SLIDE] = 0;
+}
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-v")) { g_verbose = true; continue; }
+    fprintf(stderr, "usage: linktest [-v]\n");
+    return 2;
+  }
+
+  int rig;
+  if (openpty(&g_host, &rig, nullptr, nullptr, nullptr) < 0) { perror("openpty"); return 2; }
+  termios t;
+  for (int fd : { g_host, rig }) { tcgetattr(fd, &t); cfmakeraw(&t); tcsetattr(fd, TCSANOW, &t); }
+  fcntl(g_host, F_SETFL, fcntl(g_host, F_GETFL) | O_NONBLOCK);
+  fcntl(rig, F_SETFL, fcntl(rig, F_GETFL) | O_NONBLOCK);
+  Serial.fd = rig;
+
+  // setup(), minus the display, inputs and sockets
+  flightRecorderBegin();
+  initMotor();
+  stepGenInit();
+  eepromInit();
+  eepromLoadAllIntoRuntime();
+  scaleRefresh();
+  serialLinkBegin();
+
+  testRoundTrip();
+  testCrcReject();
+  testResync();
+  testMicrostep();
+
+  printf("%s: %d check%s failed\n", g_failed ? "FAIL" : "ok", g_failed, g_failed == 1 ? "" : "s");
+  return g_failed ? 1 : 0;
+}
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""Pack assets/*.png into the firmware's compressed image format (image_asset.h).
+
+    pack_assets.py            regenerate assets.h / assets.cpp
+    pack_assets.py --check    exit 1 if they are out of date with assets/
+
+Each PNG becomes ASSET_<NAME> (name from the file name, upper-cased), an
+ImageAsset in flash drawn with imgDraw(). Pixels with alpha below 128 are
+transparent: they are stored as a key colour the image does not otherwise
+use and drawn in the caller's background.
+
+Run it after adding or changing a PNG and commit the generated files with
+it; the Arduino build only compiles what is in the sketch folder. Only the
+standard library is needed (8-bit PNGs, or palette PNGs of any depth,
+non-interlaced).
+"""
+import os
+import struct
+import sys
+import zlib
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SRC = os.path.join(ROOT, "assets")
+HEADER = "// Generated by tools/pack_assets.py from assets/*.png; do not edit.\n"
+
+
+# ---------- PNG ----------
+def read_png(path):
+    """(w, h, [(r, g, b, a)] row-major)."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        raise SystemExit("%s: not a PNG" % path)
+    pos, idat, palette, trns = 8, b"", None, None
+    while pos < len(data):
+        n, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + n]
+        pos += 12 + n
+        if kind == b"IHDR":
+            w, h, depth, ctype, _, _, interlace = struct.unpack(">IIBBBBB", body)
+        elif kind == b"PLTE":
+            palette = [tuple(body[i:i + 3]) for i in range(0, len(body), 3)]
+        elif kind == b"tRNS":
+            trns = body
+        elif kind == b"IDAT":
+            idat += body
+        elif kind == b"IEND":
+            break
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[ctype]
+    if interlace or (depth != 8 and ctype != 3):
+        raise SystemExit("%s: need 8-bit (or palette), non-interlaced" % path)
+
+    raw = zlib.decompress(idat)
+    stride = (w * channels * depth + 7) // 8
+    bpp = max(1, channels * depth // 8)
+    rows, prev, off = [], bytearray(stride), 0
+    for _ in range(h):
+        ftype, line = raw[off], bytearray(raw[off + 1:off + 1 + stride])
+        off += 1 + stride
+        for i in range(stride):
+            a = line[i - bpp] if i >= bpp else 0
+            b = prev[i]
+            c = prev[i - bpp] if i >= bpp else 0
+            if ftype == 1:
+                line[i] = (line[i] + a) & 255
+            elif ftype == 2:
+                line[i] = (line[i] + b) & 255
+            elif ftype == 3:
+                line[i] = (line[i] + (a + b) // 2) & 255
+            elif ftype == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                pred = a if pa <= pb and pa <= pc else b if pb <= pc else c
+                line[i] = (line[i] + pred) & 255
+        rows.append(line)
+        prev = line
+
+    px = []
+    for line in rows:
+        for x in range(w):
+            if ctype == 3:
+                bit = x * depth
+                v = (line[bit // 8] >> (8 - depth - bit % 8)) & ((1 << depth) - 1)
+                r, g, b = palette[v]
+                a = trns[v] if trns and v < len(trns) else 255
+            else:
+                s = line[x * channels:(x + 1) * channels]
+                if ctype == 0:
+                    r = g = b = s[0]; a = 255
+                elif ctype == 4:
+                    r = g = b = s[0]; a = s[1]
+                elif ctype == 2:
+                    r, g, b = s; a = 255
+                else:
+                    r, g, b, a = s
+            px.append((r, g, b, a))
+    return w, h, px
+
+
+# ---------- encoder (mirrors imgNext() in image_asset.h) ----------
+def rgb565(r, g, b):
+    return ((r * 31 + 127) // 255) << 11 | ((g * 63 + 127) // 255) << 5 | (b * 31 + 127) // 255
+
+
+def qhash(c):
+    return ((c >> 11) * 3 + ((c >> 5) & 63) * 5 + (c & 31) * 7) & 63
+
+
+def wrap(d, bits):
+    half = 1 << (bits - 1)
+    return (d + half) % (1 << bits) - half
+
+
+def encode(pixels):
+    out, index, prev, run = bytearray(), [0] * 64, 0, 0
+    for i, c in enumerate(pixels):
+        if c == prev:
+            run += 1
+            if run == 62 or i == len(pixels) - 1:
+                out.append(0xC0 | (run - 1))
+                run = 0
+            continue
+        if run:
+            out.append(0xC0 | (run - 1))
+            run = 0
+        h = qhash(c)
+        if index[h] == c:
+            out.append(h)
+        else:
+            index[h] = c
+            dr = wrap((c >> 11) - (prev >> 11), 5)
+            dg = wrap(((c >> 5) & 63) - ((prev >> 5) & 63), 6)
+            db = wrap((c & 31) - (prev & 31), 5)
+            rr, bb = dr - (dg >> 1), db - (dg >> 1)
+            if -2 <= dr <= 1 and -2 <= dg <= 1 and -2 <= db <= 1:
+                out.append(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2))
+            elif -8 <= rr <= 7 and -8 <= bb <= 7:
+                out += bytes((0x80 | (dg + 32), (rr + 8) << 4 | (bb + 8)))
+            else:
+                out += bytes((0xFE, c & 255, c >> 8))
+        prev = c
+    return bytes(out)
+
+
+def pack(path):
+    w, h, px = read_png(path)
+    opaque = [rgb565(r, g, b) for r, g, b, a in px]
+    clear = [a < 128 for _, _, _, a in px]
+    key = None
+    if any(clear):
+        used = {c for c, t in zip(opaque, clear) if not t}
+        key = next(c for c in [0xF81F] + list(range(0x10000)) if c not in used)
+        opaque = [key if t else c for c, t in zip(opaque, clear)]
+    return w, h, key, encode(opaque)
+
+
+# ---------- output ----------
+def generate():
+    names = sorted(f for f in os.listdir(SRC) if f.lower().endswith(".png"))
+    decls, defs = [], []
+    for f in names:
+        stem = os.path.splitext(f)[0]
+        sym = "ASSET_" + "".join(ch if ch.isalnum() else "_" for ch in stem).upper()
+        w, h, key, blob = pack(os.path.join(SRC, f))
+        decls.append("extern const ImageAsset %s;   // %dx%d, %d bytes (raw %d)"
+                     % (sym, w, h, len(blob), w * h * 2))
+        body = ",\n".join("  " + ", ".join("0x%02X" % b for b in blob[i:i + 16])
+                          for i in range(0, len(blob), 16))
+        defs.append("static const uint8_t %s_DATA[] = {\n%s\n};\n"
+                    "const ImageAsset %s = { %s_DATA, sizeof(%s_DATA), %d, %d, 0x%04X, %s };\n"
+                    % (sym, body, sym, sym, sym, w, h, key or 0, "true" if key is not None else "false"))
+    header = ("#ifndef ASSETS_H\n#define ASSETS_H\n\n" + HEADER + "\n#include \"image_asset.h\"\n\n"
+              + "\n".join(decls) + "\n\n#endif\n")
+    source = HEADER + "#include \"assets.h\"\n\n" + "\n".join(defs)
+    return {"assets.h": header, "assets.cpp": source}
+
+
+def main(argv):
+    files = generate()
+    if "--check" in argv:
+        stale = []
+        for name, text in files.items():
+            try:
+                with open(os.path.join(ROOT, name)) as f:
+                    if f.read() != text:
+                        stale.append(name)
+            except FileNotFoundError:
+                stale.append(name)
+        if stale:
+            print("out of date: %s (run tools/pack_assets.py)" % ", ".join(stale))
+            return 1
+        return 0
+    for name, text in files.items():
+        with open(os.path.join(ROOT, name), "w") as f:
+            f.write(text)
+    print("\n".join(l.split("extern const ImageAsset ")[1] for l in files["assets.h"].splitlines()
+                    if l.startswith("extern")))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,134 @@
+// Heap check for the control API on a PC: every route in CONTROL_ROUTES is
+// parsed with httpParseRequest(), dispatched with httpDispatch() and its
+// head formatted, as serve-time does, while malloc/calloc/realloc and
+// operator new are counted. Any allocation fails the run.
+//
+//   routecheck [-v] [rounds]
+//
+// Each request runs once uncounted first, so one-time setup (a take buffer,
+// a timer) is not charged; then `rounds` (default 100) counted passes
+// follow. -v prints every route's status and count.
+//
+// Build (from the repo root):
+//   g++ -std=gnu++17 -O2 -Itools/httpbench/host -Itools/jobcheck/host -I.
+//       tools/routecheck/routecheck.cpp web_server.cpp wifi_link.cpp boot.cpp crawl.cpp
+//       eeprom_utils.cpp encoder_utils.cpp flight_recorder.cpp job.cpp manual_drive.cpp
+//       mem_pool.cpp motion_plan.cpp motor_control.cpp plan_cache.cpp resonance_map.cpp
+//       resume.cpp rig_scale.cpp settle.cpp step_generator.cpp take.cpp logo.cpp
+//       assets.cpp image_asset.cpp -o routecheck
+// The counters replace glibc's malloc entry points, so this is Linux only.
+
+#include <Arduino.h>
+#include "web_server.h"
+
+TFT_eSPI tft;
+HostWiFi WiFi;
+
+// ---------- allocation counter ----------
+static bool     g_counting = false;
+static uint32_t g_allocs   = 0;
+
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void  __libc_free(void*);
+
+void* malloc(size_t n) noexcept            { if (g_counting) g_allocs++; return __libc_malloc(n); }
+void* calloc(size_t n, size_t s) noexcept  { if (g_counting) g_allocs++; return __libc_calloc(n, s); }
+void* realloc(void* p, size_t n) noexcept  { if (g_counting) g_allocs++; return __libc_realloc(p, n); }
+void  free(void* p) noexcept               { __libc_free(p); }
+}
+
+void* operator new(size_t n) {
+  if (g_counting) g_allocs++;
+  if (void* p = __libc_malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void* operator new[](size_t n) { return operator new(n); }
+void  operator delete(void* p) noexcept { __libc_free(p); }
+void  operator delete[](void* p) noexcept { __libc_free(p); }
+void  operator delete(void* p, size_t) noexcept { __libc_free(p); }
+void  operator delete[](void* p, size_t) noexcept { __libc_free(p); }
+
+// ---------- requests ----------
+// Arguments a route is exercised with; routes not listed get none.
+struct RouteArgs { const char* path; const char* query; const char* body; };
+static const RouteArgs ARGS[] = {
+  { "/api/drive",    "dir=1&p=50",         nullptr },
+  { "/api/jog",      "mm=2",               nullptr },
+  { "/api/setSpeed", "p=60",               nullptr },
+  { "/api/job",      nullptr,              "{\"type\":\"bounce\",\"a\":10,\"b\":60,\"pct\":80,\"repeat\":2}" },
+  { "/api/log",      "rec=0&from=0",       nullptr },
+  { "/api/wifi",     nullptr,              "{\"mode\":0}" },
+  { "/api/crawl",    "mmh=0",              nullptr },
+  { "/api/take",     "cmd=stop",           nullptr },
+  { "/api/resume",   "cmd=discard",        nullptr },
+};
+
+static char g_rx[CONTROL_RX_MAX];
+
+static size_t buildRequest(const HttpRoute& r) {
+  const RouteArgs* a = nullptr;
+  for (const RouteArgs& x : ARGS) if (!strcmp(x.path, r.path)) a = &x;
+  const char* q = a && a->query ? a->query : "";
+  const char* b = a && a->body && r.method == HM_POST ? a->body : "";
+  return (size_t)snprintf(g_rx, sizeof(g_rx), "%s %s%s%s HTTP/1.1\r\nHost: slidepilot\r\n"
+                          "Content-Length: %u\r\n\r\n%s", r.method == HM_POST ? "POST" : "GET",
+                          r.path, *q ? "?" : "", q, (unsigned)strlen(b), b);
+}
+
+// What controlServerLoop() does with a complete request, minus the socket
+static int serve(size_t len) {
+  HttpRequest req;
+  if (httpParseRequest(g_rx, len, req) != HP_OK) g_ctlResp.text(400, "400");
+  else httpDispatch(CONTROL_ROUTES, CONTROL_ROUTE_COUNT, req, g_ctlResp);
+  httpFormatHead(g_ctlResp, g_ctlHead, sizeof(g_ctlHead));
+  // stop, and let drives ramp down so the next request finds the rig idle
+  ctlStop();
+  for (int ms = 0; motionBusy() && ms < 5000; ++ms) {
+    g_hostUs += 1000;
+    hostTimerAdvance(g_stepTimer, 1000);
+    hostEspTimersRun();
+    driveLoop();
+  }
+  return g_ctlResp.status;
+}
+
+int main(int argc, char** argv) {
+  bool verbose = false;
+  int rounds = 100;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-v")) { verbose = true; continue; }
+    if (argv[i][0] == '-' || (rounds = atoi(argv[i])) <= 0) {
+      fprintf(stderr, "usage: routecheck [-v] [rounds]\n");
+      return 2;
+    }
+  }
+
+  // setup(), minus the display, inputs and sockets
+  flightRecorderBegin();
+  initMotor();
+  stepGenInit();
+  eepromInit();
+  eepromLoadAllIntoRuntime();
+  scaleRefresh();
+
+  uint32_t total = 0;
+  for (size_t i = 0; i < CONTROL_ROUTE_COUNT; ++i) {
+    const HttpRoute& r = CONTROL_ROUTES[i];
+    const size_t len = buildRequest(r);
+    const int status = serve(len);
+    g_allocs = 0;
+    g_counting = true;
+    for (int n = 0; n < rounds; ++n) serve(len);
+    g_counting = false;
+    total += g_allocs;
+    if (verbose || g_allocs)
+      printf("%-4s %-14s %3d  %u allocations\n", r.method == HM_POST ? "POST" : "GET", r.path, status,
+             (unsigned)g_allocs);
+  }
+  printf("%u routes x %d requests: %u heap allocations\n", (unsigned)CONTROL_ROUTE_COUNT, rounds,
+         (unsigned)total);
+  return total ? 1 : 0;
+}
@@ -0,0 +1,146 @@
+#pragma once
+// Counting display for tools/screenbench: same calls as TFT_eSPI, nothing is
+// drawn. Every call is charged what the real library sends over the bus
+// (address windows, pixels, glyph boxes) and an estimated bus time, so a
+// screen's cost can be measured on a PC.
+//
+// The model follows TFT_eSPI's drawing paths, not the exact pixels:
+//   fillRect/fillScreen  one window, w*h pixels (clipped to the panel)
+//   fillRoundRect        a rect plus one span per corner row (2r windows)
+//   text, opaque         one window per glyph, its whole box of pixels
+//   text, transparent    (fg == bg) runs: ~2 windows per glyph row, ~35 %
+//                        of the box
+//   pushImage            one window, w*h pixels
+// Glyph widths are per-font averages; bus time defaults to the T-Display
+// S3's 8-bit parallel ST7789 at about 20 MB/s.
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+#define TFT_BLACK 0
+#define TFT_WHITE 0xFFFF
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define MC_DATUM 4
+
+struct DisplayCostModel {
+  float    nsPerByte   = 50.0f;   // bus write rate
+  float    callUs      = 1.5f;    // CPU work per draw call (clipping, setup)
+  uint8_t  windowBytes = 11;      // CASET + RASET + RAMWR with arguments
+};
+
+struct DisplayCost {
+  uint32_t calls   = 0;
+  uint32_t windows = 0;
+  uint32_t pixels  = 0;
+  uint32_t glyphs  = 0;
+  uint64_t bytes   = 0;
+  float    busUs   = 0.0f;
+
+  DisplayCost& operator+=(const DisplayCost& o) {
+    calls += o.calls; windows += o.windows; pixels += o.pixels;
+    glyphs += o.glyphs; bytes += o.bytes; busUs += o.busUs;
+    return *this;
+  }
+  DisplayCost operator-(const DisplayCost& o) const {
+    DisplayCost d;
+    d.calls = calls - o.calls; d.windows = windows - o.windows; d.pixels = pixels - o.pixels;
+    d.glyphs = glyphs - o.glyphs; d.bytes = bytes - o.bytes; d.busUs = busUs - o.busUs;
+    return d;
+  }
+};
+
+enum DrawKind : uint8_t { DK_FILL, DK_ROUND, DK_TEXT, DK_IMAGE, DK_KINDS };
+
+struct TFT_eSPI {
+  DisplayCostModel model;
+  DisplayCost      total;
+  DisplayCost      byKind[DK_KINDS];
+  uint32_t         clears = 0;           // fillScreen calls: full redraws
+  void           (*onClear)() = nullptr; // called after each fillScreen
+
+  void begin() {}
+  void setRotation(int) {}
+  int  width()  { return 320; }
+  int  height() { return 170; }
+
+  void fillScreen(uint16_t) {
+    charge(DK_FILL, 1, area(0, 0, width(), height()), 0);
+    clears++;
+    if (onClear) onClear();
+  }
+  void fillRect(int x, int y, int w, int h, uint16_t) { charge(DK_FILL, 1, area(x, y, w, h), 0); }
+  void fillRoundRect(int x, int y, int w, int h, int r, uint16_t) {
+    r = std::max(0, std::min(r, std::min(w, h) / 2));
+    const int32_t px = area(x, y, w, h) - (int32_t)(0.86f * r * r);   // (4 - pi) r^2 cut off
+    charge(DK_ROUND, 1 + 2 * r, (uint32_t)std::max<int32_t>(0, px), 0);
+  }
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t*) {
+    charge(DK_IMAGE, 1, area(x, y, w, h), 0);
+  }
+  bool getSwapBytes() { return swap; }
+  void setSwapBytes(bool s) { swap = s; }
+
+  void setTextColor(uint16_t c, uint16_t bg) { fg = c; textBg = bg; }
+  void setTextColor(uint16_t c) { fg = textBg = c; }
+  void setTextFont(int f) { font = f; }
+  void setTextDatum(int) {}
+  void setCursor(int, int) {}
+  void drawString(const char* s, int, int) { text(s); }
+  void print(const char* s) { text(s); }
+  void print(char c) { const char s[2] = { c, 0 }; text(s); }
+  void print(int v) { char s[16]; snprintf(s, sizeof(s), "%d", v); text(s); }
+  void print(unsigned v) { char s[16]; snprintf(s, sizeof(s), "%u", v); text(s); }
+  void print(long v) { char s[24]; snprintf(s, sizeof(s), "%ld", v); text(s); }
+  void print(unsigned long v) { char s[24]; snprintf(s, sizeof(s), "%lu", v); text(s); }
+  void print(double v) { char s[24]; snprintf(s, sizeof(s), "%.2f", v); text(s); }
+
+  // Box of an average glyph in the current font (TFT_eSPI fonts 1, 2, 4, 6, 7, 8).
+  void glyphBox(int& w, int& h) const {
+    switch (font) {
+      case 2:  w = 8;  h = 16; break;
+      case 4:  w = 14; h = 26; break;
+      case 6:  w = 27; h = 48; break;
+      case 7:  w = 29; h = 48; break;
+      case 8:  w = 55; h = 75; break;
+      default: w = 6;  h = 8;  break;
+    }
+  }
+
+  void resetCounts() { total = DisplayCost(); for (auto& k : byKind) k = DisplayCost(); clears = 0; }
+
+ private:
+  int      font   = 1;
+  uint16_t fg     = TFT_WHITE;
+  uint16_t textBg = TFT_BLACK;
+  bool     swap   = false;
+
+  uint32_t area(int32_t x, int32_t y, int32_t w, int32_t h) {
+    const int32_t x0 = std::max<int32_t>(0, x), y0 = std::max<int32_t>(0, y);
+    const int32_t x1 = std::min<int32_t>(width(), x + w), y1 = std::min<int32_t>(height(), y + h);
+    return (x1 > x0 && y1 > y0) ? (uint32_t)((x1 - x0) * (y1 - y0)) : 0;
+  }
+
+  void text(const char* s) {
+    uint32_t n = 0;
+    for (; *s; ++s) if (*s != '\n' && *s != '\r') n++;
+    if (!n) { charge(DK_TEXT, 0, 0, 0); return; }
+    int w, h;
+    glyphBox(w, h);
+    if (fg != textBg) charge(DK_TEXT, n, n * w * h, n);
+    else              charge(DK_TEXT, n * 2 * h, (uint32_t)(n * w * h * 0.35f), n);
+  }
+
+  void charge(DrawKind k, uint32_t windows, uint32_t pixels, uint32_t glyphs) {
+    DisplayCost c;
+    c.calls   = 1;
+    c.windows = windows;
+    c.pixels  = pixels;
+    c.glyphs  = glyphs;
+    c.bytes   = (uint64_t)windows * model.windowBytes + 2ull * pixels;
+    c.busUs   = c.bytes * model.nsPerByte / 1000.0f + model.callUs;
+    total += c;
+    byKind[k] += c;
+  }
+};
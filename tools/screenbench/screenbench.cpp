@@ -0,0 +1,268 @@
+// Frame cost of the UI screens on a PC: each screen and navigation sequence
+// runs against a counting display (host/TFT_eSPI.h) with scripted knob and
+// button input, and every frame is charged the windows, pixels, glyphs and
+// bytes it sends and an estimated bus time. Run it before and after a UI
+// change to see what a redraw costs.
+//
+//   screenbench [--kinds] [--json] [--ns-per-byte N] [--call-us N] [scenario...]
+//
+// A frame is everything drawn between two idle waits (delay()), which is
+// when the screens poll input. --kinds splits each scenario's bus time by
+// draw call (fill, round rect, text, image); --ns-per-byte and --call-us
+// change the bus model. Scenario names pick a subset.
+//
+// Build (from the repo root):
+//   g++ -std=gnu++17 -O2 -Itools/screenbench/host -Itools/httpbench/host -Itools/jobcheck/host -I.
+//       tools/screenbench/screenbench.cpp assets.cpp image_asset.cpp logo.cpp menu.cpp
+//       rotary_input.cpp eeprom_utils.cpp encoder_utils.cpp flight_recorder.cpp mem_pool.cpp
+//       job.cpp motion_plan.cpp motor_control.cpp step_generator.cpp plan_cache.cpp resume.cpp
+//       resonance_map.cpp rig_scale.cpp settle.cpp manual_drive.cpp take.cpp serial_link.cpp
+//       wifi_link.cpp boot.cpp crawl.cpp -o screenbench
+// host/TFT_eSPI.h stands in for the display, tools/httpbench/host for
+// Wi-Fi (the settings menu reaches it); the rest of the core comes from
+// tools/jobcheck/host.
+
+#include <Arduino.h>
+#include <vector>
+#include "config.h"
+#include "logo.h"
+#include "menu.h"
+#include "settings_menu.h"
+#include "status_screen.h"
+#include "wizard_single_slide.h"
+#include "wizard_bounce_slide.h"
+#include "wizard_multi_slide.h"
+#include "wizard_timelapse.h"
+#include "previous_slide.h"
+#include "manual_mode.h"
+#include "take_screen.h"
+
+TFT_eSPI tft;
+HostWiFi WiFi;
+
+// ---------- scripted input ----------
+// Pin levels over time, as the panel's knob and buttons would produce them.
+struct PinEvent { uint32_t ms; uint8_t ab; bool ok, back; };
+
+static std::vector<PinEvent> g_script;
+static uint32_t g_scriptMs;              // end of the script so far
+
+static const PinEvent& scriptLast() { return g_script.back(); }
+static void scriptAt(uint32_t ms, uint8_t ab, bool ok, bool back) {
+  g_script.push_back(PinEvent{ ms, ab, ok, back });
+  g_scriptMs = max(g_scriptMs, ms);
+}
+static void scriptStart() {
+  g_script.clear();
+  g_scriptMs = millis();
+  scriptAt(g_scriptMs, 3, false, false);   // knob at rest, nothing pressed
+}
+static void scriptWait(uint32_t ms) { g_scriptMs += ms; }
+
+// One detent: two quadrature transitions (ROTARY_STEPS_PER_DETENT 2)
+static void scriptTurn(int detents, uint32_t gapMs = 250) {
+  static const uint8_t cw[4] = { 3, 2, 0, 1 };   // gray code, clockwise
+  for (int n = 0; n < abs(detents); ++n) {
+    scriptWait(gapMs);
+    const PinEvent& e = scriptLast();
+    int i = 0;
+    while (cw[i] != e.ab) ++i;
+    for (int t = 1; t <= 2; ++t) {
+      const int j = detents > 0 ? (i + t) & 3 : (i - t) & 3;
+      scriptAt(g_scriptMs + 3 * t, cw[j], e.ok, e.back);
+    }
+    g_scriptMs += 6;
+  }
+}
+static void scriptPress(bool ok, uint32_t holdMs = 80) {
+  scriptWait(200);
+  const uint8_t ab = scriptLast().ab;
+  scriptAt(g_scriptMs, ab, ok, !ok);
+  scriptAt(g_scriptMs + holdMs, ab, false, false);
+}
+
+static int scriptPin(int pin) {
+  const PinEvent* e = &g_script[0];
+  for (const PinEvent& s : g_script) if (s.ms <= millis()) e = &s;
+  if (pin == ROTARY_CLK_PIN) return (e->ab >> 1) & 1;
+  if (pin == ROTARY_DT_PIN)  return e->ab & 1;
+  if (pin == BTN_OK_PIN)     return e->ok ? LOW : HIGH;     // buttons are active-low
+  if (pin == BTN_BACK_PIN)   return e->back ? LOW : HIGH;
+  return LOW;
+}
+
+// ---------- frames ----------
+struct Frames {
+  uint32_t    count = 0;
+  DisplayCost sum;
+  DisplayCost worst;                 // by bus time
+  DisplayCost kinds[DK_KINDS];
+};
+
+static Frames      g_frames;
+static DisplayCost g_mark;
+static DisplayCost g_kindMark[DK_KINDS];
+
+static void frameCut() {
+  if (tft.total.calls == g_mark.calls) return;
+  const DisplayCost f = tft.total - g_mark;
+  g_frames.count++;
+  g_frames.sum += f;
+  if (f.busUs > g_frames.worst.busUs) g_frames.worst = f;
+  for (int k = 0; k < DK_KINDS; ++k) g_frames.kinds[k] += tft.byKind[k] - g_kindMark[k];
+  g_mark = tft.total;
+  for (int k = 0; k < DK_KINDS; ++k) g_kindMark[k] = tft.byKind[k];
+}
+static void onDelay(uint32_t) { frameCut(); }
+
+// The sketch's loop() for the main menu, until the script has played out
+static void menuLoopUntilDone() {
+  while (millis() <= g_scriptMs + 50) {
+    handleRotary();
+    handleMainMenu();
+    delay(5);
+  }
+}
+
+// ---------- scenarios ----------
+static void scSplash()   { splashBegin(); delay(1); }
+static void scMainMenu() { drawMainMenu(); delay(1); }
+static void scSettings() { drawSettings(); delay(1); }
+
+static void scMenuScroll() {
+  drawMainMenu();
+  scriptStart();
+  scriptTurn(+8);
+  scriptTurn(-8);
+  menuLoopUntilDone();
+}
+
+static void scStatus() {
+  scriptStart();
+  scriptWait(1000);
+  scriptPress(true);
+  openStatusScreen();
+}
+
+static void scSettingsScroll() {
+  scriptStart();
+  scriptTurn(+4);
+  scriptTurn(-4);
+  scriptPress(false, 100);
+  openSettingsMenu();
+}
+
+static void scProgress() {
+  for (int pct = 0; pct <= 100; ++pct) { progressUI(pct); delay(10); }
+}
+
+// Menu -> Status -> back -> Settings -> scroll -> back, as a user would
+static void scNavigate() {
+  drawMainMenu();
+  scriptStart();
+  scriptTurn(+7);
+  scriptPress(true);
+  scriptWait(600);
+  scriptPress(true);
+  scriptTurn(-1);
+  scriptPress(true);
+  scriptTurn(+2);
+  scriptTurn(-2);
+  scriptPress(false, 100);
+  menuLoopUntilDone();
+}
+
+struct Scenario { const char* name; void (*run)(); const char* what; };
+static const Scenario SCENARIOS[] = {
+  { "splash",          scSplash,         "boot splash, static part" },
+  { "menu",            scMainMenu,       "main menu, one draw" },
+  { "menu-scroll",     scMenuScroll,     "main menu, 8 detents down and back" },
+  { "status",          scStatus,         "status screen for 1 s" },
+  { "settings",        scSettings,       "settings, one draw" },
+  { "settings-scroll", scSettingsScroll, "settings, 4 detents down and back, Back" },
+  { "progress",        scProgress,       "job progress 0..100 %" },
+  { "navigate",        scNavigate,       "menu > status > settings > back" },
+};
+
+static void resetUi() {
+  g_mainMenu       = MenuView();
+  g_settingsMenu   = MenuView();
+  scriptStart();
+  inputInit();
+  tft.resetCounts();
+  g_mark = DisplayCost();
+  for (auto& k : g_kindMark) k = DisplayCost();
+  g_frames = Frames();
+}
+
+// ---------- report ----------
+static const char* KIND_NAMES[DK_KINDS] = { "fill", "round", "text", "image" };
+
+static void printRow(const Scenario& s, const Frames& f, bool kinds) {
+  const float n = f.count ? (float)f.count : 1.0f;
+  printf("%-16s %6u %7.1f %8.1f %8.1f %7.1f %8.1f %8.2f %8.2f\n", s.name, (unsigned)f.count,
+         f.sum.calls / n, f.sum.windows / n, f.sum.pixels / n / 1000.0f, f.sum.glyphs / n,
+         f.sum.bytes / n / 1024.0f, f.sum.busUs / n / 1000.0f, f.worst.busUs / 1000.0f);
+  if (!kinds) return;
+  for (int k = 0; k < DK_KINDS; ++k)
+    if (f.kinds[k].calls)
+      printf("  %-14s %6s %7.1f %8.1f %8.1f %7.1f %8.1f %8.2f\n", KIND_NAMES[k], "",
+             f.kinds[k].calls / n, f.kinds[k].windows / n, f.kinds[k].pixels / n / 1000.0f,
+             f.kinds[k].glyphs / n, f.kinds[k].bytes / n / 1024.0f, f.kinds[k].busUs / n / 1000.0f);
+}
+
+static void printJson(const Scenario& s, const Frames& f, bool first) {
+  const float n = f.count ? (float)f.count : 1.0f;
+  printf("%s\n  {\"scenario\":\"%s\",\"frames\":%u,\"calls\":%.1f,\"windows\":%.1f,\"pixels\":%.0f,"
+         "\"glyphs\":%.1f,\"bytes\":%.0f,\"busUs\":%.1f,\"worstUs\":%.1f,\"kinds\":{",
+         first ? "" : ",", s.name, (unsigned)f.count, f.sum.calls / n, f.sum.windows / n,
+         f.sum.pixels / n, f.sum.glyphs / n, f.sum.bytes / n, f.sum.busUs / n, f.worst.busUs);
+  bool firstKind = true;
+  for (int k = 0; k < DK_KINDS; ++k) {
+    if (!f.kinds[k].calls) continue;
+    printf("%s\"%s\":%.1f", firstKind ? "" : ",", KIND_NAMES[k], f.kinds[k].busUs / n);
+    firstKind = false;
+  }
+  printf("}}");
+}
+
+int main(int argc, char** argv) {
+  bool kinds = false, json = false;
+  std::vector<const char*> only;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--kinds"))                          { kinds = true; continue; }
+    if (!strcmp(argv[i], "--json"))                           { json = true; continue; }
+    if (!strcmp(argv[i], "--ns-per-byte") && i + 1 < argc)    { tft.model.nsPerByte = (float)atof(argv[++i]); continue; }
+    if (!strcmp(argv[i], "--call-us") && i + 1 < argc)        { tft.model.callUs = (float)atof(argv[++i]); continue; }
+    if (argv[i][0] == '-') {
+      fprintf(stderr, "usage: screenbench [--kinds] [--json] [--ns-per-byte N] [--call-us N] [scenario...]\n");
+      for (const Scenario& s : SCENARIOS) fprintf(stderr, "  %-16s %s\n", s.name, s.what);
+      return 2;
+    }
+    only.push_back(argv[i]);
+  }
+
+  g_hostPinRead = scriptPin;
+  g_hostOnDelay = onDelay;
+  tft.begin();
+
+  if (json) printf("[");
+  else printf("%-16s %6s %7s %8s %8s %7s %8s %8s %8s\n", "per frame", "frames", "calls",
+              "windows", "kpixels", "glyphs", "KB", "bus ms", "worst");
+  bool first = true;
+  for (const Scenario& s : SCENARIOS) {
+    bool want = only.empty();
+    for (const char* o : only) want |= !strcmp(o, s.name);
+    if (!want) continue;
+    resetUi();
+    s.run();
+    frameCut();
+    if (json) printJson(s, g_frames, first);
+    else printRow(s, g_frames, kinds);
+    first = false;
+  }
+  if (json) printf("\n]\n");
+  else printf("\nbus model: %.0f ns/byte, %.1f us/call, %u bytes/window\n",
+              tft.model.nsPerByte, tft.model.callUs, (unsigned)tft.model.windowBytes);
+  return 0;
+}
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""Per-module flash/RAM report for a firmware ELF, checked against a budget.
+
+    size_budget.py build/SliderPilot.ino.elf            report, fail if over budget
+    size_budget.py build/SliderPilot.ino.elf --update   write the current sizes as the budget
+    size_budget.py build/SliderPilot.ino.elf --top 8    also list the largest symbols
+
+Build first with the ELF kept, e.g.
+    arduino-cli compile -b esp32:esp32:esp32 --output-dir build .
+
+Every symbol is charged to the module whose source it comes from (from the
+debug line info), so code of a header-only module counts against that
+module even when it was inlined into another translation unit: motion_plan.h
+and motion_plan.cpp are both "motion_plan". Core and library code is
+"(core)", symbols without line info "(other)".
+
+Regions, by output section: flash (code and constants), ram (data + bss),
+iram (code that runs from internal RAM, e.g. the step ISR) and rtc.
+Initialised data is charged to both ram and flash.
+
+The budget (tools/size_budget.json, or --budget FILE) holds bytes per module
+and region plus totals. The check fails when any of them grows, or when a
+module appears that has no budget yet. After a deliberate change, run with
+--update and commit the new budget with it, so the growth is reviewed.
+A "note" in the budget (where it came from) is printed with the report;
+--update drops it.
+
+Tools default to the ESP32 toolchain (xtensa-esp32-elf-nm/objdump) when on
+PATH, else the host's; --prefix xtensa-esp32s3-elf- picks another.
+"""
+import json
+import os
+import shutil
+import subprocess
+import sys
+from collections import defaultdict
+
+REGIONS = ("flash", "ram", "iram", "rtc")
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+MODULES = {f.split(".")[0] for f in os.listdir(ROOT) if f.endswith((".h", ".cpp", ".ino"))}
+
+
+def region_of(section):
+    """Regions a symbol in `section` occupies."""
+    s = section.lower()
+    if "rtc" in s:
+        return ("rtc",)
+    if "iram" in s:
+        return ("iram", "flash")          # loaded from the image at boot
+    if "bss" in s or "noinit" in s:
+        return ("ram",)
+    if "data" in s and "rodata" not in s:
+        return ("ram", "flash")
+    if "text" in s or "rodata" in s or "literal" in s:
+        return ("flash",)
+    return ()
+
+
+def tool(prefix, name):
+    if prefix:
+        return prefix + name
+    for p in ("xtensa-esp32-elf-", "xtensa-esp32s3-elf-", "riscv32-esp-elf-"):
+        if shutil.which(p + name):
+            return p + name
+    return name
+
+
+def run(cmd):
+    return subprocess.run(cmd, check=True, stdout=subprocess.PIPE,
+                          universal_newlines=True).stdout.splitlines()
+
+
+def sections(prefix, elf):
+    """address -> section, from the symbol table."""
+    out = {}
+    for line in run([tool(prefix, "objdump"), "-t", elf]):
+        # 400d1234 g     F .flash.text	0000002a stepGenInit
+        if "\t" not in line:
+            continue
+        head = line.split("\t", 1)[0].split()
+        try:
+            out[int(head[0], 16)] = head[-1]
+        except (ValueError, IndexError):
+            pass
+    return out
+
+
+def module_of(where):
+    """Module for a "file:line" from nm; the build may run on a copy of the
+    sketch, so files are matched by name (SliderPilot.ino.cpp -> SliderPilot)."""
+    if not where:
+        return "(other)"
+    name = os.path.basename(where.rsplit(":", 1)[0]).split(".")[0]
+    return name if name in MODULES else "(core)"
+
+
+def measure(prefix, elf):
+    """module -> region -> bytes, and module -> [(bytes, symbol)]."""
+    secs = sections(prefix, elf)
+    sizes = defaultdict(lambda: defaultdict(int))
+    syms = defaultdict(list)
+    for line in run([tool(prefix, "nm"), "-S", "-l", "-C", "--defined-only", elf]):
+        # addr size type name[\tfile:line]
+        head, _, where = line.partition("\t")
+        parts = head.split(None, 3)
+        if len(parts) < 4:
+            continue
+        addr, size, name = int(parts[0], 16), int(parts[1], 16), parts[3]
+        sec = secs.get(addr, "")
+        regions = region_of(sec)
+        if not regions or size == 0:
+            continue
+        mod = module_of(where)
+        for r in regions:
+            sizes[mod][r] += size
+        syms[mod].append((size, name))
+    return sizes, syms
+
+
+def fmt(v, budget):
+    d = v - budget
+    return "%8d %+9d" % (v, d) if d else "%8d %9s" % (v, "")
+
+
+def main(argv):
+    args = argv[1:]
+    if not args or args[0].startswith("-"):
+        raise SystemExit(__doc__)
+    elf, update, top = args[0], "--update" in args, 0
+    budget_path = os.path.join(ROOT, "tools", "size_budget.json")
+    prefix = ""
+    for i, a in enumerate(args):
+        if a == "--budget":
+            budget_path = args[i + 1]
+        elif a == "--top":
+            top = int(args[i + 1])
+        elif a == "--prefix":
+            prefix = args[i + 1]
+
+    sizes, syms = measure(prefix, elf)
+    total = defaultdict(int)
+    for regs in sizes.values():
+        for r, v in regs.items():
+            total[r] += v
+
+    if update:
+        budget = {"total": {r: total[r] for r in REGIONS if total[r]},
+                  "modules": {m: {r: regs[r] for r in REGIONS if regs[r]}
+                              for m, regs in sorted(sizes.items())}}
+        with open(budget_path, "w") as f:
+            json.dump(budget, f, indent=1, sort_keys=True)
+            f.write("\n")
+        print("budget written to %s" % budget_path)
+        return 0
+
+    try:
+        with open(budget_path) as f:
+            budget = json.load(f)
+    except FileNotFoundError:
+        budget = None
+        print("no budget at %s; run with --update to create one" % budget_path)
+    mods = budget.get("modules", {}) if budget else {}
+    if budget and budget.get("note"):
+        print("budget note: %s\n" % budget["note"])
+
+    over, grown = [], set()
+    print("%-18s" % "module" + "".join("%18s" % r for r in REGIONS))
+    rows = sorted(sizes.items(), key=lambda kv: -kv[1]["flash"] - kv[1]["ram"])
+    for m, regs in rows + [("TOTAL", total)]:
+        b = (budget.get("total") if m == "TOTAL" else mods.get(m)) if budget else {}
+        line = "%-18s" % m
+        for r in REGIONS:
+            want = regs[r] if b is None or not budget else b.get(r, 0)
+            line += fmt(regs[r], want)
+            if regs[r] > want:
+                over.append("%s %s" % (m, r))
+                grown.add(m)
+        if b is None:
+            over.append("%s (new)" % m)
+            grown.add(m)
+        print(line + ("  new" if b is None else ""))
+    gone = sorted(set(mods) - set(sizes))
+    if gone:
+        print("no longer present: %s" % ", ".join(gone))
+
+    if top:
+        for m in sorted((grown & set(syms)) or syms):
+            print("\n%s" % m)
+            for size, name in sorted(syms[m], reverse=True)[:top]:
+                print("  %8d  %s" % (size, name))
+
+    if budget is None:
+        return 1
+    if over:
+        print("\nover budget: %s" % ", ".join(over))
+        return 1
+    print("\nwithin budget")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,259 @@
+#!/usr/bin/env python3
+"""Host side of the SlidePilot USB serial protocol (see serial_link.h).
+
+    slidectl.py /dev/ttyACM0 ping
+    slidectl.py /dev/ttyACM0 move 250 [pct]
+    slidectl.py /dev/ttyACM0 jog -10
+    slidectl.py /dev/ttyACM0 stop
+    slidectl.py /dev/ttyACM0 job job.json [--dry]   --dry: feasibility report only
+    slidectl.py /dev/ttyACM0 status
+    slidectl.py /dev/ttyACM0 set speed 60 | get speed | save
+    slidectl.py /dev/ttyACM0 watch [periodMs]
+    slidectl.py /dev/ttyACM0 log [rec]      (0 = live ring, k = k-th newest flash dump)
+    slidectl.py /dev/ttyACM0 boot           boot timeline
+    slidectl.py /dev/ttyACM0 crawl <mm/h> [mm]   ultra-slow move, 0 mm/h stops
+    slidectl.py /dev/ttyACM0 take record|stop|status | take play [scale]
+                                            hand-guided take
+    slidectl.py /dev/ttyACM0 resume [go|discard]  job cut off by power loss
+    slidectl.py /dev/ttyACM0 trace          raw input trace as "ms pins" lines
+                                            (firmware built with INPUT_TRACE_LEN > 0)
+
+Linux/macOS only (termios); the port may also be a pseudo-terminal.
+"""
+import os
+import select
+import struct
+import sys
+import termios
+import time
+
+PING, MOVE, JOG, STOP, TAKE, CRAWL, RESUME = 0x01, 0x10, 0x11, 0x12, 0x14, 0x15, 0x16
+JOB, STATUS = 0x20, 0x21
+SET, GET, SAVE, SUB = 0x30, 0x31, 0x32, 0x40
+LOG, BOOT, INPUT = 0x50, 0x51, 0x52
+REPLY, TELEMETRY = 0x80, 0xC0
+
+KEYS = {"speed": 1, "pause": 2, "settle": 3, "settlecounts": 4,
+        "current": 5, "microstep": 6, "accel": 7, "payload": 8}
+STATUS_TEXT = ["ok", "busy", "bad request", "out of range"]
+STATES = ["idle", "running", "done", "stopped"]
+EVENTS = [None, "boot", "job", "plan-start", "plan-end", "plan-stop", "seg", "jog",
+          "move", "enc", "input", "settle", "reboot", "wifi", "drive", "take", "crawl",
+          "resume"]
+TAKE_CMDS = {"stop": 0, "record": 1, "play": 2, "status": 0xFF}
+TAKE_STATES = ["idle", "recording", "seeking", "playing"]
+RESUME_CMDS = {"discard": 0, "go": 1, "status": 0xFF}
+RESUME_STATES = ["none", "offered", "returning"]
+CHECK_FLAGS = ["invalid", "too-fast", "too-long", "range", "rate", "accel", "interval", "busy"]
+
+
+def crc16(data):
+    c = 0xFFFF
+    for b in data:
+        c ^= b << 8
+        for _ in range(8):
+            c = ((c << 1) ^ 0x1021) if c & 0x8000 else (c << 1)
+            c &= 0xFFFF
+    return c
+
+
+def cobs_encode(data):
+    out = bytearray([0])
+    code_at, code = 0, 1
+    for b in data:
+        if b == 0:
+            out[code_at] = code
+            code_at, code = len(out), 1
+            out.append(0)
+            continue
+        out.append(b)
+        code += 1
+        if code == 0xFF:
+            out[code_at] = code
+            code_at, code = len(out), 1
+            out.append(0)
+    out[code_at] = code
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        i += 1
+        if code == 0 or i + code - 1 > len(data):
+            raise ValueError("bad COBS")
+        out += data[i:i + code - 1]
+        i += code - 1
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+class Link:
+    def __init__(self, path):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        attrs = termios.tcgetattr(self.fd)
+        attrs[0] = attrs[1] = attrs[3] = 0            # raw in/out, no echo
+        attrs[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+        termios.tcsetattr(self.fd, termios.TCSANOW, attrs)
+        self.buf = bytearray()
+        self.seq = 0
+
+    def send(self, op, payload=b""):
+        self.seq = (self.seq + 1) & 0xFF
+        body = bytes([op, self.seq]) + payload
+        os.write(self.fd, cobs_encode(body + struct.pack("<H", crc16(body))) + b"\0")
+        return self.seq
+
+    def frame(self, timeout):
+        """Next valid frame as (type, seq, payload), or None on timeout."""
+        end = time.time() + timeout
+        while True:
+            if 0 in self.buf:
+                raw, _, rest = self.buf.partition(b"\0")
+                self.buf = bytearray(rest)
+                try:
+                    f = cobs_decode(bytes(raw))
+                except ValueError:
+                    continue
+                if len(f) >= 4 and crc16(f[:-2]) == struct.unpack("<H", f[-2:])[0]:
+                    return f[0], f[1], f[2:-2]
+                continue
+            left = end - time.time()
+            if left <= 0:
+                return None
+            r, _, _ = select.select([self.fd], [], [], left)
+            if r:
+                self.buf += os.read(self.fd, 4096)
+
+    def call(self, op, payload=b"", timeout=2.0):
+        seq = self.send(op, payload)
+        end = time.time() + timeout
+        while time.time() < end:
+            f = self.frame(end - time.time())
+            if f and f[0] == (op | REPLY) and f[1] == seq:
+                return f[2]
+        raise TimeoutError("no reply to 0x%02x" % op)
+
+
+def check(reply):
+    if reply[0] != 0:
+        text = reply[1:].decode(errors="replace") or STATUS_TEXT[reply[0]]
+        raise SystemExit("error: " + text)
+    return reply[1:]
+
+
+def telemetry(p):
+    state, seg, loop, steps, total, um = struct.unpack_from("<BHHIIi", p)
+    heads = struct.unpack_from("<%di" % ((len(p) - 17) // 4), p, 17)
+    s = "%-8s seg %3d loop %3d  %6d/%-6d  %8.3f mm" % (
+        STATES[state] if state < len(STATES) else state, seg, loop, steps, total, um / 1000.0)
+    for name, v in zip(("pan", "tilt"), heads):
+        s += "  %s %.2f" % (name, v / 100.0)
+    return s
+
+
+def main(argv):
+    if len(argv) < 3:
+        raise SystemExit(__doc__)
+    link, cmd, args = Link(argv[1]), argv[2], argv[3:]
+
+    if cmd == "ping":
+        ver, axes, bad = struct.unpack("<BBH", check(link.call(PING)))
+        print("protocol %d, %d axes, %d bad frames" % (ver, axes, bad))
+    elif cmd == "move":
+        pct = int(args[1]) if len(args) > 1 else 0
+        check(link.call(MOVE, struct.pack("<fB", float(args[0]), pct)))
+    elif cmd == "jog":
+        check(link.call(JOG, struct.pack("<f", float(args[0]))))
+    elif cmd == "stop":
+        check(link.call(STOP))
+    elif cmd == "job":
+        with open(args[0], "rb") as f:
+            body = f.read()
+        dry = 1 if "--dry" in args else 0
+        reply = check(link.call(JOB, bytes([dry]) + body))
+        segs, steps, eta = struct.unpack_from("<HII", reply)
+        print("%d segments, %d steps, eta %.1f s" % (segs, steps, eta / 1000.0))
+        if dry:
+            flags, rate, accel, leg, leg_ms, leg_min = struct.unpack_from("<HBBHII", reply, 10)
+            print("peak rate %d%%, peak accel %d%% of the rig's limits" % (rate, accel))
+            bad = [n for i, n in enumerate(CHECK_FLAGS) if flags & (1 << i)]
+            if leg:
+                print("leg %d asks for %.1f s, the rig needs %.1f s" % (leg, leg_ms / 1000.0, leg_min / 1000.0))
+            print("ok" if not bad else "violations: %s (%s)" % (
+                ", ".join(bad), reply[24:].decode(errors="replace")))
+    elif cmd == "status":
+        print(telemetry(check(link.call(STATUS))))
+    elif cmd == "set":
+        check(link.call(SET, struct.pack("<Bi", KEYS[args[0]], int(args[1]))))
+    elif cmd == "get":
+        print(struct.unpack("<i", check(link.call(GET, bytes([KEYS[args[0]]]))))[0])
+    elif cmd == "save":
+        check(link.call(SAVE))
+    elif cmd == "watch":
+        period = int(args[0]) if args else 200
+        check(link.call(SUB, struct.pack("<H", period)))
+        try:
+            while True:
+                f = link.frame(5.0)
+                if f and f[0] == TELEMETRY:
+                    print(telemetry(f[2]), flush=True)
+        except KeyboardInterrupt:
+            link.call(SUB, struct.pack("<H", 0))
+    elif cmd == "log":
+        rec, frm = int(args[0]) if args else 0, 0
+        while True:
+            p = check(link.call(LOG, struct.pack("<BH", rec, frm)))
+            reset, boots, count, frm, n = struct.unpack_from("<BIHHB", p)
+            if frm == 0:
+                print("record %d: %d events, boot %d, reset reason %d" % (rec, count, boots, reset))
+            for i in range(n):
+                us, typ, a8, a16, val = struct.unpack_from("<IBBHi", p, 10 + 12 * i)
+                name = EVENTS[typ] if typ < len(EVENTS) else typ
+                print("%12.3f ms  %-10s %3d %5d %d" % (us / 1000.0, name, a8, a16, val))
+            frm += n
+            if n == 0 or frm >= count:
+                break
+    elif cmd == "boot":
+        p = check(link.call(BOOT))
+        menu, motion, n = struct.unpack_from("<IIB", p)
+        print("menu %.1f ms, motion ready %.1f ms" % (menu / 1000.0, motion / 1000.0))
+        off = 9
+        for _ in range(n):
+            us, ln = struct.unpack_from("<IB", p, off)
+            name = p[off + 5:off + 5 + ln].decode(errors="replace")
+            print("%10.1f ms  %s" % (us / 1000.0, name))
+            off += 5 + ln
+    elif cmd == "crawl":
+        mm = float(args[1]) if len(args) > 1 else 0.0
+        check(link.call(CRAWL, struct.pack("<ff", float(args[0]), mm)))
+    elif cmd == "take":
+        scale = float(args[1]) if len(args) > 1 else 1.0
+        p = check(link.call(TAKE, struct.pack("<Bf", TAKE_CMDS[args[0]], scale)))
+        state, ms, size, prog = struct.unpack("<BIIH", p)
+        print("%s, %.1f s in %d bytes, %.0f%% played" % (TAKE_STATES[state], ms / 1000.0, size, prog / 10.0))
+    elif cmd == "resume":
+        c = RESUME_CMDS[args[0]] if args else 0xFF
+        p = check(link.call(RESUME, struct.pack("<B", c)))
+        state, prog, secs = struct.unpack("<BHI", p)
+        print("%s, %.0f%% done after %d s" % (RESUME_STATES[state], prog / 10.0, secs))
+    elif cmd == "trace":
+        frm = 0
+        while True:
+            p = check(link.call(INPUT, struct.pack("<H", frm)))
+            count, frm, n = struct.unpack_from("<HHB", p)
+            for i in range(n):
+                ms, pins = struct.unpack_from("<IB", p, 5 + 5 * i)
+                print("%d %d" % (ms, pins))
+            frm += n
+            if n == 0 or frm >= count:
+                break
+    else:
+        raise SystemExit(__doc__)
+
+
+if __name__ == "__main__":
+    main(sys.argv)
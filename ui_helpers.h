@@ -6,6 +6,7 @@
 // fonts (built-in, simple & consistent)
 inline void fontBody()  { tft.setTextFont(2); }
 inline void fontLabel() { tft.setTextFont(2); }
+inline void fontTitle() { tft.setTextFont(4); }
 
 // cheap text metrics (avoid getTextBounds due to builds)
 inline int textWidth(const char* s){ return (int)strlen(s) * 12; }
@@ -20,22 +21,46 @@ inline void uiBegin(){
 
 // optional no-op dimmer
 inline void idleDimmerTick(){}
+inline void noteUserActivity(){}
+
+// 3-row list layout (menus, list screens), centred vertically
+static const int LIST_ROWS = 3;
+inline int listRowTop(int i){
+  const int totalVisH = LIST_ROWS*UI::ITEM_H + (LIST_ROWS-1)*UI::GAP;
+  return tft.height()/2 - totalVisH/2 + i*(UI::ITEM_H + UI::GAP);
+}
 
 // Slim right scrollbar, sized for a 3-row list area
+inline int slimRailX(){ return tft.width() - UI::RIGHT_COL_W/2 - 4; } // centered in right column
+inline int slimRailH(){ return tft.height() - 2*UI::PAD; }
+inline int slimThumbH(int totalItems, int visibleRows){
+  return max(22, (slimRailH() * visibleRows) / max(visibleRows, totalItems));
+}
+inline int slimThumbY(int totalItems, int firstVisible, int visibleRows){
+  int maxFirst = max(0, totalItems - visibleRows);
+  int travel = slimRailH() - slimThumbH(totalItems, visibleRows);
+  return UI::PAD + ((maxFirst==0)?0 : travel * clampT(firstVisible,0,maxFirst) / maxFirst);
+}
+
 inline void drawSlimScroll(int totalItems, int firstVisible, int visibleRows){
-  int railX = tft.width() - UI::RIGHT_COL_W/2 - 4; // centered in right column
-  int railH = tft.height() - 2*UI::PAD;
-  int railY = UI::PAD;
+  int railX = slimRailX();
 
   // rail
-  tft.fillRoundRect(railX-4, railY, 8, railH, 4, Theme::ELEV_2);
+  tft.fillRoundRect(railX-4, UI::PAD, 8, slimRailH(), 4, Theme::ELEV_2);
 
-  // compute thumb
-  int thumbH = max(22, (railH * visibleRows) / max(visibleRows, totalItems));
-  int maxFirst = max(0, totalItems - visibleRows);
-  int thumbY = railY + ((maxFirst==0)?0 : (railH - thumbH) * clampT(firstVisible,0,maxFirst) / max(1,maxFirst));
+  // thumb
+  tft.fillRoundRect(railX-4, slimThumbY(totalItems, firstVisible, visibleRows),
+                    8, slimThumbH(totalItems, visibleRows), 4, Theme::ACCENT);
+}
 
-  tft.fillRoundRect(railX-4, thumbY, 8, thumbH, 4, Theme::ACCENT);
+// Move the thumb only; the rail shows through where it was
+inline void moveSlimThumb(int totalItems, int fromFirst, int toFirst, int visibleRows){
+  int y0 = slimThumbY(totalItems, fromFirst, visibleRows);
+  int y1 = slimThumbY(totalItems, toFirst, visibleRows);
+  if (y0 == y1) return;
+  int railX = slimRailX(), h = slimThumbH(totalItems, visibleRows);
+  tft.fillRoundRect(railX-4, y0, 8, h, 4, Theme::ELEV_2);
+  tft.fillRoundRect(railX-4, y1, 8, h, 4, Theme::ACCENT);
 }
 
 // pill list item respecting right rail
@@ -64,6 +89,26 @@ inline void drawListItemRailAware(int yTop, const char* label, bool selected){
   drawPillTextCentered(yTop, label, selected);
 }
 
+// pill with the label left and a value right; editing inverts it
+inline void drawPillLabelValue(int yTop, const char* label, const char* value, bool selected, bool editing){
+  int left = UI::PAD;
+  int right = tft.width() - UI::RIGHT_COL_W - UI::PAD;
+  int h = UI::ITEM_H;
+
+  uint16_t bg = editing ? Theme::TEXT : selected ? Theme::ACCENT : Theme::ELEV_1;
+  uint16_t fg = (editing || selected) ? Theme::BG : Theme::TEXT;
+
+  tft.fillRoundRect(left, yTop, right - left, h, h/2, bg);
+
+  fontBody();
+  tft.setTextColor(fg, bg);
+  int cy = yTop + (h - fontHeight())/2 + 2;
+  tft.setCursor(left + h/2, cy);
+  tft.print(label);
+  tft.setCursor(right - h/2 - textWidth(value), cy);
+  tft.print(value);
+}
+
 // centered progress (nice bar)
 inline void drawCenteredProgress(int pct){
   int left = UI::PAD;
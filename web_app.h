@@ -65,7 +65,10 @@ h1{margin:6px 0 12px;font-size:18px}
 const knob = document.getElementById('knob');
 const track = document.getElementById('track');
 const spd   = document.getElementById('spd');
+// Control routes are served by the fixed-buffer router on port 81
+const API = location.protocol + '//' + location.hostname + ':81';
 let dragging=false, startX=0, startY=0, baseX=0, baseSpeed=40, speed=40;
+let driveDir=0, driveP=0, driveSent=0, keepAlive=null;
 
 function layoutKnob(x){
   const rect = track.getBoundingClientRect();
@@ -104,13 +107,22 @@ knob.addEventListener('pointermove',(e)=>{
   // send drive command (debounced)
   drive(dir, speed);
 });
-knob.addEventListener('pointerup',()=>{ dragging=false; });
+// release springs back to centre and stops; the slide also ramps down by
+// itself if drive updates stop arriving (lost connection)
+function release(){ if (!dragging) return; dragging=false; clearInterval(keepAlive); keepAlive=null; driveDir=0; center(); }
+knob.addEventListener('pointerup',release);
+knob.addEventListener('pointercancel',release);
 
 function drive(dir, p){
-  // dir: 1 right, -1 left; p: 5..100
-  fetch('/api/drive?dir='+(dir>0?1:-1)+'&p='+p).catch(()=>{});
+  // dir: 1 right, -1 left; p: 5..100. Sent when it changes, and repeated
+  // every 150 ms while held so the drive doesn't time out.
+  const now=Date.now();
+  if (dir===driveDir && p===driveP && now-driveSent<50) return;
+  driveDir=dir; driveP=p; driveSent=now;
+  fetch(API+'/api/drive?dir='+(dir>0?1:-1)+'&p='+p).catch(()=>{});
+  if (!keepAlive) keepAlive=setInterval(()=>{ if (dragging && driveDir) drive(driveDir, speed); }, 150);
 }
-function go(path){ fetch(path).catch(()=>{}); }
+function go(path){ fetch(API+path).catch(()=>{}); }
 
 window.addEventListener('resize', ()=>center());
 document.addEventListener('DOMContentLoaded', ()=>center());
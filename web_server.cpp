@@ -0,0 +1,12 @@
+// Web servers and the control API buffers.
+#include "web_server.h"
+
+WebServer server(80);
+WiFiServer controlServer(CONTROL_PORT);
+WiFiClient   g_ctlClient;
+size_t       g_ctlLen = 0;
+uint32_t     g_ctlSince = 0;
+char         g_ctlRx[CONTROL_RX_MAX];
+char         g_ctlHead[192];
+HttpResponse g_ctlResp;
+MemStatic    g_ctlMem("control", sizeof(g_ctlRx) + sizeof(g_ctlHead) + sizeof(g_ctlResp));
@@ -9,34 +9,253 @@
 #include "motor_control.h"
 #include "eeprom_utils.h"
 #include "ui_helpers.h"
+#include "http_router.h"
+#include "job.h"
+#include "control.h"
+#include "flight_log.h"
+#include "wifi_link.h"
+#include "boot.h"
 
-WebServer server(80);
+extern WebServer server;
 
 inline void handleRoot(){ noteUserActivity(); server.send_P(200,"text/html", WEB_INDEX); }
 inline void handleNotFound(){ server.send(404,"text/plain","404"); }
 
+// ---------- Control API (fixed-buffer router on its own port) ----------
+// WebServer parses every argument into a heap String, so the high-rate
+// control routes live on a raw listener that reads into a static buffer and
+// answers from a preallocated response. Port 80 keeps the page and OTA.
+#ifndef CONTROL_PORT
+  #define CONTROL_PORT 81
+#endif
+#ifndef CONTROL_RX_MAX
+  #define CONTROL_RX_MAX 1024
+#endif
+#ifndef CONTROL_RX_TIMEOUT_MS
+  #define CONTROL_RX_TIMEOUT_MS 250    // a client gets this long to send its request
+#endif
+
+extern WiFiServer controlServer;
+extern WiFiClient   g_ctlClient;       // request being read, across loop() passes
+extern size_t       g_ctlLen;
+extern uint32_t     g_ctlSince;
+extern char         g_ctlRx[CONTROL_RX_MAX];
+extern char         g_ctlHead[192];
+extern HttpResponse g_ctlResp;
+
 // /api/drive?dir=±1&p=5..100
-inline void apiDrive() {
+inline void apiDrive(const HttpRequest& req, HttpResponse& resp) {
   noteUserActivity();
-  int dir = server.hasArg("dir") ? server.arg("dir").toInt() : 0;
-  int p   = server.hasArg("p")   ? server.arg("p").toInt()   : 40;
-  manualDrive(dir, (uint8_t)clampT(p,5,100));
-  server.send(200,"text/plain","OK");
+  int dir = (int)req.argInt("dir", 0);
+  int p   = (int)req.argInt("p", 40);
+  CtlStatus st = ctlDrive(dir, p);
+  if (st != CTL_OK) { resp.text(409, ctlStatusText(st)); return; }
+  resp.add("OK");
 }
 
 // /api/jog?mm=±value
-inline void apiJog() {
-  noteUserActivity();
-  float mm = server.hasArg("mm") ? server.arg("mm").toFloat() : 0.0f;
-  if (mm != 0.0f) moveDeltaMM(mm, g_speedPercent);
-  server.send(200,"text/plain","OK");
+inline void apiJog(const HttpRequest& req, HttpResponse& resp) {
+  CtlStatus st = ctlJog(req.argFloat("mm", 0.0f));
+  if (st != CTL_OK) { resp.text(409, ctlStatusText(st)); return; }
+  resp.add("OK");
 }
 
 // /api/stop
-inline void apiStop(){ noteUserActivity(); plan.active=false; server.send(200,"text/plain","OK"); }
+inline void apiStop(const HttpRequest&, HttpResponse& resp){ ctlStop(); resp.add("OK"); }
 
 // /api/setSpeed?p=%
-inline void apiSetSpeed(){ noteUserActivity(); int p=server.hasArg("p")?server.arg("p").toInt():40; setSpeedPercent(p); server.send(200,"text/plain","OK"); }
+inline void apiSetSpeed(const HttpRequest& req, HttpResponse& resp){ ctlSetSpeed((int)req.argInt("p", 40)); resp.add("OK"); }
+
+// POST /api/job   body = job JSON or binary; ?dry=1 checks only and returns
+// the feasibility report (job_check.h)
+inline void apiJobPost(const HttpRequest& req, HttpResponse& resp) {
+  if (req.argInt("dry", 0) != 0) {
+    JobCheck c;
+    CtlStatus st = ctlJobCheck(req.body, c);
+    jobCheckJson(c, resp);
+    if (st != CTL_OK) resp.status = (st == CTL_BUSY) ? 409 : 400;
+    return;
+  }
+  const char* err = nullptr;
+  resp.type = "application/json";
+  CtlStatus st = ctlJobSubmit(req.body, false, err);
+  if (st != CTL_OK) {
+    resp.status = (st == CTL_BUSY) ? 409 : 400;
+    resp.add("{\"ok\":false,\"error\":\"").add(err).add("\"}");
+    return;
+  }
+  resp.add("{\"ok\":true,\"segments\":").add((long)plan.count)
+      .add(",\"steps\":").add((long)plan.totalSteps)
+      .add(",\"etaMs\":").add((long)plan.totalMs).add("}");
+}
+
+// GET /api/job → progress
+inline void apiJobGet(const HttpRequest&, HttpResponse& resp) { jobStatusJson(resp); }
+
+// GET /api/log?rec=0&from=0 → flight recorder page
+inline void apiLog(const HttpRequest& req, HttpResponse& resp) {
+  flightLogJson((uint8_t)req.argInt("rec", 0), (uint16_t)req.argInt("from", 0), resp);
+}
+
+// GET /api/boot → boot timeline
+inline void apiBoot(const HttpRequest&, HttpResponse& resp) { bootTimelineJson(resp); }
+
+// GET /api/crawl → crawl state
+inline void apiCrawlGet(const HttpRequest&, HttpResponse& resp) { crawlStatusJson(resp); }
+
+// POST /api/crawl?mmh=±rate&mm=distance (mmh=0 stops, mm=0 runs to the end)
+inline void apiCrawlPost(const HttpRequest& req, HttpResponse& resp) {
+  CtlStatus st = ctlCrawl(req.argFloat("mmh", 0.0f), req.argFloat("mm", 0.0f));
+  if (st != CTL_OK) { resp.text(st == CTL_BUSY ? 409 : 400, ctlStatusText(st)); return; }
+  crawlStatusJson(resp);
+}
+
+// GET /api/resume → interrupted job on offer, if any
+inline void apiResumeGet(const HttpRequest&, HttpResponse& resp) { resumeStatusJson(resp); }
+
+// POST /api/resume?cmd=resume|discard
+inline void apiResumePost(const HttpRequest& req, HttpResponse& resp) {
+  StrView cmd;
+  req.arg("cmd", cmd);
+  if (!cmd.eq("resume") && !cmd.eq("discard")) { resp.text(400, "bad cmd"); return; }
+  CtlStatus st = ctlResume(cmd.eq("resume"));
+  if (st != CTL_OK) { resp.text(st == CTL_BUSY ? 409 : 400, ctlStatusText(st)); return; }
+  resumeStatusJson(resp);
+}
+
+// GET /api/mem → heap and allocator high-water marks
+inline void apiMem(const HttpRequest&, HttpResponse& resp) { memStatusJson(resp); }
+
+// GET /api/take → take state
+inline void apiTakeGet(const HttpRequest&, HttpResponse& resp) { takeStatusJson(resp); }
+
+// POST /api/take?cmd=record|stop|play&scale=1
+inline void apiTakePost(const HttpRequest& req, HttpResponse& resp) {
+  StrView cmd;
+  req.arg("cmd", cmd);
+  uint8_t c;
+  if (cmd.eq("record"))    c = CTL_TAKE_RECORD;
+  else if (cmd.eq("play")) c = CTL_TAKE_PLAY;
+  else if (cmd.eq("stop")) c = CTL_TAKE_STOP;
+  else { resp.text(400, "bad cmd"); return; }
+  CtlStatus st = ctlTake(c, req.argFloat("scale", 1.0f));
+  if (st != CTL_OK) { resp.text(st == CTL_BUSY ? 409 : 400, ctlStatusText(st)); return; }
+  takeStatusJson(resp);
+}
+
+// GET /api/wifi → link state
+inline void apiWifiGet(const HttpRequest&, HttpResponse& resp) {
+  const IPAddress ip = wifiIP();
+  char ipText[16];
+  snprintf(ipText, sizeof(ipText), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+  resp.type = "application/json";
+  resp.add("{\"mode\":").add((long)runtimeState.wifiMode)
+      .add(",\"state\":\"").add(wifiStateName(g_wlState))
+      .add("\",\"ssid\":\"").add(runtimeState.sta_ssid)
+      .add("\",\"ip\":\"").add(ipText)
+      .add("\",\"rssi\":").add((long)(g_wlState == WLS_UP ? WiFi.RSSI() : 0))
+      .add(",\"joinMs\":").add((long)g_wlJoinMs)
+      .add(",\"cached\":").add(g_wlFast ? "true" : "false")
+      .add(",\"apFallback\":").add(g_wlApOpen ? "true" : "false").add("}");
+}
+
+// Copy a string argument into a fixed field; false if too long, or if it
+// holds anything apiWifiGet could not put in its JSON as is (escapes,
+// quotes, control characters).
+inline bool wifiArgCopy(const HttpRequest& req, const char* key, char* dst, size_t cap) {
+  StrView v;
+  if (!req.arg(key, v)) return true;
+  if (v.n >= cap) return false;
+  for (size_t i = 0; i < v.n; ++i)
+    if (v.p[i] == '\\' || v.p[i] == '"' || (uint8_t)v.p[i] < 0x20) return false;
+  memcpy(dst, v.p, v.n); dst[v.n] = 0;
+  return true;
+}
+
+// POST /api/wifi {"mode":1,"ssid":"..","pass":"..","apSsid":"..","apPass":".."}
+// Saves and reconnects shortly after replying.
+inline void apiWifiPost(const HttpRequest& req, HttpResponse& resp) {
+  noteUserActivity();
+  long mode = req.argInt("mode", runtimeState.wifiMode);
+  if (mode < WLM_AP || mode > WLM_STA_AP) { resp.text(400, "bad mode"); return; }
+  RuntimeState s = runtimeState;
+  if (!wifiArgCopy(req, "ssid", s.sta_ssid, sizeof(s.sta_ssid)) ||
+      !wifiArgCopy(req, "pass", s.sta_pass, sizeof(s.sta_pass)) ||
+      !wifiArgCopy(req, "apSsid", s.ap_ssid, sizeof(s.ap_ssid)) ||
+      !wifiArgCopy(req, "apPass", s.ap_pass, sizeof(s.ap_pass))) { resp.text(400, "bad string"); return; }
+  if (s.ap_pass[0] && strlen(s.ap_pass) < 8) { resp.text(400, "AP password needs 8+ chars"); return; }
+  if (mode != WLM_AP && !s.sta_ssid[0]) { resp.text(400, "ssid required"); return; }
+
+  const bool creds = strcmp(s.sta_ssid, runtimeState.sta_ssid) || strcmp(s.sta_pass, runtimeState.sta_pass);
+  memcpy(runtimeState.ap_ssid, s.ap_ssid, sizeof(s.ap_ssid));
+  memcpy(runtimeState.ap_pass, s.ap_pass, sizeof(s.ap_pass));
+  memcpy(runtimeState.sta_ssid, s.sta_ssid, sizeof(s.sta_ssid));
+  memcpy(runtimeState.sta_pass, s.sta_pass, sizeof(s.sta_pass));
+  runtimeState.wifiMode = (uint8_t)mode;
+  if (creds) runtimeState.staCache = WifiCache();
+  eepromSaveRuntime();
+  wifiRestartSoon();
+  resp.add("OK");
+}
+
+static const HttpRoute CONTROL_ROUTES[] = {
+  { HM_GET,  "/api/drive",    apiDrive    },
+  { HM_POST, "/api/drive",    apiDrive    },
+  { HM_GET,  "/api/jog",      apiJog      },
+  { HM_POST, "/api/jog",      apiJog      },
+  { HM_GET,  "/api/stop",     apiStop     },
+  { HM_POST, "/api/stop",     apiStop     },
+  { HM_GET,  "/api/setSpeed", apiSetSpeed },
+  { HM_POST, "/api/setSpeed", apiSetSpeed },
+  { HM_POST, "/api/job",      apiJobPost  },
+  { HM_GET,  "/api/job",      apiJobGet   },
+  { HM_GET,  "/api/log",      apiLog      },
+  { HM_GET,  "/api/boot",     apiBoot     },
+  { HM_GET,  "/api/wifi",     apiWifiGet  },
+  { HM_POST, "/api/wifi",     apiWifiPost },
+  { HM_GET,  "/api/crawl",    apiCrawlGet },
+  { HM_POST, "/api/crawl",    apiCrawlPost },
+  { HM_GET,  "/api/take",     apiTakeGet  },
+  { HM_POST, "/api/take",     apiTakePost },
+  { HM_GET,  "/api/mem",      apiMem      },
+  { HM_GET,  "/api/resume",   apiResumeGet },
+  { HM_POST, "/api/resume",   apiResumePost },
+};
+static const size_t CONTROL_ROUTE_COUNT = sizeof(CONTROL_ROUTES)/sizeof(CONTROL_ROUTES[0]);
+
+// Takes whatever has arrived on each loop() pass and never waits, so an idle
+// or slow connection costs one poll per pass, not a stalled loop. The reply
+// goes out once the request is complete, the buffer is full or the client
+// has had CONTROL_RX_TIMEOUT_MS.
+inline void controlServerLoop() {
+  WiFiClient& c = g_ctlClient;
+  if (!c) {
+    c = controlServer.available();
+    if (!c) return;
+    g_ctlLen = 0;
+    g_ctlSince = millis();
+  }
+
+  HttpRequest req;
+  HttpParse st = HP_INCOMPLETE;
+  const int avail = c.available();
+  if (avail > 0 && g_ctlLen < sizeof(g_ctlRx)) {
+    const int n = c.read((uint8_t*)g_ctlRx + g_ctlLen, min((size_t)avail, sizeof(g_ctlRx) - g_ctlLen));
+    if (n > 0) g_ctlLen += n;
+    st = httpParseRequest(g_ctlRx, g_ctlLen, req);
+  }
+  if (st == HP_INCOMPLETE && g_ctlLen < sizeof(g_ctlRx) && c.connected()
+      && (millis() - g_ctlSince) < CONTROL_RX_TIMEOUT_MS) return;   // more to come
+
+  if (st == HP_OK) httpDispatch(CONTROL_ROUTES, CONTROL_ROUTE_COUNT, req, g_ctlResp);
+  else if (g_ctlLen >= sizeof(g_ctlRx)) g_ctlResp.text(413, "413");
+  else g_ctlResp.text(400, "400");
+
+  size_t h = httpFormatHead(g_ctlResp, g_ctlHead, sizeof(g_ctlHead));
+  c.write((const uint8_t*)g_ctlHead, h);
+  if (g_ctlResp.len) c.write((const uint8_t*)g_ctlResp.body, g_ctlResp.len);
+  c.stop();
+}
 
 // OTA page
 static const char OTA_INDEX[] PROGMEM = R"OTA(
@@ -61,31 +280,32 @@ inline void handleUpdate(){
   } else if(up.status == UPLOAD_FILE_WRITE){
     Update.write(up.buf, up.currentSize);
   } else if(up.status == UPLOAD_FILE_END){
-    if(Update.end(true)){ server.send(200,"text/plain","OK, rebooting"); delay(300); ESP.restart(); return; }
+    if(Update.end(true)){
+      server.send(200,"text/plain","OK, rebooting"); delay(300);
+      flightRecorderReboot(FRR_OTA);
+      ESP.restart(); return;
+    }
   }
   server.send(200,"text/plain","OK");
 }
 
-inline void startWebServerAP() {
-  if (strlen(runtimeState.ap_ssid)==0) strncpy(runtimeState.ap_ssid, "SlidePilot", sizeof(runtimeState.ap_ssid));
-  if (strlen(runtimeState.ap_pass)==0) strncpy(runtimeState.ap_pass, "slidepilot", sizeof(runtimeState.ap_pass));
-
-  WiFi.mode(WIFI_AP);
-  WiFi.softAP(runtimeState.ap_ssid, runtimeState.ap_pass);
-  IPAddress ip = WiFi.softAPIP();
-  Serial.print("AP IP: "); Serial.println(ip);
+// Brings up Wi-Fi per runtimeState.wifiMode (wifi_link.h), then the servers.
+// Listening sockets don't need the link to be up yet.
+inline void startWebServer() {
+  wifiBegin();
 
   server.on("/", handleRoot);
-  server.on("/api/drive", apiDrive);
-  server.on("/api/jog",   apiJog);
-  server.on("/api/stop",  apiStop);
-  server.on("/api/setSpeed", apiSetSpeed);
   server.on("/ota", handleOTA);
   server.on("/update", HTTP_POST, [](){ server.send(200,"text/plain","OK"); }, handleUpdate);
   server.onNotFound(handleNotFound);
   server.begin();
+  controlServer.begin();
+  controlServer.setNoDelay(true);
 }
 
-inline void webServerLoop(){ server.handleClient(); }
+// Older name from when only the soft AP existed.
+inline void startWebServerAP() { startWebServer(); }
+
+inline void webServerLoop(){ wifiLoop(); server.handleClient(); controlServerLoop(); }
 
 #endif
@@ -0,0 +1,11 @@
+// Wi-Fi join state; the cache survives a reset in RTC RAM.
+#include "wifi_link.h"
+
+RTC_NOINIT_ATTR uint32_t  g_wifiRtcMagic;
+RTC_NOINIT_ATTR WifiCache g_wifiRtc;
+WifiLinkState g_wlState    = WLS_OFF;
+uint32_t      g_wlSince    = 0;
+uint32_t      g_wlJoinMs   = 0;
+bool          g_wlFast     = false;
+bool          g_wlApOpen   = false;
+uint32_t      g_wlRestartAt = 0;
@@ -0,0 +1,197 @@
+#ifndef WIFI_LINK_H
+#define WIFI_LINK_H
+
+// Wi-Fi bring-up: soft AP, station, or station with an AP fallback.
+// A station join normally costs a full channel scan plus a DHCP exchange,
+// several seconds in all. After the first good join the BSSID, channel and
+// lease are kept in RTC memory (survives resets and deep sleep) and in the
+// settings store (survives power-off); the next join goes straight to that
+// AP on that channel and reuses the lease as a static config, which brings
+// the controller up in a few hundred ms. If the fast join fails the cache
+// is dropped and a normal scan + DHCP join follows.
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "config.h"
+#include "eeprom_utils.h"
+#include "flight_recorder.h"
+
+#ifndef WIFI_FAST_TIMEOUT_MS
+  #define WIFI_FAST_TIMEOUT_MS 1500     // cached join must finish within this
+#endif
+#ifndef WIFI_STA_GIVEUP_MS
+  #define WIFI_STA_GIVEUP_MS 15000      // then mode 2 also opens the soft AP
+#endif
+
+enum WifiLinkMode : uint8_t { WLM_AP = 0, WLM_STA = 1, WLM_STA_AP = 2 };
+enum WifiLinkState : uint8_t {
+  WLS_OFF = 0,
+  WLS_AP,          // soft AP only
+  WLS_FAST,        // joining from the cache
+  WLS_JOIN,        // scan + DHCP join
+  WLS_UP,          // station connected
+};
+
+static const uint32_t WIFI_RTC_MAGIC = 0x49465753; // 'SWFI'
+
+extern uint32_t  g_wifiRtcMagic;
+extern WifiCache g_wifiRtc;
+
+extern WifiLinkState g_wlState;
+extern uint32_t      g_wlSince;       // millis() at the start of this join
+extern uint32_t      g_wlJoinMs;      // how long the last join took
+extern bool          g_wlFast;        // last join used the cache
+extern bool          g_wlApOpen;      // fallback AP is up next to the station
+extern uint32_t      g_wlRestartAt;   // deferred wifiBegin() after a settings change
+
+inline const char* wifiStateName(WifiLinkState s) {
+  switch (s) {
+    case WLS_AP:   return "ap";
+    case WLS_FAST: return "fast";
+    case WLS_JOIN: return "join";
+    case WLS_UP:   return "up";
+    default:       return "off";
+  }
+}
+
+// FNV-1a over ssid and password; ties a cache entry to its credentials.
+inline uint32_t wifiCredHash(const char* ssid, const char* pass) {
+  uint32_t h = 2166136261u;
+  for (const char* s = ssid; *s; ++s) { h ^= (uint8_t)*s; h *= 16777619u; }
+  h ^= 0xFF; h *= 16777619u;
+  for (const char* s = pass; *s; ++s) { h ^= (uint8_t)*s; h *= 16777619u; }
+  return h ? h : 1;
+}
+
+inline bool wifiCacheUsable(const WifiCache& c, uint32_t hash) {
+  return c.credHash == hash && c.channel >= 1 && c.channel <= 14 && c.ip != 0 && c.netmask != 0;
+}
+
+// RTC copy first (newest, costs no flash), then the settings store.
+inline const WifiCache* wifiCachedLink() {
+  const uint32_t hash = wifiCredHash(runtimeState.sta_ssid, runtimeState.sta_pass);
+  if (g_wifiRtcMagic == WIFI_RTC_MAGIC && wifiCacheUsable(g_wifiRtc, hash)) return &g_wifiRtc;
+  if (wifiCacheUsable(runtimeState.staCache, hash)) return &runtimeState.staCache;
+  return nullptr;
+}
+
+// Forget the cache (failed fast join, new credentials).
+inline void wifiDropCache() {
+  g_wifiRtcMagic = 0;
+  if (runtimeState.staCache.credHash) {
+    runtimeState.staCache = WifiCache();
+    eepromSaveRuntime();
+  }
+}
+
+inline void wifiOpenAP() {
+  if (!runtimeState.ap_ssid[0]) strncpy(runtimeState.ap_ssid, "SlidePilot", sizeof(runtimeState.ap_ssid) - 1);
+  if (!runtimeState.ap_pass[0]) strncpy(runtimeState.ap_pass, "slidepilot", sizeof(runtimeState.ap_pass) - 1);
+  WiFi.softAP(runtimeState.ap_ssid, runtimeState.ap_pass);
+  frec(FR_WIFI, WLS_AP, 0, (int32_t)(uint32_t)WiFi.softAPIP());
+}
+
+inline void wifiJoin(bool fast) {
+  const WifiCache* c = fast ? wifiCachedLink() : nullptr;
+  if (c) {
+    WiFi.config(IPAddress(c->ip), IPAddress(c->gateway), IPAddress(c->netmask), IPAddress(c->dns));
+    WiFi.begin(runtimeState.sta_ssid, runtimeState.sta_pass, c->channel, c->bssid, true);
+    g_wlState = WLS_FAST;
+  } else {
+    WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);    // back to DHCP
+    WiFi.begin(runtimeState.sta_ssid, runtimeState.sta_pass);
+    g_wlState = WLS_JOIN;
+  }
+  g_wlFast  = c != nullptr;
+  g_wlSince = millis();
+}
+
+// Joined: refresh the RTC copy every time, the flash copy only on change.
+inline void wifiLinkUp() {
+  WifiCache c;
+  c.credHash = wifiCredHash(runtimeState.sta_ssid, runtimeState.sta_pass);
+  const uint8_t* b = WiFi.BSSID();
+  if (b) memcpy(c.bssid, b, sizeof(c.bssid));
+  c.channel = (uint8_t)WiFi.channel();
+  c.ip      = (uint32_t)WiFi.localIP();
+  c.gateway = (uint32_t)WiFi.gatewayIP();
+  c.netmask = (uint32_t)WiFi.subnetMask();
+  c.dns     = (uint32_t)WiFi.dnsIP(0);
+
+  g_wifiRtc = c;
+  g_wifiRtcMagic = WIFI_RTC_MAGIC;
+  if (memcmp(&c, &runtimeState.staCache, sizeof(c)) != 0) {
+    runtimeState.staCache = c;
+    eepromSaveRuntime();
+  }
+  g_wlState  = WLS_UP;
+  g_wlJoinMs = millis() - g_wlSince;
+  frec(FR_WIFI, WLS_UP, (uint16_t)min<uint32_t>(g_wlJoinMs, 0xFFFF), (int32_t)c.ip);
+}
+
+// Call once from setup(); again to apply new settings.
+inline void wifiBegin() {
+  g_wlRestartAt = 0;
+  g_wlApOpen = false;
+  WiFi.persistent(false);          // credentials live in our settings, not NVS
+  WiFi.disconnect(true);
+
+  const bool sta = runtimeState.wifiMode != WLM_AP && runtimeState.sta_ssid[0];
+  if (!sta) {
+    WiFi.mode(WIFI_AP);
+    wifiOpenAP();
+    g_wlState = WLS_AP;
+    return;
+  }
+  WiFi.mode(WIFI_STA);
+  WiFi.setSleep(false);            // modem sleep adds 100+ ms to every reply
+  WiFi.setAutoReconnect(true);
+  wifiJoin(true);
+}
+
+// Apply new settings a little later, after the HTTP reply has gone out.
+inline void wifiRestartSoon(uint32_t ms = 300) { g_wlRestartAt = millis() + ms; if (!g_wlRestartAt) g_wlRestartAt = 1; }
+
+// Call from loop().
+inline void wifiLoop() {
+  const uint32_t now = millis();
+  if (g_wlRestartAt && (int32_t)(now - g_wlRestartAt) >= 0) { wifiBegin(); return; }
+  if (g_wlState == WLS_OFF || g_wlState == WLS_AP) return;
+
+  const bool connected = WiFi.status() == WL_CONNECTED;
+  switch (g_wlState) {
+    case WLS_FAST:
+      if (connected) { wifiLinkUp(); break; }
+      if (now - g_wlSince > WIFI_FAST_TIMEOUT_MS) {
+        // AP moved, changed channel or the lease is gone
+        frec(FR_WIFI, WLS_FAST, (uint16_t)(now - g_wlSince), 0);
+        wifiDropCache();
+        WiFi.disconnect();
+        wifiJoin(false);
+      }
+      break;
+    case WLS_JOIN:
+      if (connected) { wifiLinkUp(); break; }
+      if (!g_wlApOpen && runtimeState.wifiMode == WLM_STA_AP && now - g_wlSince > WIFI_STA_GIVEUP_MS) {
+        WiFi.mode(WIFI_AP_STA);      // keep trying the station in the background
+        wifiOpenAP();
+        g_wlApOpen = true;
+      }
+      break;
+    case WLS_UP:
+      if (!connected) {              // auto-reconnect runs; just track it
+        frec(FR_WIFI, WLS_JOIN, 0, 0);
+        g_wlState = WLS_JOIN;
+        g_wlFast  = false;
+        g_wlSince = now;
+      }
+      break;
+    default: break;
+  }
+}
+
+inline IPAddress wifiIP() {
+  return g_wlState == WLS_UP ? WiFi.localIP() : WiFi.softAPIP();
+}
+
+#endif
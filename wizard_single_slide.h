@@ -4,10 +4,12 @@
 #include "rotary_input.h"
 #include "encoder_as5600.h"
 #include "motor_control.h"
+#include "rig_scale.h"
+#include "control.h"
+#include "job_check.h"
 
-// Convert raw AS5600 (0..4095) difference into steps.
-// Adjust SCALE_STEPS_PER_REV to match your mechanics.
-static const uint32_t SCALE_STEPS_PER_REV = 1600; // example 200*8
+// Convert raw AS5600 (0..4095) difference into steps, using the rig scale
+// (calibrated from the encoder when Motor Tuning has been run).
 static inline int16_t rawDelta(uint16_t from, uint16_t to){
   // signed shortest arc on 12-bit ring
   int16_t d = (int16_t)to - (int16_t)from;
@@ -16,9 +18,7 @@ static inline int16_t rawDelta(uint16_t from, uint16_t to){
   return d;
 }
 static inline uint32_t rawToSteps(int16_t d){
-  // 4096 raw ticks == 1 turn
-  long s = (long)SCALE_STEPS_PER_REV * abs((long)d) / 4096L;
-  return (uint32_t)s;
+  return (uint32_t)scaleCountsToSteps(abs((int32_t)d));
 }
 
 // Small prompt helper
@@ -51,28 +51,40 @@ static void progressUI(int pct){
   drawCenteredProgress(pct);
 }
 
-// Run continuous move to target raw until the encoder reports “close enough”
-static void runToRaw(uint16_t currentRaw, uint16_t targetRaw, int speedPct){
-  // crude estimate for demo: step at fixed micro delay scaled by speed
-  const uint32_t baseUS = 1200; // slower base
-  const uint32_t usStep = max<uint32_t>(200, (uint32_t)((100-speedPct)*baseUS/100));
-
-  // Decide direction by shortest arc
-  int16_t d = rawDelta(currentRaw, targetRaw);
-  bool forward = (d>0);
-  uint32_t totalSteps = rawToSteps(d);
-  uint32_t done = 0;
-
-  while (done < totalSteps){
+// Pick the A->B duration with the knob (Time mode); false on long Back
+static bool pickDuration(uint32_t& secs){
+  int last = getRotaryPosition();
+  bool dirty = true;
+  while (true){
+    if (dirty){
+      char t[16];
+      jobCheckFmtMs(secs * 1000UL, t, sizeof(t));
+      centerTwo("Duration", t);
+      dirty = false;
+    }
     pollInput();
-    if (isSelectPressed() || isBackPressedLong()) break;
-
-    stepPulse();   // one step
-    done++;
+    int p = getRotaryPosition();
+    if (p != last){
+      const int32_t step = secs < 60 ? 1 : (secs < 600 ? 5 : 30);
+      secs = (uint32_t)constrain((int32_t)secs + (p > last ? step : -step), 1, 24L*3600L);
+      last = p; dirty = true;
+    }
+    if (isSelectPressed()) return true;
+    if (isBackPressedLong()) return false;
+    delay(10);
+  }
+}
 
-    int pct = (int)((done*100UL)/max<uint32_t>(1,totalSteps));
-    progressUI(pct);
-    delayMicroseconds(usStep);
+// Progress until the job ends or the user stops it
+static void runJobProgress(){
+  int lastPct = -1;
+  while (planRunning()){
+    int pct = plan.totalSteps ? (int)((uint64_t)plan.stepsDone * 100 / plan.totalSteps) : 0;
+    if (pct != lastPct){ progressUI(pct); lastPct = pct; }
+    pollInput();
+    if (isSelectPressed() || isBackPressedLong()){ planStop(); break; }
+    settleTick();
+    delay(10);
   }
 }
 
@@ -118,12 +130,34 @@ inline void runSingleSlideWizard(){
     delay(10);
   }
 
-  // 4) Run
-  // For now: just run from A->B at current speed setting
-  uint16_t now = enc_getRaw();
-  runToRaw(now, posA, getSpeedPercent());  // go to A first
-  now = enc_getRaw();
-  runToRaw(now, posB, getSpeedPercent());  // then to B
+  // 4) Check, then run as a job: the carriage sits at B, so B is the
+  //    current step position and A is the measured distance behind it.
+  const int16_t d = rawDelta(posA, posB);
+  const float distMM = (d < 0 ? -1.0f : 1.0f) * rawToSteps(d) / stepsPerMM();
+  uint32_t secs = 10;
+  jobArenaReset();
+  JobSpec* j = arenaNew<JobSpec>(jobArena());   // large; keep it off the stack
+  if (!j) return;
+  while (true){
+    if (sel == 0 && !pickDuration(secs)) return;
+    jobDefaults(*j);
+    j->type    = JOB_SINGLE;
+    j->b_mm    = stepPositionMM();
+    j->a_mm    = j->b_mm - distMM;
+    j->totalMS = (sel == 0) ? secs * 1000UL : 0;
+    j->pauseMs = 0;
+
+    JobCheck c;
+    char l1[32], l2[32];
+    jobCheck(*j, c);
+    jobCheckLines(c, l1, l2, sizeof(l2));
+    centerTwo(l1, l2);
+    if (!waitOkOrBack()) return;
+    if (c.ok()) break;
+    if (sel != 0) return;            // nothing to adjust in Speed mode
+  }
+  if (!jobRun(*j)){ centerTwo("Cannot run", g_jobError ? g_jobError : "error"); waitOkOrBack(); return; }
+  runJobProgress();
 
   // 5) Done
   uiBegin();